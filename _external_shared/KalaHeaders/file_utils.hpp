@@ -11,19 +11,52 @@
 //   - file metadata - file size, directory size, line count, get filename (stem + extension), get stem, get parent, get/set extension
 //   - text I/O - read/write data for text files with vector of string lines or string blob
 //   - binary I/O - read/write data for binary files with vector of bytes or buffer + size
+//   - memory mapping - read-only views of whole files without copying them (MappedFile),
+//     line index with random access to lines as views into the mapping (LineIndex)
+//   - pattern search - all ranges of one or several byte patterns in a file (GetRangeByValue, GetRangeByValues)
+//   - optional profiling hook through KalaHeaders::ProfileHook (profile_hook.hpp)
 //------------------------------------------------------------------------------
 
 //TODO: add checks for file locked, file read only, no write/read permissions for file, disk space full
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <fstream>
 #include <filesystem>
+#include <string_view>
 #include <cerrno>
 #include <cstring>
+#include <bit>
+#include <algorithm>
+#include <thread>
+#include <future>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "profile_hook.hpp"
 
 namespace KalaHeaders
 {
@@ -34,7 +67,11 @@ namespace KalaHeaders
 
 	using std::exception;
 	using std::string;
+	using std::string_view;
 	using std::vector;
+	using std::countr_zero;
+	using std::move;
+	using std::memchr;
 	using std::ostringstream;
 	using std::istreambuf_iterator;
 	using std::ifstream;
@@ -42,7 +79,15 @@ namespace KalaHeaders
 	using std::streamsize;
 	using std::streamoff;
 	using std::ios;
-	using std::search;
+	using std::min;
+	using std::max;
+	using std::any_of;
+	using std::lower_bound;
+	using std::thread;
+	using std::future;
+	using std::async;
+	using std::launch;
+	using std::memcmp;
 	using std::distance;
 	using std::strerror;
 	using std::filesystem::exists;
@@ -116,6 +161,8 @@ namespace KalaHeaders
 		FileType targetFileType = FileType::FILE_BINARY,
 		const FileData& fileData = FileData{})
 	{
+		KALAHEADERS_PROFILE_ZONE("CreateFile");
+
 		ostringstream oss{};
 
 		if (target.empty())
@@ -225,6 +272,8 @@ namespace KalaHeaders
 	//parent folders up to it that don't exist yet
 	inline string CreateDirectory(const path& target)
 	{
+		KALAHEADERS_PROFILE_ZONE("CreateDirectory");
+
 		ostringstream oss{};
 
 		if (exists(target))
@@ -260,6 +309,8 @@ namespace KalaHeaders
 		vector<path>& outEntries,
 		bool recursive = false)
 	{
+		KALAHEADERS_PROFILE_ZONE("ListDirectoryContents");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -307,6 +358,8 @@ namespace KalaHeaders
 		const path& target,
 		const string& newName)
 	{
+		KALAHEADERS_PROFILE_ZONE("RenamePath");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -353,6 +406,8 @@ namespace KalaHeaders
 	//Delete file or folder in target path (recursive for directories)
 	inline string DeletePath(const path& target)
 	{
+		KALAHEADERS_PROFILE_ZONE("DeletePath");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -385,6 +440,8 @@ namespace KalaHeaders
 		const path& target,
 		bool overwrite = false)
 	{
+		KALAHEADERS_PROFILE_ZONE("CopyPath");
+
 		ostringstream oss{};
 
 		if (!exists(origin))
@@ -464,6 +521,8 @@ namespace KalaHeaders
 		const path& origin,
 		const path& target)
 	{
+		KALAHEADERS_PROFILE_ZONE("MovePath");
+
 		ostringstream oss{};
 
 		if (!exists(origin))
@@ -518,6 +577,469 @@ namespace KalaHeaders
 		return{};
 	}
 
+	//
+	// MEMORY MAPPING
+	//
+
+	class MappedFile;
+
+	//Map the whole target file read-only into memory, the view stays valid until outFile is closed
+	inline string MapFile(
+		const path& target,
+		MappedFile& outFile);
+
+	//Read-only view of a whole file mapped into memory.
+	//Pages are only read from disk when they are first touched.
+	//Other processes may still write to, replace or delete the file while it is mapped,
+	//but if it is truncated, touching a page past its new end raises SIGBUS on POSIX
+	//and EXCEPTION_IN_PAGE_ERROR on Windows. Check IsTruncated before reading a file
+	//that something else may be writing to, and map it again if it returns true
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept { MoveFrom(other); }
+		MappedFile& operator=(MappedFile&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+
+		~MappedFile() { Close(); }
+
+		inline bool IsOpen() const { return data != nullptr; }
+
+		inline const uint8_t* GetData() const { return data; }
+		inline size_t GetSize() const { return size; }
+
+		//True if the file on disk is now shorter than the mapping,
+		//reading the mapped bytes past the new end would fault
+		inline bool IsTruncated() const
+		{
+			if (!data) return false;
+
+#ifdef _WIN32
+			LARGE_INTEGER currentSize{};
+			if (!::GetFileSizeEx(fileHandle, &currentSize)) return true;
+
+			return static_cast<uint64_t>(currentSize.QuadPart) < size;
+#else
+			struct stat info{};
+			if (::fstat(fileDescriptor, &info) != 0) return true;
+
+			return static_cast<uint64_t>(info.st_size) < size;
+#endif
+		}
+
+		inline void Close()
+		{
+			if (!data) return;
+
+#ifdef _WIN32
+			::UnmapViewOfFile(data);
+			::CloseHandle(mappingHandle);
+			::CloseHandle(fileHandle);
+
+			mappingHandle = nullptr;
+			fileHandle = nullptr;
+#else
+			::munmap(const_cast<uint8_t*>(data), size);
+			::close(fileDescriptor);
+
+			fileDescriptor = -1;
+#endif
+			data = nullptr;
+			size = 0;
+		}
+	private:
+		friend string MapFile(
+			const path& target,
+			MappedFile& outFile);
+
+		inline void MoveFrom(MappedFile& other)
+		{
+			data = other.data;
+			size = other.size;
+#ifdef _WIN32
+			fileHandle = other.fileHandle;
+			mappingHandle = other.mappingHandle;
+
+			other.fileHandle = nullptr;
+			other.mappingHandle = nullptr;
+#else
+			fileDescriptor = other.fileDescriptor;
+
+			other.fileDescriptor = -1;
+#endif
+			other.data = nullptr;
+			other.size = 0;
+		}
+
+		const uint8_t* data{};
+		size_t size{};
+
+#ifdef _WIN32
+		HANDLE fileHandle{};
+		HANDLE mappingHandle{};
+#else
+		//kept open so IsTruncated can check the size of the mapped file even after it was renamed
+		int fileDescriptor = -1;
+#endif
+	};
+
+	inline string MapFile(
+		const path& target,
+		MappedFile& outFile)
+	{
+		KALAHEADERS_PROFILE_ZONE("MapFile");
+
+		ostringstream oss{};
+
+		outFile.Close();
+
+		if (!exists(target))
+		{
+			oss << "Failed to map target '" << target << "' because it does not exist!";
+
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to map target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			uintmax_t fileSize = file_size(target);
+			if (fileSize == 0)
+			{
+				oss << "Failed to map target '" << target << "' because it is empty!";
+
+				return oss.str();
+			}
+
+#ifdef _WIN32
+			HANDLE file = ::CreateFileW(
+				target.wstring().c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				oss << "Failed to map target '" << target << "' because it couldn't be opened! "
+					<< "Reason: (error " << ::GetLastError() << ")";
+
+				return oss.str();
+			}
+
+			HANDLE mapping = ::CreateFileMappingW(
+				file,
+				nullptr,
+				PAGE_READONLY,
+				0,
+				0,
+				nullptr);
+
+			if (!mapping)
+			{
+				oss << "Failed to map target '" << target << "'! "
+					<< "Reason: (error " << ::GetLastError() << ")";
+
+				::CloseHandle(file);
+
+				return oss.str();
+			}
+
+			void* view = ::MapViewOfFile(
+				mapping,
+				FILE_MAP_READ,
+				0,
+				0,
+				0);
+
+			if (!view)
+			{
+				oss << "Failed to map target '" << target << "'! "
+					<< "Reason: (error " << ::GetLastError() << ")";
+
+				::CloseHandle(mapping);
+				::CloseHandle(file);
+
+				return oss.str();
+			}
+
+			outFile.fileHandle = file;
+			outFile.mappingHandle = mapping;
+#else
+			int file = ::open(target.c_str(), O_RDONLY);
+			if (file == -1)
+			{
+				int err = errno;
+
+				oss << "Failed to map target '" << target << "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << strerror(err);
+
+				return oss.str();
+			}
+
+			void* view = ::mmap(
+				nullptr,
+				static_cast<size_t>(fileSize),
+				PROT_READ,
+				MAP_PRIVATE,
+				file,
+				0);
+
+			if (view == MAP_FAILED)
+			{
+				int err = errno;
+
+				::close(file);
+
+				oss << "Failed to map target '" << target << "'! "
+					<< "Reason: (errno " << err << "): " << strerror(err);
+
+				return oss.str();
+			}
+
+			outFile.fileDescriptor = file;
+#endif
+			outFile.data = static_cast<const uint8_t*>(view);
+			outFile.size = static_cast<size_t>(fileSize);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to map target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+
+	//Calls onNewline with the offset of every '\n' in data.
+	//64 bytes are tested per step with AVX2 or SSE2, other targets use memchr
+	template<typename F>
+	inline void ForEachNewline(
+		const uint8_t* data,
+		size_t size,
+		F&& onNewline)
+	{
+		size_t i{};
+
+#if defined(__AVX2__)
+		const __m256i newline = _mm256_set1_epi8('\n');
+		for (; i + 64 <= size; i += 64)
+		{
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+
+			uint64_t mask =
+				static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, newline)))
+				| (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, newline)))) << 32);
+
+			for (; mask != 0; mask &= mask - 1) onNewline(i + countr_zero(mask));
+		}
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+		const __m128i newline = _mm_set1_epi8('\n');
+		for (; i + 64 <= size; i += 64)
+		{
+			uint64_t mask{};
+			for (size_t lane = 0; lane < 4; ++lane)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + lane * 16));
+				uint64_t bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+
+				mask |= bits << (lane * 16);
+			}
+
+			for (; mask != 0; mask &= mask - 1) onNewline(i + countr_zero(mask));
+		}
+#endif
+
+		//the tail, or the whole buffer where the platform memchr does the vector work
+		while (i < size)
+		{
+			const void* found = memchr(data + i, '\n', size - i);
+			if (!found) break;
+
+			size_t offset = static_cast<size_t>(static_cast<const uint8_t*>(found) - data);
+			onNewline(offset);
+
+			i = offset + 1;
+		}
+	}
+
+	class LineIndex;
+
+	//Map the target text file and find the start of every line in one pass,
+	//the index keeps the file mapped so its lines stay valid until it is closed
+	inline string IndexLines(
+		const path& target,
+		LineIndex& outIndex);
+
+	//Same as IndexLines but reuses line starts found earlier in the same file.
+	//'knownStarts' begins with 0 followed by the offset after each newline of a prefix of the file,
+	//only the bytes after the last known start are scanned, so a file that was appended to is not read again
+	inline string ExtendLineIndex(
+		const path& target,
+		vector<size_t>&& knownStarts,
+		LineIndex& outIndex);
+
+	//Start offsets of every line of a memory-mapped text file, lines are read as views into the mapping.
+	//Lines end at '\n' and a '\r' right before it is dropped, a final newline does not start an empty line.
+	//The index does not follow later changes to the file, if it may have been truncated
+	//check IsTruncated before GetLine since reading a line past the new end faults, see MappedFile
+	class LineIndex
+	{
+	public:
+		LineIndex() = default;
+
+		LineIndex(const LineIndex&) = delete;
+		LineIndex& operator=(const LineIndex&) = delete;
+
+		LineIndex(LineIndex&&) noexcept = default;
+		LineIndex& operator=(LineIndex&&) noexcept = default;
+
+		inline bool IsOpen() const { return file.IsOpen(); }
+
+		//True if the file was truncated after it was indexed, index it again before reading lines
+		inline bool IsTruncated() const { return file.IsTruncated(); }
+
+		inline size_t GetLineCount() const
+		{
+			return lineStarts.empty()
+				? 0
+				: lineStarts.size() - 1;
+		}
+
+		//Returns line 'index' without its line ending, empty past the last line
+		inline string_view GetLine(size_t index) const
+		{
+			if (index + 1 >= lineStarts.size()) return{};
+
+			const char* text = reinterpret_cast<const char*>(file.GetData());
+
+			size_t start = lineStarts[index];
+			size_t end = lineStarts[index + 1];
+
+			if (end > start && text[end - 1] == '\n') --end;
+			if (end > start && text[end - 1] == '\r') --end;
+
+			return string_view(text + start, end - start);
+		}
+
+		inline const MappedFile& GetFile() const { return file; }
+
+		//Start of every line followed by the file size, also when the file does not end with a newline
+		inline const vector<size_t>& GetLineStarts() const { return lineStarts; }
+
+		inline void Close()
+		{
+			file.Close();
+			lineStarts.clear();
+		}
+	private:
+		friend string ExtendLineIndex(
+			const path& target,
+			vector<size_t>&& knownStarts,
+			LineIndex& outIndex);
+
+		MappedFile file{};
+
+		//start of every line followed by the file size, so line N spans [N, N + 1)
+		vector<size_t> lineStarts{};
+	};
+
+	inline string IndexLines(
+		const path& target,
+		LineIndex& outIndex)
+	{
+		KALAHEADERS_PROFILE_ZONE("IndexLines");
+
+		return ExtendLineIndex(
+			target,
+			vector<size_t>{ 0 },
+			outIndex);
+	}
+
+	inline string ExtendLineIndex(
+		const path& target,
+		vector<size_t>&& knownStarts,
+		LineIndex& outIndex)
+	{
+		KALAHEADERS_PROFILE_ZONE("ExtendLineIndex");
+
+		ostringstream oss{};
+
+		outIndex.Close();
+
+		if (knownStarts.empty()
+			|| knownStarts.front() != 0)
+		{
+			oss << "Failed to index lines of target '" << target << "' because the known line starts do not begin at 0!";
+
+			return oss.str();
+		}
+
+		MappedFile file{};
+		string result = MapFile(target, file);
+		if (!result.empty())
+		{
+			oss << "Failed to index lines of target '" << target << "'! Reason: " << result;
+
+			return oss.str();
+		}
+
+		try
+		{
+			size_t size = file.GetSize();
+			size_t resume = knownStarts.back();
+
+			if (resume > size)
+			{
+				oss << "Failed to index lines of target '" << target << "' because the known line starts run past its end!";
+
+				return oss.str();
+			}
+
+			vector<size_t> starts = move(knownStarts);
+
+			ForEachNewline(
+				file.GetData() + resume,
+				size - resume,
+				[&starts, resume](size_t offset) { starts.push_back(resume + offset + 1); });
+
+			//text after the last newline is one more line
+			if (starts.back() != size) starts.push_back(size);
+
+			outIndex.file = move(file);
+			outIndex.lineStarts = move(starts);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to index lines of target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+
 	//
 	// FILE METADATA
 	//
@@ -527,6 +1049,8 @@ namespace KalaHeaders
 		const path& target,
 		uintmax_t& outSize)
 	{
+		KALAHEADERS_PROFILE_ZONE("GetFileSize");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -561,6 +1085,8 @@ namespace KalaHeaders
 		const path& target,
 		uintmax_t& outSize)
 	{
+		KALAHEADERS_PROFILE_ZONE("GetDirectorySize");
+
 		ostringstream oss{};
 		uintmax_t totalSize{};
 
@@ -614,6 +1140,8 @@ namespace KalaHeaders
 		const path& target,
 		size_t& outCount)
 	{
+		KALAHEADERS_PROFILE_ZONE("GetTextFileLineCount");
+
 		ostringstream oss{};
 		size_t totalCount{};
 
@@ -632,39 +1160,35 @@ namespace KalaHeaders
 
 		try
 		{
-			ifstream in(
-				target, 
-				ios::in);
-
-			if (in.fail()
-				&& errno != 0)
+			//empty files have no lines and can not be mapped
+			if (file_size(target) == 0)
 			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to get target '" << target
-					<< "' line count because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+				oss << "Failed to get target '" << target << "' line count because it had no lines!";
 
 				return oss.str();
 			}
 
-			string tmp{};
-			while (getline(in, tmp)) ++totalCount;
-
-			if (totalCount == 0)
+			MappedFile file{};
+			string result = MapFile(target, file);
+			if (!result.empty())
 			{
-				oss << "Failed to get target '" << target << "' line count because it had no lines!";
+				oss << "Failed to get target '" << target << "' line count! Reason: " << result;
 
 				return oss.str();
 			}
 
-			outCount = totalCount;
+			const uint8_t* data = file.GetData();
+			size_t size = file.GetSize();
 
-			in.close();
+			ForEachNewline(
+				data,
+				size,
+				[&totalCount](size_t) { ++totalCount; });
+
+			//text after the last newline is one more line
+			if (data[size - 1] != '\n') ++totalCount;
+
+			outCount = totalCount;
 		}
 		catch (exception& e)
 		{
@@ -832,6 +1356,8 @@ namespace KalaHeaders
 		const string& inText,
 		bool append)
 	{
+		KALAHEADERS_PROFILE_ZONE("WriteTextToFile");
+
 		ostringstream oss{};
 
 		if (exists(target)
@@ -901,6 +1427,8 @@ namespace KalaHeaders
 		const path& target, 
 		string& outText)
 	{
+		KALAHEADERS_PROFILE_ZONE("ReadTextFromFile");
+
 		ostringstream oss{};
 		string allText{};
 
@@ -973,6 +1501,8 @@ namespace KalaHeaders
 		const vector<string>& inLines,
 		bool append)
 	{
+		KALAHEADERS_PROFILE_ZONE("WriteLinesToFile");
+
 		ostringstream oss{};
 
 		if (exists(target)
@@ -1042,13 +1572,16 @@ namespace KalaHeaders
 	}
 	//Read all lines from a file into a vector of strings with optional 
 	//lineStart and lineEnd values to avoid placing all lines to memory.
-	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF
+	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF.
+	//Use IndexLines instead to read lines without copying them
 	inline string ReadLinesFromFile(
 		const path& target,
 		vector<string>& outLines,
 		size_t lineStart = 0,
 		size_t lineEnd = 0)
 	{
+		KALAHEADERS_PROFILE_ZONE("ReadLinesFromFile");
+
 		ostringstream oss{};
 		vector<string> allLines{};
 
@@ -1067,28 +1600,9 @@ namespace KalaHeaders
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::in);
-
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to read lines from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
-
-				return oss.str();
-			}
-
-			size_t totalLines{};
-			string result = GetTextFileLineCount(target, totalLines);
+			//the file is mapped and indexed once, only the requested lines are copied
+			LineIndex index{};
+			string result = IndexLines(target, index);
 
 			if (!result.empty())
 			{
@@ -1098,6 +1612,8 @@ namespace KalaHeaders
 				return oss.str();
 			}
 
+			size_t totalLines = index.GetLineCount();
+
 			if (lineEnd == 0) lineEnd = totalLines;
 
 			if (lineEnd <= lineStart)
@@ -1133,22 +1649,12 @@ namespace KalaHeaders
 				return oss.str();
 			}
 
-			string line{};
-			size_t currentLine{};
-			while (getline(in, line))
+			allLines.reserve(lineEnd - lineStart);
+			for (size_t i = lineStart; i < lineEnd; ++i)
 			{
-				if (currentLine >= lineStart
-					&& currentLine < lineEnd)
-				{
-					allLines.push_back(line);
-				}
-				++currentLine;
-
-				if (currentLine >= lineEnd) break;
+				allLines.emplace_back(index.GetLine(i));
 			}
 
-			in.close();
-
 			size_t expected = lineEnd - lineStart;
 			if (allLines.size() != expected)
 			{
@@ -1198,6 +1704,8 @@ namespace KalaHeaders
 		const vector<uint8_t>& inData,
 		bool append)
 	{
+		KALAHEADERS_PROFILE_ZONE("WriteBinaryLinesToFile");
+
 		ostringstream oss{};
 
 		if (exists(target)
@@ -1291,6 +1799,8 @@ namespace KalaHeaders
 		size_t rangeStart = 0,
 		size_t rangeEnd = 0)
 	{
+		KALAHEADERS_PROFILE_ZONE("ReadBinaryLinesFromFile");
+
 		ostringstream oss{};
 		vector<uint8_t> allData{};
 
@@ -1453,171 +1963,402 @@ namespace KalaHeaders
 			| (data[offset + 3]);
 	}
 
-	//Return all start and end of defined string in a binary
-	inline string GetRangeByValue(
-		const path& target,
-		const string& inData,
-		vector<BinaryRange>& outData)
+	//Searches one byte pattern, candidates are found by comparing the first and last pattern byte
+	//at 32 positions per step with AVX2 or 16 with SSE2 before the bytes between them are compared
+	class LiteralSearcher
 	{
-		ostringstream oss{};
+	public:
+		LiteralSearcher(
+			const uint8_t* pattern,
+			size_t patternSize)
+			: pattern(pattern, pattern + patternSize) {}
+
+		size_t GetMaxLength() const { return pattern.size(); }
+
+		//Finds the first match that starts in [from, startLimit), matches may run up to 'size'
+		inline bool FindNext(
+			const uint8_t* data,
+			size_t size,
+			size_t from,
+			size_t startLimit,
+			BinaryRange& outMatch) const
+		{
+			size_t n = pattern.size();
+			if (size < n) return false;
+
+			size_t limit = min(startLimit, size - n + 1);
+			size_t i = from;
+
+			const uint8_t* p = pattern.data();
+
+#if defined(__AVX2__)
+			const __m256i first = _mm256_set1_epi8(static_cast<char>(p[0]));
+			const __m256i last = _mm256_set1_epi8(static_cast<char>(p[n - 1]));
+			for (; i + 32 <= limit; i += 32)
+			{
+				__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + n - 1));
 
-		if (!exists(target))
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
+				uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+					_mm256_cmpeq_epi8(a, first),
+					_mm256_cmpeq_epi8(b, last))));
 
-			return oss.str();
-		}
-		if (!is_regular_file(target))
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
+				for (; mask != 0; mask &= mask - 1)
+				{
+					size_t start = i + countr_zero(mask);
+					if (n <= 2
+						|| memcmp(data + start + 1, p + 1, n - 2) == 0)
+					{
+						outMatch = { start, start + n };
+						return true;
+					}
+				}
+			}
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+			const __m128i first = _mm_set1_epi8(static_cast<char>(p[0]));
+			const __m128i last = _mm_set1_epi8(static_cast<char>(p[n - 1]));
+			for (; i + 16 <= limit; i += 16)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
 
-			return oss.str();
-		}
-		if (inData.empty())
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
+				uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+					_mm_cmpeq_epi8(a, first),
+					_mm_cmpeq_epi8(b, last))));
 
-			return oss.str();
+				for (; mask != 0; mask &= mask - 1)
+				{
+					size_t start = i + countr_zero(mask);
+					if (n <= 2
+						|| memcmp(data + start + 1, p + 1, n - 2) == 0)
+					{
+						outMatch = { start, start + n };
+						return true;
+					}
+				}
+			}
+#endif
+
+			//the tail, or everything where memchr is the fastest way to find the first byte
+			while (i < limit)
+			{
+				const void* found = memchr(data + i, p[0], limit - i);
+				if (!found) break;
+
+				size_t start = static_cast<size_t>(static_cast<const uint8_t*>(found) - data);
+				if (memcmp(data + start, p, n) == 0)
+				{
+					outMatch = { start, start + n };
+					return true;
+				}
+
+				i = start + 1;
+			}
+
+			return false;
 		}
+	private:
+		vector<uint8_t> pattern{};
+	};
 
-		try
+	//Searches several byte patterns at once with an Aho-Corasick automaton.
+	//Matches are leftmost first and the longest pattern wins when several start at the same byte.
+	//While no pattern is partially matched, up to four distinct first bytes are skipped to with SSE2
+	class MultiSearcher
+	{
+	public:
+		MultiSearcher(const vector<string>& patterns)
 		{
-			ifstream in(
-				target,
-				ios::binary);
+			//state 0 is the root, every state has 256 transitions
+			transitions.assign(256, 0);
+			longestOutput.assign(1, 0);
 
-			if (in.fail()
-				&& errno != 0)
+			for (const string& pattern : patterns)
 			{
-				int err = errno;
-				char buf[256]{};
+				if (pattern.empty()) continue;
 
-				oss << "Failed to get ragge by value from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
+				uint32_t state{};
+				for (char c : pattern)
+				{
+					uint32_t& next = transitions[state * 256 + static_cast<uint8_t>(c)];
+					if (next == 0)
+					{
+						next = static_cast<uint32_t>(longestOutput.size());
+						transitions.resize(transitions.size() + 256, 0);
+						longestOutput.push_back(0);
+					}
+					state = transitions[state * 256 + static_cast<uint8_t>(c)];
+				}
 
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+				longestOutput[state] = max(longestOutput[state], static_cast<uint32_t>(pattern.size()));
+				maxLength = max(maxLength, pattern.size());
 
-				return oss.str();
+				uint8_t firstByte = static_cast<uint8_t>(pattern[0]);
+				if (!isFirstByte[firstByte])
+				{
+					isFirstByte[firstByte] = true;
+					++firstByteCount;
+					if (firstByteCount <= 4) firstBytes[firstByteCount - 1] = firstByte;
+				}
 			}
 
-			size_t fileSize{};
-			string result = GetFileSize(
-				target,
-				fileSize);
+			for (size_t i = min(firstByteCount, size_t{ 4 }); i < 4; ++i) firstBytes[i] = firstBytes[0];
 
-			if (!result.empty())
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "'! Reason: " << result;
+			//breadth first so every failure link points to an already finished state,
+			//missing transitions then borrow those of the failure state to form a full DFA
+			vector<uint32_t> failure(longestOutput.size(), 0);
+			vector<uint32_t> queue{};
 
-				return oss.str();
+			for (size_t c = 0; c < 256; ++c)
+			{
+				if (transitions[c] != 0) queue.push_back(transitions[c]);
 			}
 
-			if (fileSize == 0)
+			for (size_t head = 0; head < queue.size(); ++head)
 			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because target file is empty!";
+				uint32_t state = queue[head];
 
-				return oss.str();
+				//a pattern that ends inside a longer one is matched there too
+				longestOutput[state] = max(longestOutput[state], longestOutput[failure[state]]);
+
+				for (size_t c = 0; c < 256; ++c)
+				{
+					uint32_t& next = transitions[state * 256 + c];
+					uint32_t fallback = transitions[failure[state] * 256 + c];
+
+					if (next == 0) next = fallback;
+					else
+					{
+						failure[next] = fallback;
+						queue.push_back(next);
+					}
+				}
 			}
+		}
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
+		size_t GetMaxLength() const { return maxLength; }
 
-				return oss.str();
-			}
+		//Finds the first match that starts in [from, startLimit), matches may run up to 'size'
+		inline bool FindNext(
+			const uint8_t* data,
+			size_t size,
+			size_t from,
+			size_t startLimit,
+			BinaryRange& outMatch) const
+		{
+			if (maxLength == 0) return false;
 
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+			//no match that starts before the limit can end after this
+			size_t scanEnd = min(size, startLimit + maxLength - 1);
 
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
+			uint32_t state{};
+			bool found{};
 
-			while (in)
+			for (size_t i = from; i < scanEnd; ++i)
 			{
-				size_t preserve{};
-
-				if (!firstRead)
+				if (state == 0)
 				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
+					//nothing is partially matched, so an earlier start than the found one is impossible
+					if (found) break;
+
+					i = SkipToFirstByte(data, i, min(startLimit, size));
+					if (i >= startLimit) break;
 				}
 
-				in.read(reinterpret_cast<char*>(buffer.data() + preserve), chunkSize);
+				state = transitions[state * 256 + data[i]];
+
+				size_t length = longestOutput[state];
+				if (length == 0) continue;
 
-				if (in.fail()
-					&& errno != 0)
+				//a later end with the same start is a longer pattern
+				size_t start = i + 1 - length;
+				if (start < startLimit
+					&& (!found
+					|| start <= outMatch.start))
 				{
-					int err = errno;
-					char buf[256]{};
+					outMatch = { start, i + 1 };
+					found = true;
+				}
 
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): ";
+				if (found
+					&& i + 1 >= outMatch.start + maxLength)
+				{
+					break;
+				}
+			}
 
-					if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-					else oss << " Unknown error";
+			return found;
+		}
+	private:
+		inline size_t SkipToFirstByte(
+			const uint8_t* data,
+			size_t i,
+			size_t end) const
+		{
+			if (firstByteCount == 1)
+			{
+				const void* found = memchr(data + i, firstBytes[0], end - i);
+				return found
+					? static_cast<size_t>(static_cast<const uint8_t*>(found) - data)
+					: end;
+			}
 
-					return oss.str();
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+			if (firstByteCount <= 4)
+			{
+				const __m128i b0 = _mm_set1_epi8(static_cast<char>(firstBytes[0]));
+				const __m128i b1 = _mm_set1_epi8(static_cast<char>(firstBytes[1]));
+				const __m128i b2 = _mm_set1_epi8(static_cast<char>(firstBytes[2]));
+				const __m128i b3 = _mm_set1_epi8(static_cast<char>(firstBytes[3]));
+
+				for (; i + 16 <= end; i += 16)
+				{
+					__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					__m128i hits = _mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(chunk, b0), _mm_cmpeq_epi8(chunk, b1)),
+						_mm_or_si128(_mm_cmpeq_epi8(chunk, b2), _mm_cmpeq_epi8(chunk, b3)));
+
+					uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+					if (mask != 0) return i + countr_zero(mask);
 				}
+			}
+#endif
 
-				size_t bytesRead = static_cast<size_t>(in.gcount());
+			while (i < end
+				&& !isFirstByte[data[i]])
+			{
+				++i;
+			}
 
-				if (bytesRead == 0) break;
+			return i;
+		}
 
-				size_t totalBytes = bytesRead + preserve;
+		vector<uint32_t> transitions{};
 
-				auto first = buffer.begin();
-				while (true)
-				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+		//length of the longest pattern that ends in each state, 0 if none does
+		vector<uint32_t> longestOutput{};
 
-					if (it == buffer.begin() + totalBytes) break;
+		size_t maxLength{};
 
-					size_t start = offset + static_cast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+		bool isFirstByte[256]{};
+		size_t firstByteCount{};
 
-					outData.push_back({ start, end });
+		//unused slots repeat the first entry so they never stop the skip on other bytes
+		uint8_t firstBytes[4]{};
+	};
 
-					first = it + inData.size();
+	//Files smaller than this per thread are searched on the calling thread
+	constexpr size_t PARALLEL_SEARCH_BYTES = 16ULL * 1024 * 1024;
+
+	//Appends every non-overlapping leftmost match in data to outData in file order.
+	//Large inputs are split across threads, matches that cross a split are resolved afterwards
+	//so the result is the same as one scan from the start
+	template<typename Searcher>
+	inline void FindAllRanges(
+		const uint8_t* data,
+		size_t size,
+		const Searcher& searcher,
+		vector<BinaryRange>& outData)
+	{
+		auto scan = [&searcher, data, size](
+			size_t from,
+			size_t startLimit,
+			vector<BinaryRange>& found)
+			{
+				BinaryRange match{};
+				while (from < startLimit
+					&& searcher.FindNext(data, size, from, startLimit, match))
+				{
+					found.push_back(match);
+					from = match.end;
 				}
+			};
 
-				offset += bytesRead;
-				firstRead = false;
-			}
+		size_t threadCount = min(
+			static_cast<size_t>(max(thread::hardware_concurrency(), 1u)),
+			size / PARALLEL_SEARCH_BYTES);
+
+		if (threadCount <= 1)
+		{
+			scan(0, size, outData);
+			return;
 		}
-		catch (exception& e)
+
+		size_t chunkSize = size / threadCount;
+
+		//outData may already hold ranges of an earlier search, only the ones added here
+		//tell where the previous chunk's matches ended
+		size_t firstAdded = outData.size();
+
+		vector<future<vector<BinaryRange>>> parts{};
+		for (size_t t = 0; t < threadCount; ++t)
 		{
-			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+			size_t start = t * chunkSize;
+			size_t end = t + 1 == threadCount ? size : start + chunkSize;
 
-			return oss.str();
+			parts.push_back(async(
+				launch::async,
+				[&scan, start, end]()
+				{
+					vector<BinaryRange> found{};
+					scan(start, end, found);
+					return found;
+				}));
 		}
 
-		return{};
+		size_t lastEnd{};
+		for (size_t t = 0; t < threadCount; ++t)
+		{
+			vector<BinaryRange> found = parts[t].get();
+
+			size_t end = t + 1 == threadCount ? size : (t + 1) * chunkSize;
+			size_t next{};
+
+			//the previous chunk's last match ran into this one, so this chunk's first matches
+			//may overlap it. Rescan from its end until a match agrees with one found here,
+			//from then on both scans pick the same matches
+			if (!found.empty()
+				&& found[0].start < lastEnd)
+			{
+				size_t from = lastEnd;
+				BinaryRange match{};
+
+				next = found.size();
+				while (from < end
+					&& searcher.FindNext(data, size, from, end, match))
+				{
+					auto agree = lower_bound(
+						found.begin(),
+						found.end(),
+						match.start,
+						[](const BinaryRange& range, size_t start) { return range.start < start; });
+
+					if (agree != found.end()
+						&& agree->start == match.start)
+					{
+						next = static_cast<size_t>(distance(found.begin(), agree));
+						break;
+					}
+
+					outData.push_back(match);
+					from = match.end;
+				}
+			}
+
+			outData.insert(outData.end(), found.begin() + next, found.end());
+			if (outData.size() > firstAdded) lastEnd = outData.back().end;
+		}
 	}
 
-	//Return all start and end of defined bytes in a binary
+	//Return all start and end of defined string in a binary.
+	//Matches do not overlap, the search continues after the end of each match
 	inline string GetRangeByValue(
 		const path& target,
-		const vector<uint8_t>& inData,
+		const string& inData,
 		vector<BinaryRange>& outData)
 	{
+		KALAHEADERS_PROFILE_ZONE("GetRangeByValue");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -1634,132 +2375,197 @@ namespace KalaHeaders
 		}
 		if (inData.empty())
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
+			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::binary);
-
-			if (in.fail()
-				&& errno != 0)
+			if (file_size(target) == 0)
 			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to get range by value from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+				oss << "Failed to get range by value for target '" << target
+					<< "' because target file is empty!";
 
 				return oss.str();
 			}
 
-			size_t fileSize{};
-			string result = GetFileSize(
-				target, 
-				fileSize);
+			MappedFile file{};
+			string result = MapFile(
+				target,
+				file);
 
 			if (!result.empty())
 			{
-				ostringstream oss{};
 				oss << "Failed to get range by value for target '" << target
 					<< "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			if (fileSize == 0)
+			LiteralSearcher searcher(
+				reinterpret_cast<const uint8_t*>(inData.data()),
+				inData.size());
+
+			FindAllRanges(
+				file.GetData(),
+				file.GetSize(),
+				searcher,
+				outData);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+
+	//Return all start and end of defined bytes in a binary
+	inline string GetRangeByValue(
+		const path& target,
+		const vector<uint8_t>& inData,
+		vector<BinaryRange>& outData)
+	{
+		KALAHEADERS_PROFILE_ZONE("GetRangeByValue");
+
+		ostringstream oss{};
+
+		if (!exists(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
+
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		if (inData.empty())
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			if (file_size(target) == 0)
 			{
-				ostringstream oss{};
 				oss << "Failed to get range by value for target '" << target
 					<< "' because target file is empty!";
 
 				return oss.str();
 			}
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
+			MappedFile file{};
+			string result = MapFile(
+				target,
+				file);
+
+			if (!result.empty())
 			{
-				ostringstream oss{};
 				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
+					<< "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+			LiteralSearcher searcher(
+				inData.data(),
+				inData.size());
 
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
-
-			while (in)
-			{
-				size_t preserve{};
+			FindAllRanges(
+				file.GetData(),
+				file.GetSize(),
+				searcher,
+				outData);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
 
-				if (!firstRead)
-				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
-				}
+			return oss.str();
+		}
 
-				in.read(reinterpret_cast<char*>(buffer.data() + preserve), chunkSize);
+		return{};
+	}
 
-				if (in.fail()
-					&& errno != 0)
-				{
-					int err = errno;
-					char buf[256]{};
+	//Return all start and end of any of the defined strings in a binary in one pass.
+	//Matches do not overlap, the leftmost match is taken and the longest string wins when several start at the same byte
+	inline string GetRangeByValues(
+		const path& target,
+		const vector<string>& inData,
+		vector<BinaryRange>& outData)
+	{
+		KALAHEADERS_PROFILE_ZONE("GetRangeByValues");
 
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): ";
+		ostringstream oss{};
 
-					if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-					else oss << " Unknown error";
+		if (!exists(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
 
-					return oss.str();
-				}
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
 
-				size_t bytesRead = static_cast<size_t>(in.gcount());
+			return oss.str();
+		}
+		if (inData.empty())
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because input string vector was empty!";
 
-				if (bytesRead == 0) break;
+			return oss.str();
+		}
 
-				size_t totalBytes = bytesRead + preserve;
+		try
+		{
+			if (file_size(target) == 0)
+			{
+				oss << "Failed to get range by value for target '" << target
+					<< "' because target file is empty!";
 
-				auto first = buffer.begin();
-				while (true)
-				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+				return oss.str();
+			}
 
-					if (it == buffer.begin() + totalBytes) break;
+			MappedFile file{};
+			string result = MapFile(
+				target,
+				file);
 
-					size_t start = offset + static_cast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+			if (!result.empty())
+			{
+				oss << "Failed to get range by value for target '" << target
+					<< "'! Reason: " << result;
 
-					outData.push_back({ start, end });
+				return oss.str();
+			}
 
-					first = it + inData.size();
-				}
+			if (any_of(
+				inData.begin(),
+				inData.end(),
+				[](const string& value) { return value.empty(); }))
+			{
+				oss << "Failed to get range by value for target '" << target
+					<< "' because one of the input strings was empty!";
 
-				offset += bytesRead;
-				firstRead = false;
+				return oss.str();
 			}
+
+			MultiSearcher searcher(inData);
+
+			FindAllRanges(
+				file.GetData(),
+				file.GetSize(),
+				searcher,
+				outData);
 		}
 		catch (exception& e)
 		{
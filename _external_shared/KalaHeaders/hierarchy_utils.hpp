@@ -14,6 +14,7 @@
 // Provides:
 //   - parent-child hierarchy management
 //   - fast lookup through recursive traversal across parents, children and siblings
+//   - flat index-based hierarchy store for large trees (FlatHierarchy)
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -21,12 +22,18 @@
 #include <algorithm>
 #include <type_traits>
 #include <vector>
+#include <span>
+#include <cstdint>
+#include <limits>
 
 namespace KalaHeaders
 {
 	using std::is_class_v;
 	using std::same_as;
 	using std::vector;
+	using std::span;
+	using std::uint32_t;
+	using std::numeric_limits;
 
 	template<typename T>
 		requires is_class_v<T>
@@ -111,14 +118,13 @@ namespace KalaHeaders
 		inline T* GetParent() { return parent; }
 		inline bool SetParent(T* targetObject)
 		{
+			//only the ancestors of the new parent can form a cycle,
+			//so walking up from it is enough and costs O(depth)
 			if (!thisObject
 				|| !targetObject
 				|| targetObject == thisObject
-				|| HasTarget(targetObject, true)
-				|| targetObject->hierarchy.HasTarget(thisObject, true)
-				|| (parent
-				&& (parent == targetObject
-				|| parent->hierarchy.HasTarget(thisObject, true))))
+				|| parent
+				|| targetObject->hierarchy.IsParent(thisObject, true))
 			{
 				return false;
 			}
@@ -180,8 +186,8 @@ namespace KalaHeaders
 			if (!thisObject
 				|| !targetObject
 				|| targetObject == thisObject
-				|| HasTarget(targetObject, true)
-				|| targetObject->hierarchy.HasTarget(thisObject, true))
+				|| targetObject->hierarchy.parent
+				|| IsParent(targetObject, true))
 			{
 				return false;
 			}
@@ -226,4 +232,322 @@ namespace KalaHeaders
 			children.clear();
 		}
 	};
+
+	//Flat hierarchy store for large trees such as project or outline views.
+	//Nodes live in parallel arrays and are linked by index through
+	//first child, last child and sibling links instead of per node child vectors.
+	//Cycle checks walk the parent chain in O(depth) and full traversals
+	//run in linear time over a cached depth-first order
+	template<typename T>
+	class FlatHierarchy
+	{
+	public:
+		static constexpr uint32_t NONE = (numeric_limits<uint32_t>::max)();
+
+		//Adds a new node as the last child of parent, or as a root if parent is NONE.
+		//Returns the index of the new node or NONE if the parent is invalid
+		inline uint32_t Add(
+			T* object,
+			uint32_t parentIndex = NONE)
+		{
+			if (parentIndex != NONE
+				&& !IsValid(parentIndex))
+			{
+				return NONE;
+			}
+
+			uint32_t index{};
+			if (freeHead != NONE)
+			{
+				index = freeHead;
+				freeHead = nextSibling[index];
+			}
+			else
+			{
+				index = static_cast<uint32_t>(objects.size());
+
+				objects.push_back(nullptr);
+				parent.push_back(NONE);
+				firstChild.push_back(NONE);
+				lastChild.push_back(NONE);
+				nextSibling.push_back(NONE);
+				prevSibling.push_back(NONE);
+				depth.push_back(0);
+				isAlive.push_back(false);
+			}
+
+			objects[index] = object;
+			firstChild[index] = NONE;
+			lastChild[index] = NONE;
+			isAlive[index] = true;
+
+			Link(index, parentIndex);
+
+			++nodeCount;
+			isOrderDirty = true;
+
+			return index;
+		}
+
+		//Removes the node and its whole subtree
+		inline bool Remove(uint32_t index)
+		{
+			if (!IsValid(index)) return false;
+
+			Unlink(index);
+
+			//iterative so deep trees can not overflow the stack
+			vector<uint32_t>& stack = scratch;
+			stack.clear();
+			stack.push_back(index);
+
+			while (!stack.empty())
+			{
+				uint32_t node = stack.back();
+				stack.pop_back();
+
+				for (uint32_t c = firstChild[node]; c != NONE; c = nextSibling[c])
+				{
+					stack.push_back(c);
+				}
+
+				objects[node] = nullptr;
+				parent[node] = NONE;
+				firstChild[node] = NONE;
+				lastChild[node] = NONE;
+				prevSibling[node] = NONE;
+				isAlive[node] = false;
+
+				nextSibling[node] = freeHead;
+				freeHead = node;
+
+				--nodeCount;
+			}
+
+			isOrderDirty = true;
+
+			return true;
+		}
+
+		//Moves the node and its subtree under a new parent, or to the roots if parent is NONE.
+		//Fails if the new parent is the node itself or one of its descendants
+		inline bool SetParent(
+			uint32_t index,
+			uint32_t parentIndex)
+		{
+			if (!IsValid(index)
+				|| (parentIndex != NONE
+				&& (!IsValid(parentIndex)
+				|| IsAncestor(index, parentIndex))))
+			{
+				return false;
+			}
+
+			if (parent[index] == parentIndex) return true;
+
+			Unlink(index);
+			Link(index, parentIndex);
+
+			//depth of the moved subtree is refreshed with the order
+			isOrderDirty = true;
+
+			return true;
+		}
+
+		//Returns true if ancestor is the node itself or any node above it, O(depth)
+		inline bool IsAncestor(
+			uint32_t ancestor,
+			uint32_t index) const
+		{
+			if (!IsValid(ancestor)
+				|| !IsValid(index))
+			{
+				return false;
+			}
+
+			for (uint32_t n = index; n != NONE; n = parent[n])
+			{
+				if (n == ancestor) return true;
+			}
+
+			return false;
+		}
+
+		inline bool IsValid(uint32_t index) const
+		{
+			return index < isAlive.size()
+				&& isAlive[index];
+		}
+
+		inline T* GetObject(uint32_t index) const { return IsValid(index) ? objects[index] : nullptr; }
+		inline uint32_t GetParent(uint32_t index) const { return IsValid(index) ? parent[index] : NONE; }
+		inline uint32_t GetFirstChild(uint32_t index) const { return IsValid(index) ? firstChild[index] : NONE; }
+		inline uint32_t GetNextSibling(uint32_t index) const { return IsValid(index) ? nextSibling[index] : NONE; }
+		inline uint32_t GetFirstRoot() const { return firstRoot; }
+
+		inline size_t Size() const { return nodeCount; }
+
+		//Returns the distance from the root, roots are at depth 0
+		inline uint32_t GetDepth(uint32_t index)
+		{
+			if (!IsValid(index)) return 0;
+
+			RebuildOrder();
+			return depth[index];
+		}
+
+		//Returns all alive nodes in depth-first order,
+		//every subtree is a contiguous range starting at its root
+		inline span<const uint32_t> GetDepthFirstOrder()
+		{
+			RebuildOrder();
+			return order;
+		}
+
+		//Returns the node and all of its descendants in depth-first order
+		inline span<const uint32_t> GetSubtree(uint32_t index)
+		{
+			if (!IsValid(index)) return {};
+
+			RebuildOrder();
+			return span<const uint32_t>(order).subspan(
+				orderPosition[index],
+				subtreeSize[index]);
+		}
+
+		template<typename Func>
+		inline void ForEachChild(
+			uint32_t index,
+			Func&& func) const
+		{
+			if (!IsValid(index)) return;
+
+			for (uint32_t c = firstChild[index]; c != NONE; c = nextSibling[c]) func(c);
+		}
+
+		inline void Clear()
+		{
+			objects.clear();
+			parent.clear();
+			firstChild.clear();
+			lastChild.clear();
+			nextSibling.clear();
+			prevSibling.clear();
+			depth.clear();
+			isAlive.clear();
+
+			order.clear();
+			orderPosition.clear();
+			subtreeSize.clear();
+
+			firstRoot = NONE;
+			lastRoot = NONE;
+			freeHead = NONE;
+			nodeCount = 0;
+			isOrderDirty = false;
+		}
+	private:
+		inline void Link(
+			uint32_t index,
+			uint32_t parentIndex)
+		{
+			uint32_t& head = parentIndex == NONE ? firstRoot : firstChild[parentIndex];
+			uint32_t& tail = parentIndex == NONE ? lastRoot : lastChild[parentIndex];
+
+			parent[index] = parentIndex;
+			prevSibling[index] = tail;
+			nextSibling[index] = NONE;
+
+			if (tail != NONE) nextSibling[tail] = index;
+			else head = index;
+			tail = index;
+		}
+
+		inline void Unlink(uint32_t index)
+		{
+			uint32_t parentIndex = parent[index];
+			uint32_t& head = parentIndex == NONE ? firstRoot : firstChild[parentIndex];
+			uint32_t& tail = parentIndex == NONE ? lastRoot : lastChild[parentIndex];
+
+			if (prevSibling[index] != NONE) nextSibling[prevSibling[index]] = nextSibling[index];
+			else head = nextSibling[index];
+
+			if (nextSibling[index] != NONE) prevSibling[nextSibling[index]] = prevSibling[index];
+			else tail = prevSibling[index];
+
+			parent[index] = NONE;
+			prevSibling[index] = NONE;
+			nextSibling[index] = NONE;
+		}
+
+		//Single linear pass that refreshes the depth-first order, depths and subtree sizes
+		inline void RebuildOrder()
+		{
+			if (!isOrderDirty) return;
+
+			order.clear();
+			order.reserve(nodeCount);
+			orderPosition.assign(objects.size(), NONE);
+			subtreeSize.assign(objects.size(), 0);
+
+			vector<uint32_t>& stack = scratch;
+			stack.clear();
+
+			for (uint32_t root = firstRoot; root != NONE; root = nextSibling[root])
+			{
+				depth[root] = 0;
+				stack.push_back(root);
+
+				while (!stack.empty())
+				{
+					uint32_t node = stack.back();
+					stack.pop_back();
+
+					orderPosition[node] = static_cast<uint32_t>(order.size());
+					order.push_back(node);
+
+					//pushed last to first so children come out in sibling order
+					for (uint32_t c = lastChild[node]; c != NONE; c = prevSibling[c])
+					{
+						depth[c] = depth[node] + 1;
+						stack.push_back(c);
+					}
+				}
+			}
+
+			//children always come after their parent, so walking backwards sums subtree sizes bottom up
+			for (size_t i = order.size(); i-- > 0;)
+			{
+				uint32_t node = order[i];
+				uint32_t size = 1;
+				for (uint32_t c = firstChild[node]; c != NONE; c = nextSibling[c])
+				{
+					size += subtreeSize[c];
+				}
+				subtreeSize[node] = size;
+			}
+
+			isOrderDirty = false;
+		}
+
+		vector<T*> objects{};
+		vector<uint32_t> parent{};
+		vector<uint32_t> firstChild{};
+		vector<uint32_t> lastChild{};
+		vector<uint32_t> nextSibling{}; //doubles as the free list link of removed nodes
+		vector<uint32_t> prevSibling{};
+		vector<uint32_t> depth{};
+		vector<bool> isAlive{};
+
+		vector<uint32_t> order{};
+		vector<uint32_t> orderPosition{};
+		vector<uint32_t> subtreeSize{};
+		vector<uint32_t> scratch{};
+
+		uint32_t firstRoot = NONE;
+		uint32_t lastRoot = NONE;
+		uint32_t freeHead = NONE;
+		size_t nodeCount{};
+		bool isOrderDirty{};
+	};
 }
\ No newline at end of file
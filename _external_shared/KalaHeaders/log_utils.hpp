@@ -11,6 +11,7 @@
 //   - Simple logger - just a fwrite to the console with a single string parameter
 //   - Log types - info (no log type stamp), debug (skipped in release), success, warning, error
 //   - Time stamp, date stamp accurate to system clock
+//   - Optional profiling hook through KalaHeaders::ProfileHook (profile_hook.hpp)
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -18,11 +19,14 @@
 #include <cstring>
 #include <ctime>
 #include <cstdio>
+#include <cstdint>
 #include <string>
 #include <chrono>
 #include <array>
 #include <algorithm>
 
+#include "profile_hook.hpp"
+
 namespace KalaHeaders
 {
 	using std::string;
@@ -321,6 +325,8 @@ namespace KalaHeaders
 			TimeFormat timeFormat = TimeFormat::TIME_DEFAULT,
 			DateFormat dateFormat = DateFormat::DATE_DEFAULT)
 		{
+			KALAHEADERS_PROFILE_ZONE("Log::Print");
+
 #ifndef _DEBUG
 			if (type == LogType::LOG_DEBUG) return;
 #endif
@@ -422,6 +428,8 @@ namespace KalaHeaders
 			string_view message,
 			bool flush = false)
 		{
+			KALAHEADERS_PROFILE_ZONE("Log::Print");
+
 			if (message.empty()) return;
 
 			message = message.substr(0, MAX_MESSAGE_LENGTH);
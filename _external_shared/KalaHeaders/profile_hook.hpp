@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+// profile_hook.hpp
+//
+// Copyright (C) 2025 Lost Empire Entertainment
+//
+// This is free source code, and you are welcome to redistribute it under certain conditions.
+// Read LICENSE.md for more information.
+//
+// Provides:
+//   - Instrumentation hook shared by all KalaHeaders (ProfileHook)
+//   - Scoped zone that reports to the hook (KALAHEADERS_PROFILE_ZONE)
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+//Install both function pointers of ProfileHook once at startup
+//to time the functions of every header that includes this one.
+//The macro expands the same way in every translation unit,
+//each zone is a single null check while no hook is installed
+#ifndef KALAHEADERS_PROFILE_ZONE
+namespace KalaHeaders
+{
+	struct ProfileHook
+	{
+		//monotonic time in nanoseconds
+		static inline uint64_t(*getTime)() = nullptr;
+		//called once per finished zone, name is always a string literal
+		static inline void(*recordZone)(
+			const char* name,
+			uint64_t startNS,
+			uint64_t endNS) = nullptr;
+	};
+
+	struct ProfileHookZone
+	{
+		inline explicit ProfileHookZone(const char* zoneName)
+		{
+			if (!ProfileHook::recordZone
+				|| !ProfileHook::getTime)
+			{
+				return;
+			}
+
+			name = zoneName;
+			startNS = ProfileHook::getTime();
+		}
+
+		inline ~ProfileHookZone()
+		{
+			if (name) ProfileHook::recordZone(name, startNS, ProfileHook::getTime());
+		}
+
+		ProfileHookZone(const ProfileHookZone&) = delete;
+		ProfileHookZone& operator=(const ProfileHookZone&) = delete;
+
+		const char* name{};
+		uint64_t startNS{};
+	};
+}
+
+#define KALAHEADERS_PROFILE_CONCAT_INNER(a, b) a##b
+#define KALAHEADERS_PROFILE_CONCAT(a, b) KALAHEADERS_PROFILE_CONCAT_INNER(a, b)
+#define KALAHEADERS_PROFILE_ZONE(name) KalaHeaders::ProfileHookZone KALAHEADERS_PROFILE_CONCAT(kalaProfileZone_, __LINE__)(name)
+#endif
\ No newline at end of file
@@ -17,6 +17,8 @@
 #include <cerrno>
 #include <cstring>
 #include <string>
+#include <span>
+#include <unordered_map>
 
 #include "KalaHeaders/file_utils.hpp"
 #include "KalaHeaders/math_utils.hpp"
@@ -37,11 +39,16 @@ namespace KalaFont
 	using std::string;
 	using std::to_string;
 	using std::move;
+	using std::span;
+	using std::unordered_map;
+	using std::memcpy;
 	
 	using KalaHeaders::vec2;
 	using KalaHeaders::mat2;
 	using KalaHeaders::Log;
 	using KalaHeaders::LogType;
+	using KalaHeaders::MappedFile;
+	using KalaHeaders::MapFile;
 	
 	struct GlyphPoint
 	{
@@ -277,4 +284,827 @@ namespace KalaFont
 		
 		return true;
 	}
+
+	//
+	// VERSION 2
+	//
+	// Header, then a glyph table sorted by glyph index, then a codepoint table
+	// sorted by codepoint, then the glyph data. Every field is 4 bytes,
+	// so all tables and uncompressed glyph data stay 4 byte aligned.
+	//
+
+	constexpr u32 KFONT_V2_HEADER_SIZE = 40;
+	constexpr u32 KFONT_V2_GLYPH_ENTRY_SIZE = 56;
+	constexpr u32 KFONT_V2_CODEPOINT_ENTRY_SIZE = 8;
+
+	enum class GlyphCompression : u32
+	{
+		//vertices as f32 followed by indices as u32
+		COMPRESSION_NONE = 0,
+
+		//vertex bits xor'd with the previous value on the same axis and indices as
+		//zigzag deltas, both written as LEB128 varints. Lossless
+		COMPRESSION_DELTA_VARINT = 1
+	};
+
+	struct KalaFontHeaderV2
+	{
+		char magic[4]{ 'K', 'F', 'N', 'T' };
+		u32 version = 2;
+		u32 glyphCount{};
+		u32 codepointCount{};
+
+		//absolute file offsets
+		u32 glyphTableOffset{};
+		u32 codepointTableOffset{};
+		u32 dataOffset{};
+		u32 dataSize{};
+
+		//sums over all glyphs, used to size flat copies up front
+		u32 totalVertexFloats{};
+		u32 totalIndices{};
+	};
+
+	struct KalaFontGlyphEntryV2
+	{
+		u32 glyphIndex{};
+		f32 advanceWidth{};
+		f32 leftSideBearing{};
+		vec2 anchor{};
+		f32 transform[4]{}; //m00, m01, m10, m11
+
+		u32 vertexFloats{};
+		u32 indexCount{};
+
+		//relative to the start of the data section
+		u32 dataOffset{};
+		u32 dataSize{};
+		GlyphCompression compression{};
+	};
+
+	struct KalaFontCodepointEntryV2
+	{
+		u32 codepoint{};
+		u32 glyph{}; //position in the glyph table
+	};
+
+	static_assert(sizeof(KalaFontHeaderV2) == KFONT_V2_HEADER_SIZE);
+	static_assert(sizeof(KalaFontGlyphEntryV2) == KFONT_V2_GLYPH_ENTRY_SIZE);
+	static_assert(sizeof(KalaFontCodepointEntryV2) == KFONT_V2_CODEPOINT_ENTRY_SIZE);
+
+	//Glyph whose vertices and indices point into a mapped .kfont file,
+	//or into the decode cache of the font for compressed glyphs
+	struct GlyphView
+	{
+		span<const f32> vertices{}; //x, y pairs
+		span<const u32> indices{};
+
+		vec2 anchor{};
+		mat2 transform{};
+		u32 glyphIndex{};
+		f32 advanceWidth{};
+		f32 leftSideBearing{};
+	};
+
+	//Memory-mapped .kfont file. Version 1 files are validated in one pass on open,
+	//version 2 files only have their header and table bounds checked on open
+	//and each glyph is validated and decoded the first time it is requested.
+	//Spans stay valid until the font is closed or moved from
+	class MappedKalaFont
+	{
+	public:
+		static constexpr u32 NONE = 0xFFFFFFFF;
+
+		inline bool Open(const path& fontPath)
+		{
+			Close();
+
+			if (!fontPath.has_extension()
+				|| fontPath.extension() != ".kfont")
+			{
+				Log::Print(
+					"Font '" + fontPath.string() + "' does not have a valid extension!",
+					"READ_KFONT",
+					LogType::LOG_ERROR);
+
+				return false;
+			}
+
+			string result = MapFile(fontPath, file);
+			if (!result.empty())
+			{
+				Log::Print(
+					result,
+					"READ_KFONT",
+					LogType::LOG_ERROR);
+
+				return false;
+			}
+
+			fontName = fontPath.string();
+
+			u32 fileVersion{};
+			if (file.GetSize() >= 8) memcpy(&fileVersion, file.GetData() + 4, sizeof(u32));
+
+			bool isValid = fileVersion == 2
+				? ParseHeaderV2()
+				: ParseV1();
+
+			if (!isValid)
+			{
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		inline void Close()
+		{
+			version = 0;
+			glyphCount = 0;
+			codepointCount = 0;
+			totalVertexFloats = 0;
+			totalIndices = 0;
+
+			glyphs.clear();
+			decoded.clear();
+			fontName.clear();
+
+			file.Close();
+		}
+
+		inline bool IsOpen() const { return file.IsOpen(); }
+		inline u32 GetVersion() const { return version; }
+
+		inline u32 GetGlyphCount() const { return glyphCount; }
+
+		//Sums over all glyphs, used to size flat copies up front
+		inline size_t GetTotalVertexFloats() const { return totalVertexFloats; }
+		inline size_t GetTotalIndices() const { return totalIndices; }
+
+		//Fills 'out' with the glyph at 'glyph', decoding it first if needed.
+		//Returns false if the glyph does not exist or its data is corrupt
+		inline bool GetGlyph(
+			u32 glyph,
+			GlyphView& out)
+		{
+			if (glyph >= glyphCount) return false;
+
+			if (version == 1)
+			{
+				out = glyphs[glyph];
+				return true;
+			}
+
+			return LoadGlyphV2(glyph, out);
+		}
+
+		//Fills 'out' with the metrics of the glyph at 'glyph' and the counts with the size
+		//of its data without decoding it, the spans of 'out' stay empty.
+		//Returns false if the glyph does not exist
+		inline bool GetGlyphInfo(
+			u32 glyph,
+			GlyphView& out,
+			u32& outVertexFloats,
+			u32& outIndexCount) const
+		{
+			if (glyph >= glyphCount) return false;
+
+			if (version == 1)
+			{
+				out = glyphs[glyph];
+				outVertexFloats = static_cast<u32>(out.vertices.size());
+				outIndexCount = static_cast<u32>(out.indices.size());
+
+				out.vertices = {};
+				out.indices = {};
+
+				return true;
+			}
+
+			KalaFontGlyphEntryV2 entry{};
+			memcpy(&entry, GetGlyphEntryV2(glyph), sizeof(entry));
+
+			out = {};
+			FillGlyphMetrics(entry, out);
+			outVertexFloats = entry.vertexFloats;
+			outIndexCount = entry.indexCount;
+
+			return true;
+		}
+
+		//Copies the vertices and indices of the glyph at 'glyph' into the spans, which must have
+		//the sizes GetGlyphInfo returns. Compressed glyphs are decoded straight into them
+		//and are not kept in the decode cache. Returns false if the glyph does not exist or its data is corrupt
+		inline bool CopyGlyph(
+			u32 glyph,
+			span<f32> outVertices,
+			span<u32> outIndices)
+		{
+			if (glyph >= glyphCount) return false;
+
+			if (version == 2)
+			{
+				KalaFontGlyphEntryV2 entry{};
+				memcpy(&entry, GetGlyphEntryV2(glyph), sizeof(entry));
+
+				if (entry.compression == GlyphCompression::COMPRESSION_DELTA_VARINT
+					&& !decoded.contains(glyph))
+				{
+					if (outVertices.size() != entry.vertexFloats
+						|| outIndices.size() != entry.indexCount
+						|| !CheckGlyphEntryV2(glyph, entry))
+					{
+						return false;
+					}
+
+					if (!DecodeDeltaVarint(
+						file.GetData() + dataOffset + entry.dataOffset,
+						entry,
+						outVertices,
+						outIndices))
+					{
+						return Fail("has corrupt compressed data for glyph '" + to_string(glyph) + "'!");
+					}
+
+					return true;
+				}
+			}
+
+			GlyphView view{};
+			if (!GetGlyph(glyph, view)
+				|| view.vertices.size() != outVertices.size()
+				|| view.indices.size() != outIndices.size())
+			{
+				return false;
+			}
+
+			if (!view.vertices.empty()) memcpy(outVertices.data(), view.vertices.data(), view.vertices.size_bytes());
+			if (!view.indices.empty()) memcpy(outIndices.data(), view.indices.data(), view.indices.size_bytes());
+
+			return true;
+		}
+
+		inline u32 GetCodepointCount() const { return codepointCount; }
+
+		//Fills 'out' with entry 'index' of the codepoint table,
+		//entries are sorted by codepoint
+		inline bool GetCodepointEntry(
+			u32 index,
+			KalaFontCodepointEntryV2& out) const
+		{
+			if (version != 2
+				|| index >= codepointCount)
+			{
+				return false;
+			}
+
+			memcpy(
+				&out,
+				file.GetData() + codepointTableOffset + static_cast<size_t>(index) * KFONT_V2_CODEPOINT_ENTRY_SIZE,
+				sizeof(out));
+
+			return true;
+		}
+
+		//Returns the glyph mapped to the codepoint or NONE,
+		//version 1 files have no codepoint table and always return NONE
+		inline u32 FindGlyphByCodepoint(u32 codepoint) const
+		{
+			if (version != 2) return NONE;
+
+			const u8* table = file.GetData() + codepointTableOffset;
+
+			u32 low{};
+			u32 high = codepointCount;
+			while (low < high)
+			{
+				u32 mid = low + (high - low) / 2;
+
+				KalaFontCodepointEntryV2 entry{};
+				memcpy(&entry, table + static_cast<size_t>(mid) * KFONT_V2_CODEPOINT_ENTRY_SIZE, sizeof(entry));
+
+				if (entry.codepoint == codepoint) return entry.glyph < glyphCount ? entry.glyph : NONE;
+				if (entry.codepoint < codepoint) low = mid + 1;
+				else high = mid;
+			}
+
+			return NONE;
+		}
+
+		//Returns the glyph with the font glyph index or NONE.
+		//Binary search in version 2, linear in version 1
+		inline u32 FindGlyphByIndex(u32 glyphIndex) const
+		{
+			if (version == 1)
+			{
+				for (u32 i = 0; i < glyphCount; ++i)
+				{
+					if (glyphs[i].glyphIndex == glyphIndex) return i;
+				}
+				return NONE;
+			}
+			if (version != 2) return NONE;
+
+			u32 low{};
+			u32 high = glyphCount;
+			while (low < high)
+			{
+				u32 mid = low + (high - low) / 2;
+
+				u32 midIndex{};
+				memcpy(&midIndex, GetGlyphEntryV2(mid), sizeof(u32));
+
+				if (midIndex == glyphIndex) return mid;
+				if (midIndex < glyphIndex) low = mid + 1;
+				else high = mid;
+			}
+
+			return NONE;
+		}
+	private:
+		struct DecodedGlyph
+		{
+			vector<f32> vertices{};
+			vector<u32> indices{};
+		};
+
+		inline bool Fail(const string& reason) const
+		{
+			Log::Print(
+				"Font '" + fontName + "' " + reason,
+				"READ_KFONT",
+				LogType::LOG_ERROR);
+
+			return false;
+		}
+
+		//Walks a version 1 file once, checks every tag and count against the file size
+		//and records where the data of each glyph starts
+		inline bool ParseV1()
+		{
+			const u8* data = file.GetData();
+			size_t size = file.GetSize();
+			size_t offset{};
+
+			auto Has = [&](size_t bytes) { return bytes <= size - offset; };
+			auto ReadU32 = [&]()
+				{
+					u32 v{};
+					memcpy(&v, data + offset, sizeof(u32));
+					offset += sizeof(u32);
+					return v;
+				};
+			auto ReadF32 = [&]()
+				{
+					f32 v{};
+					memcpy(&v, data + offset, sizeof(f32));
+					offset += sizeof(f32);
+					return v;
+				};
+			auto ReadTag = [&](const char* tag)
+				{
+					bool isMatch = memcmp(data + offset, tag, 4) == 0;
+					offset += 4;
+					return isMatch;
+				};
+
+			//
+			// HEADER
+			//
+
+			if (!Has(12)) return Fail("is too small to be a font!");
+
+			if (!ReadTag("KFNT")) return Fail("does not have the correct magic!");
+
+			u32 fileVersion = ReadU32();
+			u32 fileGlyphCount = ReadU32();
+
+			if (fileVersion != 1) return Fail("has invalid version value!");
+			if (fileGlyphCount == 0) return Fail("has invalid glyph count value!");
+
+			//every glyph takes at least 56 bytes, so a corrupt count can not reserve more than the file holds
+			constexpr size_t MIN_GLYPH_SIZE = 56;
+			if (fileGlyphCount > (size - offset) / MIN_GLYPH_SIZE) return Fail("has more glyphs than the file can hold!");
+
+			glyphs.reserve(fileGlyphCount);
+
+			//
+			// GLYPH BLOCKS
+			//
+
+			for (u32 g = 0; g < fileGlyphCount; ++g)
+			{
+				string glyphName = "'" + to_string(g) + "'";
+
+				//tag, core, anchor and transform
+				if (!Has(40)) return Fail("ends inside glyph " + glyphName + "!");
+				if (!ReadTag("GLYF")) return Fail("has invalid glyph tag for glyph " + glyphName + "!");
+
+				GlyphView glyph{};
+
+				glyph.glyphIndex = ReadU32();
+				glyph.advanceWidth = ReadF32();
+				glyph.leftSideBearing = ReadF32();
+
+				glyph.anchor.x = ReadF32();
+				glyph.anchor.y = ReadF32();
+
+				glyph.transform.m00 = ReadF32();
+				glyph.transform.m01 = ReadF32();
+				glyph.transform.m10 = ReadF32();
+				glyph.transform.m11 = ReadF32();
+
+				//vertices
+				if (!Has(8)) return Fail("ends inside glyph " + glyphName + "!");
+				if (!ReadTag("VERT")) return Fail("has invalid vertice tag for glyph " + glyphName + "!");
+
+				u64 vertexFloats = static_cast<u64>(ReadU32()) * 2;
+				if (!Has(vertexFloats * sizeof(f32))) return Fail("has more vertices than the file holds for glyph " + glyphName + "!");
+
+				//every field is 4 bytes and the mapping is page aligned, so the data is aligned too
+				glyph.vertices = span<const f32>(
+					reinterpret_cast<const f32*>(data + offset),
+					static_cast<size_t>(vertexFloats));
+				offset += static_cast<size_t>(vertexFloats) * sizeof(f32);
+
+				//indices
+				if (!Has(8)) return Fail("ends inside glyph " + glyphName + "!");
+				if (!ReadTag("INDI")) return Fail("has invalid indice tag for glyph " + glyphName + "!");
+
+				u64 indexCount = ReadU32();
+				if (!Has(indexCount * sizeof(u32))) return Fail("has more indices than the file holds for glyph " + glyphName + "!");
+
+				glyph.indices = span<const u32>(
+					reinterpret_cast<const u32*>(data + offset),
+					static_cast<size_t>(indexCount));
+				offset += static_cast<size_t>(indexCount) * sizeof(u32);
+
+				totalVertexFloats += glyph.vertices.size();
+				totalIndices += glyph.indices.size();
+
+				glyphs.push_back(glyph);
+			}
+
+			version = 1;
+			glyphCount = fileGlyphCount;
+
+			return true;
+		}
+
+		//Checks the header, that both tables and the data section lie inside the file
+		//and that the data totals fit in the data section,
+		//glyph entries are checked when their glyph is first loaded
+		inline bool ParseHeaderV2()
+		{
+			size_t size = file.GetSize();
+			if (size < KFONT_V2_HEADER_SIZE) return Fail("is too small to be a font!");
+
+			KalaFontHeaderV2 header{};
+			memcpy(&header, file.GetData(), sizeof(header));
+
+			if (memcmp(header.magic, "KFNT", 4) != 0) return Fail("does not have the correct magic!");
+			if (header.glyphCount == 0) return Fail("has invalid glyph count value!");
+
+			auto Fits = [size](u64 offset, u64 bytes)
+				{
+					return offset % 4 == 0
+						&& offset <= size
+						&& bytes <= size - offset;
+				};
+
+			if (!Fits(header.glyphTableOffset, static_cast<u64>(header.glyphCount) * KFONT_V2_GLYPH_ENTRY_SIZE))
+			{
+				return Fail("has a glyph table outside of the file!");
+			}
+			if (!Fits(header.codepointTableOffset, static_cast<u64>(header.codepointCount) * KFONT_V2_CODEPOINT_ENTRY_SIZE))
+			{
+				return Fail("has a codepoint table outside of the file!");
+			}
+			if (!Fits(header.dataOffset, header.dataSize))
+			{
+				return Fail("has a data section outside of the file!");
+			}
+
+			//flat loads size their arrays from the totals, every value takes at least
+			//one byte as a varint and four bytes uncompressed, so larger totals can not be real
+			if (static_cast<u64>(header.totalVertexFloats) + header.totalIndices > header.dataSize)
+			{
+				return Fail("has glyph data totals that do not fit in its data section!");
+			}
+
+			version = 2;
+			glyphCount = header.glyphCount;
+			codepointCount = header.codepointCount;
+			glyphTableOffset = header.glyphTableOffset;
+			codepointTableOffset = header.codepointTableOffset;
+			dataOffset = header.dataOffset;
+			dataSize = header.dataSize;
+			totalVertexFloats = header.totalVertexFloats;
+			totalIndices = header.totalIndices;
+
+			return true;
+		}
+
+		inline const u8* GetGlyphEntryV2(u32 glyph) const
+		{
+			return file.GetData() + glyphTableOffset + static_cast<size_t>(glyph) * KFONT_V2_GLYPH_ENTRY_SIZE;
+		}
+
+		//Checks that the data of the glyph lies in the data section and fits its counts
+		inline bool CheckGlyphEntryV2(
+			u32 glyph,
+			const KalaFontGlyphEntryV2& entry) const
+		{
+			string glyphName = "'" + to_string(glyph) + "'";
+
+			if (static_cast<u64>(entry.dataOffset) + entry.dataSize > dataSize)
+			{
+				return Fail("has data outside of the data section for glyph " + glyphName + "!");
+			}
+
+			switch (entry.compression)
+			{
+			case GlyphCompression::COMPRESSION_NONE:
+			{
+				u64 expected =
+					static_cast<u64>(entry.vertexFloats) * sizeof(f32)
+					+ static_cast<u64>(entry.indexCount) * sizeof(u32);
+
+				if (entry.dataOffset % 4 != 0
+					|| entry.dataSize != expected)
+				{
+					return Fail("has invalid data size for glyph " + glyphName + "!");
+				}
+
+				return true;
+			}
+			case GlyphCompression::COMPRESSION_DELTA_VARINT:
+			{
+				//every varint takes at least one byte
+				if (static_cast<u64>(entry.vertexFloats) + entry.indexCount > entry.dataSize)
+				{
+					return Fail("has invalid data size for glyph " + glyphName + "!");
+				}
+
+				return true;
+			}
+			}
+
+			return Fail("has unknown compression for glyph " + glyphName + "!");
+		}
+
+		static inline void FillGlyphMetrics(
+			const KalaFontGlyphEntryV2& entry,
+			GlyphView& out)
+		{
+			out.glyphIndex = entry.glyphIndex;
+			out.advanceWidth = entry.advanceWidth;
+			out.leftSideBearing = entry.leftSideBearing;
+			out.anchor = entry.anchor;
+			out.transform.m00 = entry.transform[0];
+			out.transform.m01 = entry.transform[1];
+			out.transform.m10 = entry.transform[2];
+			out.transform.m11 = entry.transform[3];
+		}
+
+		inline bool LoadGlyphV2(
+			u32 glyph,
+			GlyphView& out)
+		{
+			KalaFontGlyphEntryV2 entry{};
+			memcpy(&entry, GetGlyphEntryV2(glyph), sizeof(entry));
+
+			if (!CheckGlyphEntryV2(glyph, entry)) return false;
+
+			out = {};
+			FillGlyphMetrics(entry, out);
+
+			const u8* data = file.GetData() + dataOffset + entry.dataOffset;
+
+			if (entry.compression == GlyphCompression::COMPRESSION_NONE)
+			{
+				out.vertices = span<const f32>(
+					reinterpret_cast<const f32*>(data),
+					entry.vertexFloats);
+				out.indices = span<const u32>(
+					reinterpret_cast<const u32*>(data + static_cast<size_t>(entry.vertexFloats) * sizeof(f32)),
+					entry.indexCount);
+
+				return true;
+			}
+
+			auto it = decoded.find(glyph);
+			if (it == decoded.end())
+			{
+				DecodedGlyph result{};
+				result.vertices.resize(entry.vertexFloats);
+				result.indices.resize(entry.indexCount);
+
+				if (!DecodeDeltaVarint(data, entry, result.vertices, result.indices))
+				{
+					return Fail("has corrupt compressed data for glyph '" + to_string(glyph) + "'!");
+				}
+
+				it = decoded.emplace(glyph, move(result)).first;
+			}
+
+			out.vertices = it->second.vertices;
+			out.indices = it->second.indices;
+
+			return true;
+		}
+
+		//Decodes into spans sized to the counts of the entry
+		static inline bool DecodeDeltaVarint(
+			const u8* data,
+			const KalaFontGlyphEntryV2& entry,
+			span<f32> outVertices,
+			span<u32> outIndices)
+		{
+			size_t offset{};
+
+			auto ReadVarint = [&](u32& value)
+				{
+					value = 0;
+					for (u32 shift = 0; shift < 35; shift += 7)
+					{
+						if (offset >= entry.dataSize) return false;
+
+						u8 byte = data[offset++];
+						value |= static_cast<u32>(byte & 0x7F) << shift;
+
+						if ((byte & 0x80) == 0) return true;
+					}
+					return false;
+				};
+
+			//x and y are xor'd with the previous value of the same axis
+			u32 previous[2]{};
+			for (u32 i = 0; i < entry.vertexFloats; ++i)
+			{
+				u32 bits{};
+				if (!ReadVarint(bits)) return false;
+
+				bits ^= previous[i & 1];
+				previous[i & 1] = bits;
+
+				memcpy(&outVertices[i], &bits, sizeof(f32));
+			}
+
+			u32 previousIndex{};
+			for (u32 i = 0; i < entry.indexCount; ++i)
+			{
+				u32 zigzag{};
+				if (!ReadVarint(zigzag)) return false;
+
+				u32 delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+				previousIndex += delta;
+
+				outIndices[i] = previousIndex;
+			}
+
+			return true;
+		}
+
+		MappedFile file{};
+		string fontName{};
+
+		u32 version{};
+		u32 glyphCount{};
+		u32 codepointCount{};
+		size_t totalVertexFloats{};
+		size_t totalIndices{};
+
+		//version 1, all glyphs are located on open
+		vector<GlyphView> glyphs{};
+
+		//version 2
+		u32 glyphTableOffset{};
+		u32 codepointTableOffset{};
+		u32 dataOffset{};
+		u32 dataSize{};
+
+		//node based so spans handed out for a glyph survive later decodes
+		unordered_map<u32, DecodedGlyph> decoded{};
+	};
+
+	//Glyph whose vertices and indices are ranges of the arenas in FlatFontData
+	struct FlatGlyph
+	{
+		u32 vertexOffset{}; //first float in FlatFontData::vertices
+		u32 vertexFloats{};
+		u32 indexOffset{};  //first index in FlatFontData::indices
+		u32 indexCount{};
+
+		vec2 anchor{};
+		mat2 transform{};
+		u32 glyphIndex{};
+		f32 advanceWidth{};
+		f32 leftSideBearing{};
+	};
+
+	//All glyphs of a font in two flat arenas instead of two vectors per glyph
+	struct FlatFontData
+	{
+		vector<f32> vertices{};
+		vector<u32> indices{};
+		vector<FlatGlyph> glyphs{};
+
+		//sorted by codepoint, empty for version 1 files
+		vector<KalaFontCodepointEntryV2> codepoints{};
+
+		inline span<const f32> GetVertices(const FlatGlyph& glyph) const
+		{
+			return span<const f32>(vertices).subspan(glyph.vertexOffset, glyph.vertexFloats);
+		}
+		inline span<const u32> GetIndices(const FlatGlyph& glyph) const
+		{
+			return span<const u32>(indices).subspan(glyph.indexOffset, glyph.indexCount);
+		}
+	};
+
+	//Maps and validates the font, then copies or decodes every glyph straight
+	//into arenas that are sized once. The file is unmapped before this returns
+	inline bool ImportKalaFontFlat(
+		const path& fontPath,
+		FlatFontData& outData)
+	{
+		MappedKalaFont font{};
+		if (!font.Open(fontPath)) return false;
+
+		outData.vertices.resize(font.GetTotalVertexFloats());
+		outData.indices.resize(font.GetTotalIndices());
+		outData.glyphs.clear();
+		outData.glyphs.reserve(font.GetGlyphCount());
+
+		size_t vertexOffset{};
+		size_t indexOffset{};
+
+		for (u32 g = 0; g < font.GetGlyphCount(); ++g)
+		{
+			GlyphView view{};
+			u32 vertexFloats{};
+			u32 indexCount{};
+			if (!font.GetGlyphInfo(g, view, vertexFloats, indexCount)) return false;
+
+			//totals come from the file header in version 2 and must match the glyphs
+			if (vertexFloats > outData.vertices.size() - vertexOffset
+				|| indexCount > outData.indices.size() - indexOffset)
+			{
+				Log::Print(
+					"Font '" + fontPath.string() + "' has more glyph data than its header states!",
+					"READ_KFONT",
+					LogType::LOG_ERROR);
+
+				return false;
+			}
+
+			//compressed glyphs decode straight into the arenas instead of the decode cache
+			if (!font.CopyGlyph(
+				g,
+				span<f32>(outData.vertices).subspan(vertexOffset, vertexFloats),
+				span<u32>(outData.indices).subspan(indexOffset, indexCount)))
+			{
+				return false;
+			}
+
+			FlatGlyph glyph{};
+
+			glyph.vertexOffset = static_cast<u32>(vertexOffset);
+			glyph.vertexFloats = vertexFloats;
+			glyph.indexOffset = static_cast<u32>(indexOffset);
+			glyph.indexCount = indexCount;
+
+			glyph.anchor = view.anchor;
+			glyph.transform = view.transform;
+			glyph.glyphIndex = view.glyphIndex;
+			glyph.advanceWidth = view.advanceWidth;
+			glyph.leftSideBearing = view.leftSideBearing;
+
+			vertexOffset += vertexFloats;
+			indexOffset += indexCount;
+
+			outData.glyphs.push_back(glyph);
+		}
+
+		outData.vertices.resize(vertexOffset);
+		outData.indices.resize(indexOffset);
+
+		outData.codepoints.clear();
+		outData.codepoints.reserve(font.GetCodepointCount());
+
+		for (u32 c = 0; c < font.GetCodepointCount(); ++c)
+		{
+			KalaFontCodepointEntryV2 entry{};
+			if (font.GetCodepointEntry(c, entry)
+				&& entry.glyph < font.GetGlyphCount())
+			{
+				outData.codepoints.push_back(entry);
+			}
+		}
+
+		return true;
+	}
 }
\ No newline at end of file
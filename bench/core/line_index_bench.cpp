@@ -0,0 +1,201 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of the memory-mapped line index in KalaHeaders file_utils
+// against reading the same file with getline, and of reopening it through LineIndexStore sidecars.
+// Build together with src/core/line_index_store.cpp and src/core/profiler.cpp with optimizations on,
+// add -mavx2 to measure the AVX2 path.
+// Usage: line_index_bench [text file], without a file a 256 MB log is generated in the temp directory
+// ===================================================================================
+
+#include "core/profiler.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "KalaHeaders/file_utils.hpp"
+
+#include "core/line_index_store.hpp"
+
+using KalaHeaders::LineIndex;
+using KalaHeaders::IndexLines;
+using KalaHeaders::GetTextFileLineCount;
+using KalaHeaders::ReadLinesFromFile;
+
+using Solin::Core::LineIndexStore;
+
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::ofstream;
+using std::min;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::filesystem::path;
+using std::filesystem::exists;
+using std::filesystem::file_size;
+using std::filesystem::temp_directory_path;
+using std::filesystem::remove_all;
+
+constexpr size_t GENERATED_BYTES = 256ULL * 1024 * 1024;
+
+//every measurement keeps the fastest of this many runs, the first one also warms the page cache
+constexpr int RUN_COUNT = 3;
+
+template<typename F>
+static double BestMilliseconds(F&& run)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+static void Report(
+	const char* name,
+	double ms,
+	uintmax_t bytes)
+{
+	std::printf("%-32s %9.1f ms %7.2f GB/s\n", name, ms, bytes / 1e6 / ms);
+}
+
+//log lines of varying length with some CRLF endings, like a long running service would write
+static void GenerateLog(const path& target)
+{
+	ofstream out(target, std::ios::binary);
+
+	size_t written{};
+	for (u64 i = 0; written < GENERATED_BYTES; ++i)
+	{
+		string line =
+			"2025-01-01 12:" + std::to_string(i / 60000 % 60) + ":" + std::to_string(i / 1000 % 60)
+			+ " [" + (i % 97 == 0 ? "ERROR" : "INFO") + "] worker " + std::to_string(i % 16)
+			+ " processed request " + std::to_string(i)
+			+ string(i % 40, '.')
+			+ (i % 11 == 0 ? "\r\n" : "\n");
+
+		out << line;
+		written += line.size();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	path target = argc > 1
+		? path(argv[1])
+		: temp_directory_path() / "solin_line_index_bench.log";
+
+	if (argc <= 1
+		&& !exists(target))
+	{
+		std::printf("generating %s\n", target.string().c_str());
+		GenerateLog(target);
+	}
+
+	uintmax_t bytes = file_size(target);
+
+	size_t indexedCount{};
+	double indexMs = BestMilliseconds([&]
+		{
+			LineIndex index{};
+			IndexLines(target, index);
+			indexedCount = index.GetLineCount();
+		});
+
+	size_t countedCount{};
+	double countMs = BestMilliseconds([&]
+		{
+			GetTextFileLineCount(target, countedCount);
+		});
+
+	size_t getlineCount{};
+	double getlineCountMs = BestMilliseconds([&]
+		{
+			ifstream in(target);
+			string line{};
+
+			getlineCount = 0;
+			while (getline(in, line)) ++getlineCount;
+		});
+
+	size_t readCount{};
+	double readMs = BestMilliseconds([&]
+		{
+			vector<string> lines{};
+			ReadLinesFromFile(target, lines);
+			readCount = lines.size();
+		});
+
+	//what ReadLinesFromFile did before the index, one string per line straight from the stream
+	size_t getlineReadCount{};
+	double getlineReadMs = BestMilliseconds([&]
+		{
+			ifstream in(target);
+			vector<string> lines{};
+			string line{};
+
+			while (getline(in, line)) lines.push_back(line);
+			getlineReadCount = lines.size();
+		});
+
+	std::printf("%s: %.2f GB, %zu lines\n", target.string().c_str(), bytes / 1e9, indexedCount);
+
+	Report("IndexLines", indexMs, bytes);
+	Report("GetTextFileLineCount", countMs, bytes);
+	Report("getline count", getlineCountMs, bytes);
+	Report("ReadLinesFromFile", readMs, bytes);
+	Report("getline into vector<string>", getlineReadMs, bytes);
+
+	//the first open scans and writes the sidecar, the ones after it only read the sidecar
+	path cacheDir = temp_directory_path() / "solin_line_index_bench_cache";
+	remove_all(cacheDir);
+
+	auto openStored = [&](size_t& outCount)
+		{
+			auto start = steady_clock::now();
+
+			LineIndex index{};
+			LineIndexStore::Open(target, cacheDir, index);
+			outCount = index.GetLineCount();
+
+			double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+			LineIndexStore::Flush();
+			return ms;
+		};
+
+	size_t storedCount{};
+	double coldOpenMs = openStored(storedCount);
+
+	size_t reopenedCount{};
+	double reopenMs = BestMilliseconds([&] { openStored(reopenedCount); });
+
+	Report("LineIndexStore::Open, no sidecar", coldOpenMs, bytes);
+	Report("LineIndexStore::Open, sidecar", reopenMs, bytes);
+
+	bool isConsistent = indexedCount == getlineCount
+		&& storedCount == getlineCount
+		&& reopenedCount == getlineCount
+		&& countedCount == getlineCount
+		&& readCount == getlineCount
+		&& getlineReadCount == getlineCount;
+
+	if (!isConsistent) std::printf("line counts differ between the methods!\n");
+
+	return isConsistent ? 0 : 1;
+}
\ No newline at end of file
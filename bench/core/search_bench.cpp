@@ -0,0 +1,202 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of GetRangeByValue and GetRangeByValues in KalaHeaders file_utils
+// against a std::search scan over the same mapped bytes.
+// Build together with src/core/profiler.cpp with optimizations on, add -mavx2 to measure the AVX2 path.
+// Usage: search_bench [file [pattern...]], without a file a 256 MB log is generated in the temp directory.
+// One pattern is timed alone and against std::search, several are also timed in one pass
+// ===================================================================================
+
+#include "core/profiler.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "KalaHeaders/file_utils.hpp"
+
+using KalaHeaders::BinaryRange;
+using KalaHeaders::MappedFile;
+using KalaHeaders::MapFile;
+using KalaHeaders::GetRangeByValue;
+using KalaHeaders::GetRangeByValues;
+
+using std::string;
+using std::vector;
+using std::ofstream;
+using std::min;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::filesystem::path;
+using std::filesystem::exists;
+using std::filesystem::file_size;
+using std::filesystem::temp_directory_path;
+
+constexpr size_t GENERATED_BYTES = 256ULL * 1024 * 1024;
+
+//every measurement keeps the fastest of this many runs, the first one also warms the page cache
+constexpr int RUN_COUNT = 3;
+
+template<typename F>
+static double BestMilliseconds(F&& run)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+static void GenerateLog(const path& target)
+{
+	const char* levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "INFO", "DEBUG", "ERROR" };
+
+	ofstream out(target, std::ios::binary);
+
+	size_t written{};
+	for (u64 i = 0; written < GENERATED_BYTES; ++i)
+	{
+		string line =
+			"2025-01-01 12:00:00 [" + string(levels[i % 8]) + "] worker " + std::to_string(i % 16)
+			+ (i % 53 == 0 ? " request timeout, retry scheduled" : " processed request ")
+			+ std::to_string(i) + "\n";
+
+		out << line;
+		written += line.size();
+	}
+}
+
+//non-overlapping matches from the front, the same ranges GetRangeByValue reports
+static vector<BinaryRange> SearchReference(
+	const MappedFile& file,
+	const string& pattern)
+{
+	vector<BinaryRange> ranges{};
+
+	const char* data = reinterpret_cast<const char*>(file.GetData());
+	const char* end = data + file.GetSize();
+
+	for (const char* it = data;;)
+	{
+		it = std::search(it, end, pattern.begin(), pattern.end());
+		if (it == end) break;
+
+		size_t start = static_cast<size_t>(it - data);
+		ranges.push_back({ start, start + pattern.size() });
+
+		it += pattern.size();
+	}
+
+	return ranges;
+}
+
+static bool IsSame(
+	const vector<BinaryRange>& a,
+	const vector<BinaryRange>& b)
+{
+	return a.size() == b.size()
+		&& std::equal(a.begin(), a.end(), b.begin(), [](const BinaryRange& x, const BinaryRange& y)
+			{
+				return x.start == y.start
+					&& x.end == y.end;
+			});
+}
+
+int main(int argc, char* argv[])
+{
+	path target = argc > 1
+		? path(argv[1])
+		: temp_directory_path() / "solin_search_bench.log";
+
+	if (argc <= 1
+		&& !exists(target))
+	{
+		std::printf("generating %s\n", target.string().c_str());
+		GenerateLog(target);
+	}
+
+	vector<string> patterns = argc > 2
+		? vector<string>(argv + 2, argv + argc)
+		: vector<string>{ "ERROR", "WARN", "timeout", "not in the file" };
+
+	uintmax_t bytes = file_size(target);
+	std::printf("%s: %.2f GB\n", target.string().c_str(), bytes / 1e9);
+
+	MappedFile file{};
+	string result = MapFile(target, file);
+	if (!result.empty())
+	{
+		std::printf("%s\n", result.c_str());
+		return 1;
+	}
+
+	bool isConsistent = true;
+
+	for (const string& pattern : patterns)
+	{
+		vector<BinaryRange> ranges{};
+
+		//matches are appended, so every run starts from an empty vector
+		double searchMs = BestMilliseconds([&]
+			{
+				ranges.clear();
+				GetRangeByValue(target, pattern, ranges);
+			});
+
+		vector<BinaryRange> reference{};
+		double referenceMs = BestMilliseconds([&] { reference = SearchReference(file, pattern); });
+
+		std::printf("\"%s\": %zu matches, GetRangeByValue %.1f ms, std::search %.1f ms\n",
+			pattern.c_str(),
+			ranges.size(),
+			searchMs,
+			referenceMs);
+
+		if (!IsSame(ranges, reference))
+		{
+			std::printf("  ranges differ from std::search!\n");
+			isConsistent = false;
+		}
+	}
+
+	if (patterns.size() > 1)
+	{
+		vector<BinaryRange> ranges{};
+		double multiMs = BestMilliseconds([&]
+			{
+				ranges.clear();
+				GetRangeByValues(target, patterns, ranges);
+			});
+
+		double separateMs = BestMilliseconds([&]
+			{
+				for (const string& pattern : patterns)
+				{
+					vector<BinaryRange> single{};
+					GetRangeByValue(target, pattern, single);
+				}
+			});
+
+		std::printf("%zu patterns: %zu matches, GetRangeByValues %.1f ms, one GetRangeByValue each %.1f ms\n",
+			patterns.size(),
+			ranges.size(),
+			multiMs,
+			separateMs);
+	}
+
+	return isConsistent ? 0 : 1;
+}
\ No newline at end of file
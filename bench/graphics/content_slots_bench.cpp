@@ -0,0 +1,156 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of tearing down registry content through ContentSlots against
+// Registry::RemoveContent per pointer, and of handle lookups against Registry::GetContent.
+// Header only, build with optimizations on.
+// Usage: content_slots_bench [content count], defaults to 20000 widgets
+// ===================================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+#include "KalaWindow/include/utils/registry.hpp"
+
+#include "graphics/content_slots.hpp"
+
+using KalaWindow::Utils::Registry;
+
+using Solin::Graphics::ContentSlots;
+using Solin::Graphics::ContentHandle;
+
+using std::vector;
+using std::make_unique;
+using std::min;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+//every measurement keeps the fastest of this many runs
+constexpr int RUN_COUNT = 3;
+
+//stands in for the KalaWindow widgets, only the ID accessors the registry and ContentSlots use
+struct BenchContent
+{
+	u32 id{};
+	u32 windowID{};
+
+	inline u32 GetID() const { return id; }
+	inline u32 GetWindowID() const { return windowID; }
+
+	static inline Registry<BenchContent> registry{};
+};
+
+//creates the content the way KalaWindow does and returns it in creation order
+static vector<BenchContent*> Populate(u32 count)
+{
+	vector<BenchContent*> content{};
+	content.reserve(count);
+
+	for (u32 i = 1; i <= count; ++i)
+	{
+		auto c = make_unique<BenchContent>();
+		c->id = i;
+		c->windowID = 1;
+
+		content.push_back(c.get());
+		BenchContent::registry.AddContent(i, std::move(c));
+	}
+
+	return content;
+}
+
+template<typename Setup, typename F>
+static double BestMilliseconds(
+	Setup&& setup,
+	F&& run)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		setup();
+
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	u32 count = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 20000;
+
+	bool isConsistent = true;
+
+	//
+	// TEARDOWN
+	//
+
+	vector<BenchContent*> content{};
+	vector<ContentHandle> handles{};
+
+	double registryMs = BestMilliseconds(
+		[&] { content = Populate(count); },
+		[&]
+		{
+			for (BenchContent* c : content) BenchContent::registry.RemoveContent(c);
+		});
+
+	isConsistent = isConsistent && BenchContent::registry.runtimeContent.empty();
+
+	double slotsMs = BestMilliseconds(
+		[&]
+		{
+			content = Populate(count);
+
+			handles.clear();
+			for (BenchContent* c : content) handles.push_back(ContentSlots<BenchContent>::Track(c));
+		},
+		[&] { ContentSlots<BenchContent>::Remove(handles); });
+
+	isConsistent = isConsistent
+		&& BenchContent::registry.runtimeContent.empty()
+		&& BenchContent::registry.createdContent.empty()
+		&& ContentSlots<BenchContent>::GetAll().empty()
+		&& !ContentSlots<BenchContent>::IsValid(handles.front());
+
+	//
+	// LOOKUP
+	//
+
+	content = Populate(count);
+	handles.clear();
+	for (BenchContent* c : content) handles.push_back(ContentSlots<BenchContent>::Track(c));
+
+	size_t checksum{};
+
+	double getContentMs = BestMilliseconds([] {}, [&]
+		{
+			for (u32 i = 1; i <= count; ++i) checksum += BenchContent::registry.GetContent(i)->windowID;
+		});
+
+	double handleMs = BestMilliseconds([] {}, [&]
+		{
+			for (ContentHandle handle : handles) checksum += ContentSlots<BenchContent>::Get(handle)->windowID;
+		});
+
+	std::printf("%u widgets (checksum %zu)\n", count, checksum);
+	std::printf("Registry::RemoveContent per widget %9.2f ms\n", registryMs);
+	std::printf("ContentSlots::Remove of all         %9.2f ms\n", slotsMs);
+	std::printf("Registry::GetContent of all         %9.2f ms\n", getContentMs);
+	std::printf("ContentSlots::Get of all            %9.2f ms\n", handleMs);
+
+	if (!isConsistent) std::printf("content was left behind after teardown!\n");
+
+	return isConsistent ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of the .kfont loaders: ImportKalaFont, MappedKalaFont::Open and ImportKalaFontFlat,
+// also checks that all three return the same glyph data. The font is then upgraded to a compressed
+// version 2 file to compare decoding every glyph up front against reading metrics only, which is what
+// TextFont::LoadFont does before meshes are decoded on first draw.
+// Build together with src/core/font_converter.cpp and src/core/profiler.cpp with optimizations on.
+// Usage: kfont_load_bench [kfont file], without a file a version 1 font with 10k glyphs
+// of 50 to 250 vertices is generated in the temp directory
+// ===================================================================================
+
+#include "core/profiler.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "KalaWindow/include/ui/import_kfont.hpp"
+
+#include "core/font_converter.hpp"
+
+using KalaFont::GlyphResult;
+using KalaFont::GlyphView;
+using KalaFont::MappedKalaFont;
+using KalaFont::FlatFontData;
+using KalaFont::ImportKalaFont;
+using KalaFont::ImportKalaFontFlat;
+
+using Solin::Core::FontConverter;
+
+using std::vector;
+using std::span;
+using std::mt19937;
+using std::min;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::filesystem::path;
+using std::filesystem::exists;
+using std::filesystem::temp_directory_path;
+
+constexpr u32 GENERATED_GLYPHS = 10000;
+
+//every measurement keeps the fastest of this many runs, the first one also warms the page cache
+constexpr int RUN_COUNT = 3;
+
+template<typename F>
+static double BestMilliseconds(F&& run)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+template<typename T>
+static void Put(
+	FILE* file,
+	const T& value)
+{
+	std::fwrite(&value, sizeof(T), 1, file);
+}
+
+//version 1 layout: KFNT, version, glyph count, then per glyph GLYF with index and 8 floats,
+//VERT with the float pair count and INDI with the index count, each followed by its data
+static void GenerateFont(const path& target)
+{
+	mt19937 rng(3);
+
+	FILE* file = std::fopen(target.string().c_str(), "wb");
+
+	std::fwrite("KFNT", 1, 4, file);
+	Put(file, u32{ 1 });
+	Put(file, GENERATED_GLYPHS);
+
+	for (u32 g = 0; g < GENERATED_GLYPHS; ++g)
+	{
+		std::fwrite("GLYF", 1, 4, file);
+		Put(file, g);
+		for (int i = 0; i < 8; ++i) Put(file, static_cast<f32>(rng() % 100) / 7.0f);
+
+		u32 vertexCount = 50 + rng() % 200;
+		std::fwrite("VERT", 1, 4, file);
+		Put(file, vertexCount);
+		for (u32 i = 0; i < vertexCount * 2; ++i) Put(file, static_cast<f32>(rng() % 1000) / 3.0f);
+
+		u32 indexCount = (vertexCount - 2) * 3;
+		std::fwrite("INDI", 1, 4, file);
+		Put(file, indexCount);
+		for (u32 i = 0; i < indexCount; ++i) Put(file, static_cast<u32>(rng() % vertexCount));
+	}
+
+	std::fclose(file);
+}
+
+static bool IsSameData(
+	const GlyphResult& glyph,
+	span<const f32> vertices,
+	span<const u32> indices)
+{
+	return glyph.vertices.size() == vertices.size()
+		&& glyph.indices.size() == indices.size()
+		&& std::memcmp(glyph.vertices.data(), vertices.data(), vertices.size_bytes()) == 0
+		&& std::memcmp(glyph.indices.data(), indices.data(), indices.size_bytes()) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	path target = argc > 1
+		? path(argv[1])
+		: temp_directory_path() / "solin_kfont_bench.kfont";
+
+	if (argc <= 1
+		&& !exists(target))
+	{
+		std::printf("generating %s\n", target.string().c_str());
+		GenerateFont(target);
+	}
+
+	vector<GlyphResult> imported{};
+	double importMs = BestMilliseconds([&]
+		{
+			imported.clear();
+			ImportKalaFont(target, imported);
+		});
+
+	MappedKalaFont mapped{};
+	double openMs = BestMilliseconds([&] { mapped.Open(target); });
+
+	FlatFontData flat{};
+	double flatMs = BestMilliseconds([&] { ImportKalaFontFlat(target, flat); });
+
+	std::printf("%s: %zu glyphs\n", target.string().c_str(), imported.size());
+	std::printf("ImportKalaFont       %8.1f ms\n", importMs);
+	std::printf("MappedKalaFont::Open %8.1f ms\n", openMs);
+	std::printf("ImportKalaFontFlat   %8.1f ms\n", flatMs);
+
+	//all three keep the glyphs in file order
+	u32 mismatchCount{};
+	if (mapped.GetGlyphCount() != imported.size()
+		|| flat.glyphs.size() != imported.size())
+	{
+		std::printf("glyph counts differ between the loaders!\n");
+		return 1;
+	}
+
+	for (u32 g = 0; g < mapped.GetGlyphCount(); ++g)
+	{
+		const GlyphResult& glyph = imported[g];
+
+		GlyphView view{};
+		if (!mapped.GetGlyph(g, view)
+			|| view.glyphIndex != glyph.glyphIndex
+			|| !IsSameData(glyph, view.vertices, view.indices))
+		{
+			++mismatchCount;
+			continue;
+		}
+
+		if (flat.glyphs[g].glyphIndex != glyph.glyphIndex
+			|| !IsSameData(glyph, flat.GetVertices(flat.glyphs[g]), flat.GetIndices(flat.glyphs[g])))
+		{
+			++mismatchCount;
+		}
+	}
+
+	if (mismatchCount != 0) std::printf("%u glyphs differ between the loaders!\n", mismatchCount);
+
+	//
+	// COMPRESSED VERSION 2
+	//
+
+	path compressedPath = temp_directory_path() / "solin_kfont_bench_v2.kfont";
+	if (!FontConverter::UpgradeKalaFont(target, compressedPath, path{}, true))
+	{
+		std::printf("failed to upgrade the font to version 2!\n");
+		return 1;
+	}
+
+	FlatFontData eager{};
+	double eagerMs = BestMilliseconds([&] { ImportKalaFontFlat(compressedPath, eager); });
+
+	//what TextFont::LoadFont reads, metrics and counts without decoding any mesh
+	MappedKalaFont lazy{};
+	size_t lazyFloats{};
+	double lazyMs = BestMilliseconds([&]
+		{
+			lazy.Open(compressedPath);
+
+			lazyFloats = 0;
+			for (u32 g = 0; g < lazy.GetGlyphCount(); ++g)
+			{
+				GlyphView view{};
+				u32 vertexFloats{};
+				u32 indexCount{};
+				lazy.GetGlyphInfo(g, view, vertexFloats, indexCount);
+
+				lazyFloats += vertexFloats;
+			}
+		});
+
+	//a screen of text uses around a hundred distinct glyphs
+	u32 drawnCount = min(100u, lazy.GetGlyphCount());
+
+	vector<f32> vertices{};
+	vector<u32> indices{};
+	double firstDrawMs = BestMilliseconds([&]
+		{
+			for (u32 g = 0; g < drawnCount; ++g)
+			{
+				GlyphView view{};
+				u32 vertexFloats{};
+				u32 indexCount{};
+				lazy.GetGlyphInfo(g, view, vertexFloats, indexCount);
+
+				vertices.resize(vertexFloats);
+				indices.resize(indexCount);
+				lazy.CopyGlyph(g, vertices, indices);
+			}
+		});
+
+	size_t eagerBytes = eager.vertices.size() * sizeof(f32) + eager.indices.size() * sizeof(u32);
+
+	std::printf("%s: compressed version 2, %zu vertex floats\n", compressedPath.string().c_str(), lazyFloats);
+	std::printf("ImportKalaFontFlat            %8.2f ms %8.1f MB decoded\n", eagerMs, eagerBytes / 1e6);
+	std::printf("Open and glyph metrics        %8.2f ms %8.1f MB decoded\n", lazyMs, 0.0);
+	std::printf("CopyGlyph of %3u drawn glyphs %8.2f ms\n", drawnCount, firstDrawMs);
+
+	//glyphs copied one at a time must match the eager arenas
+	u32 compressedMismatchCount{};
+	for (u32 g = 0; g < lazy.GetGlyphCount(); ++g)
+	{
+		const auto& flatGlyph = eager.glyphs[g];
+
+		vertices.resize(flatGlyph.vertexFloats);
+		indices.resize(flatGlyph.indexCount);
+
+		if (!lazy.CopyGlyph(g, vertices, indices)
+			|| std::memcmp(vertices.data(), eager.GetVertices(flatGlyph).data(), vertices.size() * sizeof(f32)) != 0
+			|| std::memcmp(indices.data(), eager.GetIndices(flatGlyph).data(), indices.size() * sizeof(u32)) != 0)
+		{
+			++compressedMismatchCount;
+		}
+	}
+
+	if (compressedMismatchCount != 0)
+	{
+		std::printf("%u compressed glyphs differ between CopyGlyph and ImportKalaFontFlat!\n", compressedMismatchCount);
+	}
+
+	return mismatchCount == 0
+		&& compressedMismatchCount == 0
+		? 0
+		: 1;
+}
\ No newline at end of file
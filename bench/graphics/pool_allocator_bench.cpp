@@ -0,0 +1,160 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of the per widget records RetainedScene::CollectDamage looks up and walks every frame,
+// stored in an unordered_map with the default allocator against one with PoolAllocator.
+// Records are made between other allocations of varying size, like widgets, strings and
+// transforms are in a running program. Header only, build with optimizations on.
+// Usage: pool_allocator_bench [widget count], defaults to 100000 widgets
+// ===================================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+
+#include "core/pool_allocator.hpp"
+
+using Solin::Core::PoolAllocator;
+
+using std::vector;
+using std::unordered_map;
+using std::hash;
+using std::equal_to;
+using std::pair;
+using std::allocator;
+using std::unique_ptr;
+using std::mt19937;
+using std::min;
+using std::shuffle;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+constexpr u32 FRAME_COUNT = 50;
+
+//every measurement keeps the fastest of this many runs
+constexpr int RUN_COUNT = 3;
+
+//same fields as the record in scene.cpp
+struct BenchRecord
+{
+	f32 pos[2]{};
+	f32 rot{};
+	f32 size[2]{};
+	f32 color[3]{};
+	f32 opacity{};
+	const void* texture{};
+	const void* shader{};
+	u32 fontID{};
+	bool canUpdate{};
+	u16 zOrder{};
+	f32 rect[4]{};
+	u64 lastSeenFrame{};
+};
+
+template<typename Alloc>
+using RecordMap = unordered_map<u32, BenchRecord, hash<u32>, equal_to<u32>, Alloc>;
+
+template<typename F>
+static double BestMilliseconds(F&& run)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+//fills the map with one record per widget, each followed by allocations that stay alive
+template<typename Map>
+static void Populate(
+	Map& records,
+	u32 count,
+	vector<unique_ptr<char[]>>& outOther)
+{
+	mt19937 rng(7);
+
+	for (u32 id = 1; id <= count; ++id)
+	{
+		records[id].zOrder = static_cast<u16>(id);
+
+		outOther.emplace_back(new char[32 + rng() % 480]);
+		outOther.emplace_back(new char[16 + rng() % 64]);
+	}
+}
+
+//the CollectDamage pattern: a lookup per widget in draw order, then a walk over every record
+template<typename Map>
+static double RunFrames(
+	Map& records,
+	const vector<u32>& drawOrder,
+	u64& checksum)
+{
+	u64 frame{};
+
+	return BestMilliseconds([&]
+		{
+			for (u32 f = 0; f < FRAME_COUNT; ++f)
+			{
+				++frame;
+
+				for (u32 id : drawOrder)
+				{
+					BenchRecord& record = records[id];
+					checksum += record.zOrder;
+					record.lastSeenFrame = frame;
+				}
+
+				for (const auto& [id, record] : records)
+				{
+					if (record.lastSeenFrame != frame) ++checksum;
+				}
+			}
+		});
+}
+
+int main(int argc, char* argv[])
+{
+	u32 count = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 100000;
+
+	//widgets are drawn by z-order, which is not the order they were made in
+	vector<u32> drawOrder(count);
+	for (u32 i = 0; i < count; ++i) drawOrder[i] = i + 1;
+	shuffle(drawOrder.begin(), drawOrder.end(), mt19937(11));
+
+	u64 checksum{};
+
+	vector<unique_ptr<char[]>> heapOther{};
+	RecordMap<allocator<pair<const u32, BenchRecord>>> heapRecords{};
+	Populate(heapRecords, count, heapOther);
+	double heapMs = RunFrames(heapRecords, drawOrder, checksum);
+
+	vector<unique_ptr<char[]>> pooledOther{};
+	RecordMap<PoolAllocator<pair<const u32, BenchRecord>>> pooledRecords{};
+	Populate(pooledRecords, count, pooledOther);
+	double pooledMs = RunFrames(pooledRecords, drawOrder, checksum);
+
+	double widgetFrames = static_cast<double>(count) * FRAME_COUNT;
+
+	std::printf("%u widgets, %u frames (checksum %llu)\n",
+		count,
+		FRAME_COUNT,
+		static_cast<unsigned long long>(checksum));
+	std::printf("default allocator %8.1f ms %6.2f ns/widget\n", heapMs, heapMs * 1e6 / widgetFrames);
+	std::printf("PoolAllocator     %8.1f ms %6.2f ns/widget\n", pooledMs, pooledMs * 1e6 / widgetFrames);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Benchmark of WindowContent against Registry::GetAllWindowContent, counts the heap
+// allocations and the time of the per-window lookups one frame of Render::Update does.
+// Header only, build with optimizations on.
+// Usage: window_content_bench [windows [widgets per window]], defaults to 4 windows of 2000 widgets
+// ===================================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+#include "KalaWindow/include/utils/registry.hpp"
+
+#include "graphics/window_content.hpp"
+
+using KalaWindow::Utils::Registry;
+
+using Solin::Graphics::WindowContent;
+
+using std::vector;
+using std::span;
+using std::make_unique;
+using std::min;
+using std::atomic;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+constexpr u32 FRAME_COUNT = 1000;
+
+//Render::Update looks up contexts, inputs, images and text of every window
+constexpr u32 LOOKUPS_PER_WINDOW = 4;
+
+//every measurement keeps the fastest of this many runs
+constexpr int RUN_COUNT = 3;
+
+static atomic<u64> allocationCount{};
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+
+	void* p = std::malloc(size != 0 ? size : 1);
+	if (!p) throw std::bad_alloc();
+
+	return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+//stands in for the KalaWindow widgets, only the ID accessors the registry and WindowContent use
+struct BenchContent
+{
+	u32 id{};
+	u32 windowID{};
+
+	inline u32 GetID() const { return id; }
+	inline u32 GetWindowID() const { return windowID; }
+
+	static inline Registry<BenchContent> registry{};
+};
+
+template<typename F>
+static double BestMilliseconds(
+	F&& run,
+	u64& outAllocations)
+{
+	double best{};
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		u64 allocationsBefore = allocationCount.load();
+		auto start = steady_clock::now();
+		run();
+		double ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+		outAllocations = allocationCount.load() - allocationsBefore;
+		best = i == 0 ? ms : min(best, ms);
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	u32 windowCount = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 4;
+	u32 perWindow = argc > 2 ? static_cast<u32>(std::atoi(argv[2])) : 2000;
+
+	//content is created interleaved between windows, like widgets added over a session
+	u32 nextID = 1;
+	for (u32 i = 0; i < perWindow; ++i)
+	{
+		for (u32 w = 1; w <= windowCount; ++w)
+		{
+			auto content = make_unique<BenchContent>();
+			content->id = nextID;
+			content->windowID = w;
+
+			BenchContent::registry.AddContent(nextID++, std::move(content));
+		}
+	}
+
+	size_t checksum{};
+
+	u64 registryAllocations{};
+	double registryMs = BestMilliseconds([&]
+		{
+			for (u32 f = 0; f < FRAME_COUNT; ++f)
+			{
+				for (u32 w = 1; w <= windowCount; ++w)
+				{
+					for (u32 l = 0; l < LOOKUPS_PER_WINDOW; ++l)
+					{
+						vector<BenchContent*> content = BenchContent::registry.GetAllWindowContent(w);
+						checksum += content.size();
+					}
+				}
+			}
+		}, registryAllocations);
+
+	//the first regroup allocates the per-window vectors, every frame after it reuses them
+	WindowContent<BenchContent>::Get(1);
+
+	u64 groupedAllocations{};
+	double groupedMs = BestMilliseconds([&]
+		{
+			for (u32 f = 0; f < FRAME_COUNT; ++f)
+			{
+				//Render::Update invalidates before and after the window pump
+				WindowContent<BenchContent>::Invalidate();
+				WindowContent<BenchContent>::Invalidate();
+
+				for (u32 w = 1; w <= windowCount; ++w)
+				{
+					for (u32 l = 0; l < LOOKUPS_PER_WINDOW; ++l)
+					{
+						span<BenchContent* const> content = WindowContent<BenchContent>::Get(w);
+						checksum += content.size();
+					}
+				}
+			}
+		}, groupedAllocations);
+
+	std::printf("%u windows, %u widgets each, %u frames (checksum %zu)\n",
+		windowCount,
+		perWindow,
+		FRAME_COUNT,
+		checksum);
+	std::printf("GetAllWindowContent %8.1f ms %8.3f ms/frame %6.1f allocations/frame\n",
+		registryMs,
+		registryMs / FRAME_COUNT,
+		static_cast<double>(registryAllocations) / FRAME_COUNT);
+	std::printf("WindowContent::Get  %8.1f ms %8.3f ms/frame %6.1f allocations/frame\n",
+		groupedMs,
+		groupedMs / FRAME_COUNT,
+		static_cast<double>(groupedAllocations) / FRAME_COUNT);
+
+	return groupedAllocations == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Core
+{
+	using std::string;
+	using std::vector;
+	using std::function;
+	using std::filesystem::path;
+
+	struct WalkEntry
+	{
+		path entryPath{};
+		u64 size{}; //only filled for files when WalkOptions::readSizes is true
+		bool isDirectory{};
+	};
+
+	struct WalkOptions
+	{
+		//Skips entries matched by .gitignore files, .git/info/exclude and the .git directory itself
+		bool useGitignore = true;
+
+		//Extra patterns in .gitignore syntax relative to the root, checked after every ignore file
+		//like core.excludesFile, so a negation in an ignore file can bring an excluded entry back
+		vector<string> excludeGlobs{};
+
+		//Costs one stat per file, without it entry types come from the directory listing alone
+		bool readSizes{};
+
+		//0 uses one thread per core
+		u32 threadCount{};
+
+		//Entries handed to the callback at once
+		size_t batchSize = 512;
+	};
+
+	struct WalkStats
+	{
+		u64 fileCount{};
+		u64 directoryCount{};
+		u64 ignoredCount{};
+		u64 totalBytes{};    //sum of file sizes if they were read
+		u32 unreadableCount{}; //directories that could not be opened, they are skipped
+	};
+
+	//Receives entries in batches from the walker threads, never from two threads at once.
+	//Entries are in no particular order, the batch may be moved from
+	using WalkBatchCallback = function<void(vector<WalkEntry>& batch)>;
+
+	//Lists a directory tree on several threads that steal directories from each other.
+	//Symlinks are listed but never followed
+	class DirectoryWalker
+	{
+	public:
+		//Blocks until the whole tree was visited, run it through FileIO::Submit to keep the main thread free.
+		//Returns false if 'root' is not a readable directory
+		static bool Walk(
+			const path& root,
+			const WalkOptions& options,
+			const WalkBatchCallback& onBatch,
+			WalkStats* outStats = nullptr);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Core
+{
+	using std::string;
+	using std::vector;
+	using std::function;
+	using std::filesystem::path;
+
+	enum class FileIOKind : u8
+	{
+		KIND_READ,
+		KIND_WRITE,
+		KIND_TASK, //any blocking call passed to FileIO::Submit
+		KIND_COUNT
+	};
+
+	//Outcome of a finished request, handed to its callback on the main thread
+	struct FileIOResult
+	{
+		u32 requestID{};
+		FileIOKind kind{};
+		string error{};    //empty on success
+		vector<u8> data{}; //whole file contents of a read
+	};
+
+	//Submit to completion times in power of two microsecond buckets,
+	//bucket i counts requests that finished in under 2^(i+1) microseconds
+	struct LatencyHistogram
+	{
+		static constexpr size_t BUCKET_COUNT = 32;
+
+		u64 buckets[BUCKET_COUNT]{};
+		u64 count{};
+		f64 maxMicroseconds{};
+
+		void Add(f64 microseconds);
+
+		//Upper bound in microseconds of the bucket holding the given percentile (0 - 100), 0 if empty
+		f64 GetPercentile(f64 percentile) const;
+	};
+
+	struct FileIOStats
+	{
+		LatencyHistogram latency[static_cast<size_t>(FileIOKind::KIND_COUNT)]{};
+
+		u32 pendingCount{};    //submitted but not yet delivered
+		bool isUringActive{};  //reads and writes go through io_uring instead of the worker threads
+	};
+
+	using FileIOCallback = function<void(FileIOResult& result)>;
+
+	//Runs file work off the main thread so a large open or save never stalls a frame.
+	//Reads and writes use io_uring on Linux when the kernel supports it, worker threads otherwise.
+	//Callbacks are always called on the main thread from DeliverCompletions
+	class FileIO
+	{
+	public:
+		//'threadCount' 0 starts 4 worker threads
+		static void Initialize(u32 threadCount = 0);
+
+		//Reads the whole target file, returns the request ID, 0 if it failed
+		static u32 Read(
+			const path& target,
+			const FileIOCallback& onComplete);
+
+		//Replaces the contents of the target file or creates it, returns the request ID, 0 if it failed.
+		//The data is written to a temporary file in the same directory and renamed over the target,
+		//so a failed save leaves the previous contents in place
+		static u32 Write(
+			const path& target,
+			vector<u8>&& data,
+			const FileIOCallback& onComplete);
+
+		//Runs 'job' on a worker thread, meant for blocking calls such as the KalaHeaders file functions.
+		//The string it returns becomes the error of the result. Returns the request ID, 0 if it failed
+		static u32 Submit(
+			const function<string()>& job,
+			const FileIOCallback& onComplete);
+
+		//Calls the callbacks of all finished requests, called once per wakeup on the main thread
+		static void DeliverCompletions();
+
+		static inline const FileIOStats& GetStats() { return stats; }
+
+		//Waits for requests that were already submitted, their callbacks are not called anymore
+		static void Shutdown();
+	private:
+		static inline FileIOStats stats{};
+	};
+}
\ No newline at end of file
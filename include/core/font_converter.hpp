@@ -0,0 +1,35 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <filesystem>
+
+namespace Solin::Core
+{
+	using std::filesystem::path;
+
+	class FontConverter
+	{
+	public:
+		//Rewrites a version 1 or 2 .kfont file as version 2 with a glyph table sorted by
+		//glyph index. 'codepointMapPath' is an optional text file with one
+		//'codepoint glyphIndex' pair per line, decimal or 0x prefixed hex,
+		//version 1 files carry no codepoints so without it the codepoint table stays empty.
+		//Glyphs are stored compressed when that makes them smaller and 'compress' is true
+		static bool UpgradeKalaFont(
+			const path& inPath,
+			const path& outPath,
+			const path& codepointMapPath = {},
+			bool compress = true);
+
+		//Handles '--upgrade-kfont <in> <out> [codepoint map]',
+		//returns true if the arguments asked for a conversion so the program should exit
+		static bool RunFromArguments(
+			int argc,
+			char* argv[],
+			int& outExitCode);
+	};
+}
\ No newline at end of file
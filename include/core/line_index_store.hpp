@@ -0,0 +1,48 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <filesystem>
+
+#include "KalaHeaders/file_utils.hpp"
+
+namespace Solin::Core
+{
+	using std::filesystem::path;
+
+	using KalaHeaders::LineIndex;
+
+	struct LineIndexStoreStats
+	{
+		u32 reusedCount{};   //sidecar matched the file as is
+		u32 extendedCount{}; //file was appended to, only the new bytes were scanned
+		u32 rebuiltCount{};  //no usable sidecar, the whole file was scanned
+		u64 scannedBytes{};
+	};
+
+	//Keeps the line starts of text files in delta encoded sidecar files keyed by file size,
+	//write time and a sampled content hash, so reopening a large file does not scan it again
+	class LineIndexStore
+	{
+	public:
+		//Indexes 'filePath' into 'outIndex' using its sidecar in 'cacheDir' when it still matches,
+		//a new sidecar is written on a background thread whenever the file had to be scanned.
+		//An empty 'cacheDir' always scans the whole file.
+		//The index maps the file, call LineIndex::IsTruncated before reading lines
+		//of a file that may be truncated while it is open and reopen it if that returns true
+		static bool Open(
+			const path& filePath,
+			const path& cacheDir,
+			LineIndex& outIndex);
+
+		//Waits for sidecars that are still being written, called on shutdown
+		static void Flush();
+
+		static inline const LineIndexStoreStats& GetStats() { return stats; }
+	private:
+		static inline LineIndexStoreStats stats{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Core
+{
+	using std::allocator;
+	using std::true_type;
+
+	//Allocator for node based containers that hands out single objects from chunks of
+	//CHUNK_SIZE neighbouring blocks, so nodes made one after another sit next to each other
+	//instead of wherever the heap put them. Freed blocks are reused before a new chunk is made
+	//and keep their address until then. Arrays such as bucket tables go to the heap as usual.
+	//Every T shares one pool, chunks are never returned and the pool is not thread safe,
+	//so only use it for containers owned by the main thread
+	template<typename T>
+	class PoolAllocator
+	{
+	public:
+		using value_type = T;
+		using is_always_equal = true_type;
+
+		static constexpr size_t CHUNK_SIZE = 256;
+
+		PoolAllocator() = default;
+
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+		inline T* allocate(size_t count)
+		{
+			if (count != 1) return allocator<T>().allocate(count);
+
+			if (!freeBlocks) AddChunk();
+
+			Block* block = freeBlocks;
+			freeBlocks = block->next;
+
+			return reinterpret_cast<T*>(block->storage);
+		}
+
+		inline void deallocate(
+			T* ptr,
+			size_t count) noexcept
+		{
+			if (count != 1)
+			{
+				allocator<T>().deallocate(ptr, count);
+				return;
+			}
+
+			Block* block = reinterpret_cast<Block*>(ptr);
+			block->next = freeBlocks;
+			freeBlocks = block;
+		}
+
+		template<typename U>
+		inline bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+	private:
+		union Block
+		{
+			Block* next;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		//chunks live until the process exits, so containers destroyed
+		//during static destruction can still hand their nodes back
+		static inline void AddChunk()
+		{
+			Block* chunk = new Block[CHUNK_SIZE];
+
+			//linked back to front so blocks are handed out in address order
+			for (size_t i = CHUNK_SIZE; i > 0; --i)
+			{
+				chunk[i - 1].next = freeBlocks;
+				freeBlocks = &chunk[i - 1];
+			}
+		}
+
+		static inline Block* freeBlocks{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <atomic>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+//Times the rest of the current scope, name must be a string literal
+#define PROFILE_ZONE(name) Solin::Core::ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+namespace Solin::Core
+{
+	using std::string;
+	using std::filesystem::path;
+	using std::atomic;
+
+	enum class ProfileEventType : u8
+	{
+		EVENT_ZONE,    //timed scope
+		EVENT_COUNTER, //single value sampled at a point in time
+		EVENT_FRAME    //end of a frame
+	};
+
+	struct ProfileEvent
+	{
+		//always points to a string literal, never owned
+		const char* name{};
+
+		u64 startNS{};
+		u64 durationNS{};
+		f64 value{};
+
+		ProfileEventType type{};
+	};
+
+	//Rolling frame time percentiles over the last FRAME_SAMPLE_COUNT rendered frames
+	struct FrameStats
+	{
+		f64 p50{}; //milliseconds of work per frame
+		f64 p95{};
+		f64 p99{};
+
+		//last value of KalaWindowCore::GetFrameTime,
+		//includes the time spent idle between frames
+		f64 frameTime{};
+
+		u32 sampleCount{};
+	};
+
+	class Profiler
+	{
+	public:
+		//Zones, counters and frames are not recorded while disabled
+		static inline void SetEnabledState(bool newState) { isEnabled.store(newState, std::memory_order_relaxed); }
+		static inline bool IsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+
+		//Monotonic time in nanoseconds since the profiler was first used
+		static u64 GetTimeNS();
+
+		//Called by ProfileZone and the KalaHeaders::ProfileHook zones,
+		//prefer PROFILE_ZONE over calling this directly
+		static void RecordZone(
+			const char* name,
+			u64 startNS,
+			u64 endNS);
+
+		//Records the current value of a named counter, name must be a string literal
+		static void RecordCounter(
+			const char* name,
+			f64 value);
+
+		//Marks the start of the work of a new frame
+		static void BeginFrame();
+		//Marks the end of the work of the current frame and adds it to the frame stats
+		static void EndFrame();
+
+		static FrameStats GetFrameStats();
+
+		//Writes everything currently held by the ring buffers of all threads
+		//as Chrome trace event JSON, can be opened in Perfetto or chrome://tracing.
+		//Returns an empty string on success, otherwise the error
+		static string WriteChromeTrace(const path& target);
+	private:
+		static inline atomic<bool> isEnabled{ true };
+	};
+
+	struct ProfileZone
+	{
+		inline explicit ProfileZone(const char* zoneName)
+		{
+			if (!Profiler::IsEnabled()) return;
+
+			name = zoneName;
+			startNS = Profiler::GetTimeNS();
+		}
+
+		inline ~ProfileZone()
+		{
+			if (name) Profiler::RecordZone(name, startNS, Profiler::GetTimeNS());
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+		const char* name{};
+		u64 startNS{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <functional>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Core
+{
+	using std::function;
+
+	enum class SchedulerMode
+	{
+		//Redraws every frame, frame rate is only limited by vsync
+		MODE_CONTINUOUS,
+
+		//Blocks until a window message, a due timer or a wake request arrives,
+		//frames are only redrawn if something marked them dirty
+		MODE_EVENT_DRIVEN
+	};
+
+	//Rolling stats of the last fully measured one second window
+	struct SchedulerStats
+	{
+		f64 wakeupsPerSecond{}; //how many times the loop woke up
+		f64 framesPerSecond{};  //how many wakeups actually redrew
+		f64 cpuPercent{};       //process CPU time relative to wall time, 100 is one full core
+		f64 idlePercent{};      //share of wall time spent blocked in WaitForEvents
+
+		u64 totalWakeups{};
+		u64 totalFrames{};
+	};
+
+	class FrameScheduler
+	{
+	public:
+		static void Initialize(SchedulerMode newMode = SchedulerMode::MODE_EVENT_DRIVEN);
+
+		static inline void SetMode(SchedulerMode newMode) { mode = newMode; }
+		static inline SchedulerMode GetMode() { return mode; }
+
+		//Blocks the calling thread until there is something to do,
+		//returns immediately in continuous mode or if a redraw is already pending.
+		//Must only be called from the main thread
+		static void WaitForEvents();
+
+		//Runs the callbacks of all timers that are due,
+		//called once per wakeup after WaitForEvents
+		static void RunDueTimers();
+
+		//Marks the next frame as dirty and wakes the main loop, safe to call from any thread
+		static void RequestRedraw();
+
+		//Wakes the main loop without requesting a redraw, safe to call from any thread.
+		//Use this when a background job finished and its result must be handled on the main thread
+		static void Wake();
+
+		//Returns true once per requested redraw and clears the request,
+		//always returns true in continuous mode
+		static bool ConsumeRedraw();
+
+		//Adds a new timer that calls 'callback' after 'intervalSeconds' on the main thread,
+		//repeats until removed if 'isRepeating' is true. Returns the timer ID, 0 if it failed
+		static u32 AddTimer(
+			f64 intervalSeconds,
+			const function<void()>& callback,
+			bool isRepeating = true);
+		static void RemoveTimer(u32 timerID);
+
+		//Should be called once at the end of every wakeup so the stats stay accurate
+		static void EndFrame(bool didRedraw);
+
+		static inline const SchedulerStats& GetStats() { return stats; }
+
+		//Prints the scheduler stats once per second if true
+		static inline void SetStatsLoggingState(bool newState) { isStatsLoggingEnabled = newState; }
+		static inline bool IsStatsLoggingEnabled() { return isStatsLoggingEnabled; }
+
+		static void Shutdown();
+	private:
+		static inline SchedulerMode mode{};
+		static inline SchedulerStats stats{};
+		static inline bool isStatsLoggingEnabled{};
+	};
+}
\ No newline at end of file
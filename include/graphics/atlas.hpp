@@ -0,0 +1,161 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/ui/widget.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::string;
+
+	using KalaHeaders::vec2;
+
+	using KalaWindow::UI::Widget;
+
+	//Pixel rectangle inside an atlas page, origin at the top-left
+	struct AtlasRect
+	{
+		u32 x{};
+		u32 y{};
+		u32 width{};
+		u32 height{};
+	};
+
+	//Bottom-left skyline packer with reuse of evicted rects.
+	//Does not touch OpenGL so it can run headless
+	class SkylinePacker
+	{
+	public:
+		void Initialize(
+			u32 newWidth,
+			u32 newHeight);
+
+		//Finds room for a width x height rect, returns false if the page is full.
+		//Evicted rects are tried first, then the skyline
+		bool Insert(
+			u32 width,
+			u32 height,
+			AtlasRect& outRect);
+
+		//Returns the rect to the packer so later inserts can reuse it,
+		//merged with every evicted rect it shares a whole edge with
+		void Free(const AtlasRect& rect);
+
+		//Share of the page covered by live rects
+		f32 GetOccupancy() const;
+
+		//Share of the free area that is stuck in evicted holes
+		//instead of the open space above the skyline
+		f32 GetFragmentation() const;
+
+		inline u32 GetWidth() const { return width; }
+		inline u32 GetHeight() const { return height; }
+		inline u64 GetUsedArea() const { return usedArea; }
+	private:
+		struct SkylineNode
+		{
+			u32 x{};
+			u32 y{};
+			u32 width{};
+		};
+
+		//Returns true if the rect fits when its left edge starts at skyline node 'index',
+		//'outY' is the lowest y it can sit at there
+		bool FitsAt(
+			size_t index,
+			u32 rectWidth,
+			u32 rectHeight,
+			u32& outY) const;
+
+		void AddSkylineLevel(
+			size_t index,
+			const AtlasRect& rect);
+
+		u32 width{};
+		u32 height{};
+		u64 usedArea{};
+
+		vector<SkylineNode> skyline{};
+		vector<AtlasRect> freeRects{};
+	};
+
+	//UV sub-rectangle of an atlas page handed to widgets instead of a texture
+	struct AtlasRegion
+	{
+		u32 ID{};
+
+		//OpenGL name of the page texture
+		u32 textureID{};
+		u32 page{};
+
+		vec2 uvMin{};
+		vec2 uvMax{};
+		vec2 size{}; //size in pixels
+
+		AtlasRect rect{};
+	};
+
+	struct AtlasStats
+	{
+		u32 pageCount{};
+		u32 regionCount{};
+
+		f32 occupancy{};     //average over all pages
+		f32 fragmentation{}; //average over all pages
+	};
+
+	//Packs small RGBA8 images into shared page textures per window
+	//so widgets using them can be drawn in the same batch
+	class TextureAtlas
+	{
+	public:
+		static constexpr u32 PAGE_SIZE = 2048;
+		static constexpr u32 MAX_PAGES = 8;
+
+		//Images bigger than this on either side should stay standalone textures
+		static constexpr u32 MAX_IMAGE_SIZE = 256;
+
+		//Loads an image file and packs it, returns the region ID or 0 on failure
+		static u32 AddImage(
+			u32 windowID,
+			const string& path);
+
+		//Packs tightly packed RGBA8 pixels, returns the region ID or 0 on failure.
+		//Must be called with the window context current
+		static u32 AddPixels(
+			u32 windowID,
+			const u8* pixels,
+			u32 width,
+			u32 height);
+
+		//Frees the region so its space can be reused
+		static void RemoveRegion(u32 regionID);
+
+		static const AtlasRegion* GetRegion(u32 regionID);
+
+		//Widgets with a region are drawn from the atlas by the batch renderer,
+		//pass 0 to detach the widget again. Requests a redraw of the widget if its region changed
+		static void AssignRegion(
+			const Widget* widget,
+			u32 regionID);
+		static const AtlasRegion* GetWidgetRegion(const Widget* widget);
+
+		static AtlasStats GetStats(u32 windowID);
+
+		//Deletes all pages and regions of the window.
+		//Pass false for isContextAlive once the window and its context are already destroyed,
+		//the page textures went with the context and only the CPU side is dropped
+		static void RemoveWindow(
+			u32 windowID,
+			bool isContextAlive = true);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/graphics/opengl/opengl_shader.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::span;
+
+	using KalaHeaders::vec2;
+	using KalaHeaders::vec3;
+	using KalaHeaders::mat4;
+
+	using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+
+	//Per instance vertex data of one quad, uploaded as is
+	struct QuadInstance
+	{
+		vec2 pos{};    //combined center position
+		vec2 size{};   //combined size
+		vec2 rot{};    //cos and sin of the combined rotation
+		vec3 color{};  //normalized color
+		f32 opacity{};
+		vec2 uvMin = vec2(0.0f); //texture sub-rectangle, atlas regions use a part of their page
+		vec2 uvMax = vec2(1.0f);
+	};
+
+	//Consecutive instances that share a shader and texture, drawn with one call
+	struct QuadBatch
+	{
+		const OpenGL_Shader* shader{};
+		u32 textureID{}; //OpenGL texture name, 0 draws untextured
+
+		u32 firstInstance{};
+		u32 instanceCount{};
+	};
+
+	struct BatchStats
+	{
+		u32 quadCount{};
+		u32 batchCount{};
+		u32 drawCalls{};
+		u64 uploadedBytes{};
+	};
+
+	//Collects quads for one frame and merges them into batches sorted by
+	//Z order, shader and texture. Does not touch OpenGL so it can run headless
+	class QuadBatchBuilder
+	{
+	public:
+		void Clear();
+
+		void Add(
+			u16 zOrder,
+			const OpenGL_Shader* shader,
+			u32 textureID,
+			const QuadInstance& instance);
+
+		//Sorts the collected quads and merges neighbours with the same shader and texture,
+		//quads with equal keys keep the order they were added in
+		void Build();
+
+		inline span<const QuadInstance> GetInstances() const { return instances; }
+		inline span<const QuadBatch> GetBatches() const { return batches; }
+
+		inline size_t GetInstanceBytes() const { return instances.size() * sizeof(QuadInstance); }
+	private:
+		struct QuadEntry
+		{
+			u16 zOrder{};
+			const OpenGL_Shader* shader{};
+			u32 textureID{};
+			QuadInstance instance{};
+		};
+
+		vector<QuadEntry> entries{};
+		vector<u32> sortedIndices{};
+
+		vector<QuadInstance> instances{};
+		vector<QuadBatch> batches{};
+	};
+
+	//Draws the batches of a QuadBatchBuilder with one instanced call per batch
+	//from a streaming instance buffer that is kept alive per window
+	class BatchRenderer
+	{
+	public:
+		//Loads the instancing functions and creates the buffers and shader of the window,
+		//must be called with the window context current.
+		//Returns false if instancing is not supported, widgets then render one by one
+		static bool Initialize(u32 windowID);
+
+		static bool IsAvailable(u32 windowID);
+
+		//Uploads the instances once and issues one draw per batch,
+		//the shaders of the batches must be compatible with the stock quad shader
+		static void Draw(
+			u32 windowID,
+			const QuadBatchBuilder& builder,
+			const mat4& projection);
+
+		//Pass false for isContextAlive once the window and its context are already destroyed,
+		//the OpenGL objects went with the context and only the CPU side is dropped
+		static void RemoveWindow(
+			u32 windowID,
+			bool isContextAlive = true);
+
+		//Stats are accumulated until the next reset, reset once per frame
+		static inline void ResetStats() { stats = {}; }
+		static inline const BatchStats& GetStats() { return stats; }
+	private:
+		static inline BatchStats stats{};
+	};
+}
\ No newline at end of file
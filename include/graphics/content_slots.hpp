@@ -0,0 +1,155 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+#include <span>
+#include <algorithm>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "graphics/window_content.hpp"
+
+namespace Solin::Graphics
+{
+	using std::unordered_set;
+	using std::vector;
+	using std::span;
+	using std::remove_if;
+
+	//Handle to content tracked by ContentSlots, goes stale once the content is removed.
+	//Default handles are never valid
+	struct ContentHandle
+	{
+		u32 index{};
+		u32 generation{};
+	};
+
+	//Generational slot map over the content of a KalaWindow registry.
+	//The registry is shared with the prebuilt KalaWindow library and keeps its layout,
+	//so content created through it is tracked here for O(1) handle lookups and dense iteration.
+	//Removal goes through here as well and clears many handles with one pass over runtimeContent
+	//instead of the search per pointer and owner map walk of Registry::RemoveContent.
+	//Tracked content must not be removed from the registry any other way
+	template<typename T>
+	class ContentSlots
+	{
+	public:
+		//Starts tracking content that is already in the registry
+		static inline ContentHandle Track(T* content)
+		{
+			u32 index{};
+			if (!freeSlots.empty())
+			{
+				index = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else
+			{
+				index = static_cast<u32>(slots.size());
+				slots.push_back({});
+			}
+
+			Slot& slot = slots[index];
+			slot.denseIndex = static_cast<u32>(dense.size());
+
+			dense.push_back(content);
+			denseSlots.push_back(index);
+
+			return { index, slot.generation };
+		}
+
+		static inline bool IsValid(ContentHandle handle)
+		{
+			return handle.index < slots.size()
+				&& slots[handle.index].generation == handle.generation
+				&& slots[handle.index].denseIndex != NONE;
+		}
+
+		//Returns the content or nullptr if the handle is stale
+		static inline T* Get(ContentHandle handle)
+		{
+			return IsValid(handle)
+				? dense[slots[handle.index].denseIndex]
+				: nullptr;
+		}
+
+		//All tracked content, removals move the last entry into the freed place
+		static inline span<T* const> GetAll() { return dense; }
+
+		//Removes the content from the registry and makes its handles stale
+		static inline bool Remove(ContentHandle handle)
+		{
+			return Remove(span<const ContentHandle>(&handle, 1)) == 1;
+		}
+
+		//Removes the content of every valid handle from the registry with one pass over runtimeContent,
+		//stale and repeated handles are skipped. Returns how much content was removed
+		static inline size_t Remove(span<const ContentHandle> handles)
+		{
+			removing.clear();
+
+			for (ContentHandle handle : handles)
+			{
+				if (!IsValid(handle)) continue;
+
+				Slot& slot = slots[handle.index];
+				removing.insert(dense[slot.denseIndex]);
+
+				//the last entry fills the hole so iteration stays dense
+				u32 last = static_cast<u32>(dense.size() - 1);
+				dense[slot.denseIndex] = dense[last];
+				denseSlots[slot.denseIndex] = denseSlots[last];
+				slots[denseSlots[last]].denseIndex = slot.denseIndex;
+
+				dense.pop_back();
+				denseSlots.pop_back();
+
+				slot.denseIndex = NONE;
+				if (++slot.generation == 0) slot.generation = 1;
+
+				freeSlots.push_back(handle.index);
+			}
+
+			if (removing.empty()) return 0;
+
+			vector<T*>& runtimeContent = T::registry.runtimeContent;
+			runtimeContent.erase(
+				remove_if(runtimeContent.begin(), runtimeContent.end(),
+					[](T* c) { return removing.contains(c); }),
+				runtimeContent.end());
+
+			//owners are keyed by ID, so each is erased without walking the map
+			for (T* content : removing) T::registry.createdContent.erase(content->GetID());
+
+			size_t removedCount = removing.size();
+			removing.clear();
+
+			WindowContent<T>::Invalidate();
+
+			return removedCount;
+		}
+	private:
+		static constexpr u32 NONE = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			u32 denseIndex = NONE;
+			u32 generation = 1;
+		};
+
+		static inline vector<Slot> slots{};
+		static inline vector<u32> freeSlots{};
+
+		//content and the slot pointing at it, in the same order
+		static inline vector<T*> dense{};
+		static inline vector<u32> denseSlots{};
+
+		//reused between removals
+		static inline unordered_set<T*> removing{};
+	};
+}
\ No newline at end of file
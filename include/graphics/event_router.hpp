@@ -0,0 +1,214 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/core/input.hpp"
+#include "KalaWindow/include/ui/widget.hpp"
+
+namespace Solin::Graphics
+{
+	using std::string_view;
+	using std::decay_t;
+	using std::is_same_v;
+	using std::is_invocable_v;
+	using std::is_nothrow_move_constructible_v;
+	using std::forward;
+	using std::launder;
+	using std::max_align_t;
+
+	using KalaHeaders::vec2;
+
+	using KalaWindow::Core::Input;
+	using KalaWindow::Core::Key;
+	using KalaWindow::Core::MouseButton;
+	using KalaWindow::UI::Widget;
+
+	enum class RoutedEventType : u8
+	{
+		KEY_PRESSED,    //sent to the focused widget
+		KEY_RELEASED,   //sent to the focused widget
+		KEY_HELD,       //sent to the focused widget every frame the key is down
+		TEXT_TYPED,     //sent to the focused widget, 'text' holds the typed letter
+
+		MOUSE_PRESSED,  //sent to the capture owner, or the top widget under the cursor
+		MOUSE_RELEASED, //sent to the capture owner, or the top widget under the cursor
+		MOUSE_HELD,     //sent to the capture owner every frame the button is down
+		MOUSE_DRAGGED,  //sent to the capture owner when the cursor moved with the button down
+		MOUSE_SCROLLED, //sent to the capture owner, or the top widget under the cursor
+
+		MOUSE_ENTERED,  //cursor moved onto the widget
+		MOUSE_LEFT,     //cursor moved off the widget
+
+		FOCUS_GAINED,
+		FOCUS_LOST,
+
+		EVENT_COUNT
+	};
+
+	struct RoutedEvent
+	{
+		RoutedEventType type{};
+		Widget* target{};
+
+		Key key{};
+		MouseButton button{};
+
+		vec2 cursorPos{};   //widget space, bottom-left origin
+		vec2 cursorDelta{}; //movement since the last dispatch
+		f32 scrollDelta{};
+
+		string_view text{};
+	};
+
+	//Move-only callable with inline storage for one event handler.
+	//Captures must fit in CAPACITY bytes, which is checked at compile time,
+	//so storing or calling a handler never allocates
+	class EventHandler
+	{
+	public:
+		static constexpr size_t CAPACITY = 32;
+
+		EventHandler() = default;
+
+		template<typename F>
+			requires (!is_same_v<decay_t<F>, EventHandler>
+			&& is_invocable_v<decay_t<F>&, const RoutedEvent&>)
+		EventHandler(F&& func)
+		{
+			using Func = decay_t<F>;
+
+			static_assert(sizeof(Func) <= CAPACITY, "event handler captures do not fit the inline buffer");
+			static_assert(alignof(Func) <= alignof(max_align_t), "event handler captures are over-aligned");
+			static_assert(is_nothrow_move_constructible_v<Func>, "event handler captures must be nothrow movable");
+
+			new (storage) Func(forward<F>(func));
+
+			invoke = [](void* s, const RoutedEvent& e) { (*launder(static_cast<Func*>(s)))(e); };
+			manage = [](void* dst, void* src)
+				{
+					Func* f = launder(static_cast<Func*>(src));
+					if (dst) new (dst) Func(static_cast<Func&&>(*f));
+					f->~Func();
+				};
+		}
+
+		EventHandler(EventHandler&& other) noexcept { MoveFrom(other); }
+		EventHandler& operator=(EventHandler&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+
+		EventHandler(const EventHandler&) = delete;
+		EventHandler& operator=(const EventHandler&) = delete;
+
+		~EventHandler() { Reset(); }
+
+		inline void operator()(const RoutedEvent& e) { invoke(storage, e); }
+		inline explicit operator bool() const { return invoke != nullptr; }
+
+		inline void Reset()
+		{
+			if (manage) manage(nullptr, storage);
+
+			invoke = nullptr;
+			manage = nullptr;
+		}
+	private:
+		inline void MoveFrom(EventHandler& other)
+		{
+			if (!other.invoke) return;
+
+			other.manage(storage, other.storage);
+
+			invoke = other.invoke;
+			manage = other.manage;
+
+			other.invoke = nullptr;
+			other.manage = nullptr;
+		}
+
+		alignas(max_align_t) unsigned char storage[CAPACITY]{};
+
+		void (*invoke)(void*, const RoutedEvent&) {};
+		//moves the callable into 'dst' if it is not null, then destroys 'src'
+		void (*manage)(void* dst, void* src) {};
+	};
+
+	//Dispatch counts since the last reset, reset once per frame
+	struct RouterStats
+	{
+		u32 dispatchedEvents{}; //events that reached a handler
+		u32 keyEvents{};
+		u32 mouseEvents{};
+		u32 hitTests{};
+	};
+
+	//Sends input to the widgets that are actually involved instead of polling every widget:
+	//keyboard input goes to the focused widget, mouse input goes to the capture owner
+	//or the top widget under the cursor from the HitIndex
+	class EventRouter
+	{
+	public:
+		static void SetHandler(
+			Widget* widget,
+			RoutedEventType type,
+			EventHandler&& handler);
+		static void ClearHandler(
+			Widget* widget,
+			RoutedEventType type);
+		//Must be called before the widget is erased from its registry
+		static void ClearHandlers(Widget* widget);
+
+		//Sends FOCUS_LOST to the old widget and FOCUS_GAINED to the new one,
+		//pass nullptr to clear the focus
+		static void SetFocus(
+			u32 windowID,
+			Widget* widget);
+		static Widget* GetFocus(u32 windowID);
+
+		//All mouse events go to the capture owner until it is released,
+		//a pressed button captures the widget under the cursor until it is released
+		static void SetCapture(
+			u32 windowID,
+			Widget* widget);
+		static inline void ReleaseCapture(u32 windowID) { SetCapture(windowID, nullptr); }
+		static Widget* GetCapture(u32 windowID);
+
+		//Routes the input of this frame, must be called before the input frame ends.
+		//'cursorPos' is the cursor in widget space with a bottom-left origin.
+		//Returns true if any handler was called
+		static bool Dispatch(
+			u32 windowID,
+			Input* input,
+			vec2 cursorPos);
+
+		static void RemoveWindow(u32 windowID);
+
+		static inline void ResetStats() { stats = {}; }
+		static inline const RouterStats& GetStats() { return stats; }
+	private:
+		//Calls the handler of the widget for this event type if it has one
+		static bool Send(
+			RoutedEventType type,
+			u32 widgetID,
+			RoutedEvent& e);
+
+		static inline RouterStats stats{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/ui/widget.hpp"
+#include "KalaWindow/include/ui/image.hpp"
+#include "KalaWindow/include/ui/text.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::span;
+
+	using KalaHeaders::vec2;
+
+	using KalaWindow::UI::Widget;
+	using KalaWindow::UI::Image;
+	using KalaWindow::UI::Text;
+
+	//Uniform grid of widget AABBs per window for point and rect queries
+	//that only touch the widgets in the cells under the query.
+	//Widgets are only re-inserted when their AABB changed, and are kept by ID
+	//so queries between syncs never return a widget that was removed
+	class HitIndex
+	{
+	public:
+		//Pixel size of one grid cell
+		static constexpr f32 CELL_SIZE = 64.0f;
+
+		//Brings the grid of the window up to date with its widgets,
+		//rebuilds everything if the viewport size changed
+		static void Sync(
+			u32 windowID,
+			vec2 viewportSize,
+			span<Image* const> images,
+			span<Text* const> texts);
+
+		//Fills 'out' with all interactable widgets under the point sorted by highest Z first,
+		//same contract as Widget::HitWidgets
+		static void HitTest(
+			u32 windowID,
+			vec2 point,
+			vector<Widget*>& out);
+
+		//Returns the top-most interactable widget under the point or nullptr
+		static Widget* GetTopWidget(
+			u32 windowID,
+			vec2 point);
+
+		//Fills 'out' with all widgets whose AABB overlaps the rect, in no particular order
+		static void QueryRect(
+			u32 windowID,
+			vec2 min,
+			vec2 max,
+			vector<Widget*>& out);
+
+		static void RemoveWindow(u32 windowID);
+	};
+}
\ No newline at end of file
@@ -12,6 +12,7 @@ namespace Solin::Graphics
 	public:
 		static void Initialize();
 		
-		static void Update();
+		//Returns true if at least one window was redrawn
+		static bool Update();
 	};
 }
\ No newline at end of file
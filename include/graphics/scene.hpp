@@ -0,0 +1,110 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/ui/widget.hpp"
+#include "KalaWindow/include/ui/image.hpp"
+#include "KalaWindow/include/ui/text.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::span;
+
+	using KalaHeaders::vec2;
+
+	using KalaWindow::UI::Widget;
+	using KalaWindow::UI::Image;
+	using KalaWindow::UI::Text;
+
+	enum DirtyFlag : u8
+	{
+		DIRTY_NONE      = 0,
+		DIRTY_TRANSFORM = 1 << 0, //combined pos, rot or size changed
+		DIRTY_COLOR     = 1 << 1, //color or opacity changed
+		DIRTY_TEXTURE   = 1 << 2, //texture or shader was swapped
+		DIRTY_TEXT      = 1 << 3, //font or glyph geometry changed
+		DIRTY_ALL       = 0xF
+	};
+
+	//Screen space rectangle in framebuffer pixels, bottom-left origin
+	struct DamageRect
+	{
+		vec2 min{};
+		vec2 max{};
+	};
+
+	struct FrameDamage
+	{
+		//nothing changed, the frame can be skipped entirely
+		bool isEmpty = true;
+
+		//the whole framebuffer must be redrawn, rects are ignored
+		bool isFull{};
+
+		vector<DamageRect> rects{};
+	};
+
+	struct SceneCounters
+	{
+		u64 renderedFrames{}; //full redraws
+		u64 partialFrames{};  //redraws limited to damage rects
+		u64 skippedFrames{};  //frames where nothing was submitted or swapped
+
+		u64 renderedWidgets{};
+		u64 skippedWidgets{};
+	};
+
+	//Keeps the last submitted state of every widget per window
+	//so unchanged frames can be skipped and changed frames only redraw damaged regions
+	class RetainedScene
+	{
+	public:
+		//Flags changes that can not be detected by comparing widget state,
+		//such as new glyph geometry or texture contents
+		static void MarkDirty(
+			const Widget* widget,
+			u8 flags = DIRTY_ALL);
+
+		//Forces a full redraw of the window on its next frame
+		static void InvalidateWindow(u32 windowID);
+
+		//Drops all tracked state of the window
+		static void RemoveWindow(u32 windowID);
+
+		//Returns true if the viewport size or the widget count changed since the last frame,
+		//widget layout only needs to be refreshed when this is true
+		static bool UpdateLayout(
+			u32 windowID,
+			vec2 viewportSize,
+			size_t widgetCount);
+
+		//Compares the current widget state against the last submitted state
+		//and returns the regions of the window that changed since the last frame.
+		//Only valid on top of a retained copy of that frame, never on top of a swapped back buffer
+		static const FrameDamage& CollectDamage(
+			u32 windowID,
+			span<Image* const> images,
+			span<Text* const> texts);
+
+		//Returns true if the widget overlaps the damage rect
+		static bool IsDamaged(
+			Widget* widget,
+			const DamageRect& rect);
+
+		static void RecordFrame(const FrameDamage& damage);
+		static void RecordWidget(bool wasRendered);
+
+		static inline const SceneCounters& GetCounters() { return counters; }
+	private:
+		static inline SceneCounters counters{};
+	};
+}
\ No newline at end of file
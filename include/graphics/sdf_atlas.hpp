@@ -0,0 +1,85 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <filesystem>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/ui/import_kfont.hpp"
+
+#include "graphics/atlas.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::filesystem::path;
+
+	using KalaHeaders::vec2;
+
+	using KalaFont::FlatFontData;
+
+	//Placement of one glyph in an SDF atlas
+	struct SdfGlyph
+	{
+		//empty for glyphs without an outline
+		AtlasRect rect{};
+
+		//quad corners in em relative to the pen position on the baseline,
+		//they include the distance spread around the outline
+		vec2 planeMin{};
+		vec2 planeMax{};
+
+		vec2 uvMin{};
+		vec2 uvMax{};
+	};
+
+	//Single channel signed distance field of every glyph of a font.
+	//128 is the outline, higher values are inside and 'spread' pixels map to the full range.
+	//Row 0 of 'pixels' is the bottom of the atlas
+	struct SdfAtlasData
+	{
+		u64 fontHash{};
+		u32 pixelSize{}; //pixels per em
+		u32 spread{};
+
+		u32 width{};
+		u32 height{};
+
+		vector<u8> pixels{};
+		vector<SdfGlyph> glyphs{}; //indexed like FlatFontData::glyphs
+	};
+
+	//Generates SDF glyph atlases from the triangulated glyph meshes of a font.
+	//Does not touch OpenGL so it can run headless
+	class SdfAtlas
+	{
+	public:
+		static constexpr u32 DEFAULT_SPREAD = 4;
+
+		//Rasterizes all glyphs on 'threadCount' threads, 0 uses every hardware thread
+		static bool Build(
+			const FlatFontData& font,
+			u32 pixelSize,
+			u32 spread,
+			SdfAtlasData& outAtlas,
+			u32 threadCount = 0);
+
+		//Loads the atlas from 'cacheDir' if it holds one for the same font contents and sizes,
+		//otherwise builds it and writes it there. An empty 'cacheDir' always builds
+		static bool LoadOrBuild(
+			const path& fontPath,
+			const FlatFontData& font,
+			u32 pixelSize,
+			const path& cacheDir,
+			SdfAtlasData& outAtlas,
+			u32 spread = DEFAULT_SPREAD);
+
+		//FNV-1a hash of the file contents, 0 if it could not be read
+		static u64 HashFile(const path& filePath);
+	};
+}
\ No newline at end of file
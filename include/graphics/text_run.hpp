@@ -0,0 +1,262 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <limits>
+#include <filesystem>
+#include <memory>
+
+#include "KalaHeaders/math_utils.hpp"
+
+#include "KalaWindow/include/ui/import_kfont.hpp"
+
+#include "graphics/sdf_atlas.hpp"
+#include "graphics/text_style.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::string;
+	using std::string_view;
+	using std::span;
+	using std::numeric_limits;
+	using std::filesystem::path;
+	using std::shared_ptr;
+
+	using KalaHeaders::vec2;
+	using KalaHeaders::vec3;
+	using KalaHeaders::mat4;
+
+	using KalaFont::FlatFontData;
+
+	//Glyph meshes of .kfont files kept in flat arenas, so each window can upload
+	//all glyphs of a font once into a single vertex and index buffer.
+	//Does not touch OpenGL so it can run headless
+	class TextFont
+	{
+	public:
+		static constexpr u32 NONE = (numeric_limits<u32>::max)();
+
+		//Loads the font, returns the font ID or 0 on failure.
+		//Vertices are in em units with the baseline at y = 0
+		static u32 LoadFont(const path& fontPath);
+
+		//Runs using the font must be shut down first
+		static void UnloadFont(u32 fontID);
+
+		//Maps a codepoint to a font glyph index and lays out the runs of the font again.
+		//Version 1 files have no codepoint table, so their codepoints must be mapped by hand
+		static void MapCodepoint(
+			u32 fontID,
+			u32 codepoint,
+			u32 glyphIndex);
+
+		//Returns the glyph of the codepoint or NONE
+		static u32 FindGlyph(
+			u32 fontID,
+			u32 codepoint);
+
+		//Glyph metrics and codepoints of the font. The vertex and index arenas are empty,
+		//meshes are read from the mapped file when a window first draws them
+		static const FlatFontData* GetFontData(u32 fontID);
+
+		//Draws the runs of the font as textured quads from an SDF atlas instead of glyph meshes,
+		//so their cost no longer depends on outline complexity. 'pixelSize' is the em size
+		//the atlas is rasterized at, the atlas is cached in 'cacheDir' if it is not empty
+		static bool EnableSdf(
+			u32 fontID,
+			u32 pixelSize,
+			const path& cacheDir = {});
+		static const SdfAtlasData* GetSdfAtlas(u32 fontID);
+
+		//Advance of one column in em if every printable ASCII glyph of the font has the same advance,
+		//runs of such fonts are laid out on a column grid. 0 for proportional fonts
+		static f32 GetCellAdvance(u32 fontID);
+
+		//Advance of codepoints that have no glyph, such as space in most fonts, in em
+		static f32 GetFallbackAdvance(u32 fontID);
+	};
+
+	//Glyph placed by a run, 'penX' is in em from the start of the run
+	struct RunGlyph
+	{
+		u32 glyph{};
+		f32 penX{};
+	};
+
+	//Glyph placements of one laid out line, shared by every run showing the same text
+	struct LineLayout
+	{
+		vector<RunGlyph> glyphs{};
+		f32 advance{}; //in em
+	};
+
+	struct LayoutCacheStats
+	{
+		u64 hits{};
+		u64 misses{};
+		u64 evictions{}; //lines dropped for the memory budget
+
+		u32 entryCount{};
+		size_t usedBytes{};
+	};
+
+	//Laid out lines keyed by content hash, font and tab width, shared between runs.
+	//An edited line only misses for its new text, every other line stays cached
+	class LineLayoutCache
+	{
+	public:
+		static constexpr size_t DEFAULT_BUDGET = 8 * 1024 * 1024;
+
+		//Least recently used lines are dropped while the cache holds more than 'bytes',
+		//runs still showing a dropped line keep its layout alive
+		static void SetBudget(size_t bytes);
+		static size_t GetBudget();
+
+		//Drops every line of the font, called when its glyph mapping changes
+		static void InvalidateFont(u32 fontID);
+		static void Clear();
+
+		//Hits, misses and evictions are accumulated until the next reset
+		static void ResetCounters();
+		static const LayoutCacheStats& GetStats();
+	};
+
+	struct TextRunStats
+	{
+		u32 runCount{};
+		u32 glyphCount{};   //glyph instances drawn
+		u32 drawCalls{};
+		u64 uploadedBytes{};
+
+		//style uniforms shader_text would have set for the drawn glyphs,
+		//minus the uniforms the run shaders still set per frame
+		u64 uniformCallsAvoided{};
+	};
+
+	//One line of UTF-8 text laid out from glyph advances and drawn together with
+	//every other run of its window. Runs only hold glyph placements, the renderer
+	//draws each distinct glyph once for all of its occurrences
+	class TextRun
+	{
+	public:
+		//Spaces per tab, monospace fonts expand tabs to the next multiple of this column
+		static constexpr u32 TAB_WIDTH = 4;
+
+		TextRun() = default;
+		~TextRun()
+		{
+			Shutdown();
+			TextStyleTable::Release(styleIndex);
+		}
+
+		TextRun(const TextRun&) = delete;
+		TextRun& operator=(const TextRun&) = delete;
+
+		//'origin' is the left end of the baseline in framebuffer pixels with a bottom-left origin,
+		//'fontSize' is the size of one em in pixels
+		bool Initialize(
+			u32 windowID,
+			u32 fontID,
+			vec2 origin,
+			f32 fontSize);
+
+		void Shutdown();
+
+		//Line breaks are not handled, each line of text needs its own run
+		void SetText(string_view utf8);
+		inline const string& GetText() const { return text; }
+
+		void SetOrigin(vec2 newOrigin);
+		inline vec2 GetOrigin() const { return origin; }
+
+		void SetFontSize(f32 newFontSize);
+		inline f32 GetFontSize() const { return fontSize; }
+
+		//Color and opacity are part of the style, changing them interns a new style
+		//and releases the old one
+		void SetColor(vec3 newColor);
+		inline vec3 GetColor() const { return style.color; }
+
+		void SetOpacity(f32 newOpacity);
+		inline f32 GetOpacity() const { return style.opacity; }
+
+		void SetStyle(const TextStyle& newStyle);
+		inline const TextStyle& GetStyle() const { return style; }
+		inline u16 GetStyleIndex() const { return styleIndex; }
+
+		void SetVisible(bool newValue);
+		inline bool IsVisible() const { return isVisible; }
+
+		//Lays the text out again, called when the glyph mapping of the font changed
+		void Refresh();
+
+		inline u32 GetWindowID() const { return windowID; }
+		inline u32 GetFontID() const { return fontID; }
+
+		inline span<const RunGlyph> GetGlyphs() const
+		{
+			return layout
+				? span<const RunGlyph>(layout->glyphs)
+				: span<const RunGlyph>{};
+		}
+
+		//Width of the laid out text in pixels
+		inline f32 GetWidth() const { return layout ? layout->advance * fontSize : 0.0f; }
+	private:
+		void Layout();
+
+		u32 windowID{};
+		u32 fontID{};
+
+		string text{};
+		shared_ptr<const LineLayout> layout{};
+
+		vec2 origin{};
+		f32 fontSize = 16.0f;
+		TextStyle style{};
+		u16 styleIndex = TextStyleTable::DEFAULT_STYLE;
+
+		bool isVisible = true;
+	};
+
+	//Draws all runs of a window with one instanced call per distinct glyph.
+	//Glyph meshes are uploaded once per font into one vertex and index buffer
+	//and picked with base vertex offsets. Fonts with an SDF atlas are drawn
+	//with one instanced quad call and one texture bind per font instead.
+	//Instances carry a style index, the styles themselves live in one uniform buffer per window.
+	//Instances are only uploaded again after a run of the window changed
+	class TextRunRenderer
+	{
+	public:
+		//Loads the draw functions and creates the shader of the window,
+		//must be called with the window context current.
+		//Returns false if instanced base vertex drawing is not supported
+		static bool Initialize(u32 windowID);
+
+		static bool IsAvailable(u32 windowID);
+
+		static void Draw(
+			u32 windowID,
+			const mat4& projection);
+
+		//Pass false for isContextAlive once the window and its context are already destroyed,
+		//the OpenGL objects went with the context and only the CPU side is dropped
+		static void RemoveWindow(
+			u32 windowID,
+			bool isContextAlive = true);
+
+		//Stats are accumulated until the next reset, reset once per frame
+		static inline void ResetStats() { stats = {}; }
+		static inline const TextRunStats& GetStats() { return stats; }
+	private:
+		static inline TextRunStats stats{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::span;
+
+	using KalaHeaders::vec2;
+	using KalaHeaders::vec3;
+
+	//Look of a text run, the same effects shader_text sets as uniforms per draw.
+	//Lengths are in em, underline and stripes are measured from the pen position on the baseline.
+	//Shadow and glow need a distance field, so glyph meshes ignore them and only SDF fonts draw them
+	struct TextStyle
+	{
+		vec3 color = vec3(1.0f);
+		f32 opacity = 1.0f;
+
+		f32 italicSkew{};    //horizontal slant factor
+		f32 kerningOffset{}; //x adjustment of every glyph
+
+		bool underline{};
+		f32 underlineStrength = 1.0f;
+		f32 underlineThickness = 0.06f;
+		f32 underlineOffset = -0.12f;
+		vec3 underlineColor = vec3(1.0f);
+
+		bool striped{};
+		f32 stripeDarkness = 0.5f;
+		f32 stripeRepeat = 2.0f;
+		vec2 stripeSize = vec2(8.0f);
+
+		bool shadow{};
+		vec2 shadowOffset = vec2(0.04f, -0.04f);
+		vec3 shadowColor = vec3(0.0f);
+		f32 shadowOpacity = 0.5f;
+
+		bool glow{};
+		vec3 glowColor = vec3(1.0f);
+		f32 glowStrength = 0.5f;
+		f32 glowRadius = 0.1f;
+	};
+
+	//Interns text styles into one packed std140 array that each window uploads once
+	//into a uniform buffer, so glyph instances only carry a style index.
+	//Styles are reference counted and released slots are reused, so animating a color
+	//does not fill the table. Does not touch OpenGL so it can run headless
+	class TextStyleTable
+	{
+	public:
+		//Uniform buffers are only guaranteed to hold 16 KB
+		static constexpr u32 MAX_STYLES = 128;
+
+		//Packed vec4s per style, the layout the run shaders read
+		static constexpr u32 VEC4_PER_STYLE = 7;
+
+		//Style uniforms shader_text needs set before every glyph draw
+		static constexpr u32 UNIFORMS_PER_DRAW = 22;
+
+		//Index 0 is the default style
+		static constexpr u16 DEFAULT_STYLE = 0;
+
+		//Returns the index of an equal style, adding it if it is new, and holds one reference to it.
+		//Returns DEFAULT_STYLE once the table is full
+		static u16 Intern(const TextStyle& style);
+
+		//Drops one reference taken by Intern, the slot is reused once no reference is left
+		static void Release(u16 index);
+
+		static const TextStyle& GetStyle(u16 index);
+		static u32 GetStyleCount();
+
+		static span<const f32> GetPackedData();
+
+		//Bumped whenever a style is added or a slot is reused so renderers know to upload again
+		static u32 GetVersion();
+	};
+}
\ No newline at end of file
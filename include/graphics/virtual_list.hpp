@@ -0,0 +1,299 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <functional>
+#include <limits>
+
+#include "KalaHeaders/math_utils.hpp"
+#include "KalaHeaders/hierarchy_utils.hpp"
+
+#include "KalaWindow/include/ui/widget.hpp"
+#include "KalaWindow/include/ui/image.hpp"
+#include "KalaWindow/include/graphics/opengl/opengl_shader.hpp"
+
+#include "graphics/content_slots.hpp"
+
+namespace Solin::Graphics
+{
+	using std::vector;
+	using std::span;
+	using std::function;
+	using std::numeric_limits;
+
+	using KalaHeaders::vec2;
+	using KalaHeaders::FlatHierarchy;
+
+	using KalaWindow::UI::Widget;
+	using KalaWindow::UI::Image;
+	using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+
+	//Prefix sums of row heights in a Fenwick tree, so the offset of a row
+	//and the row under an offset are both found in O(log n).
+	//Sums are kept in doubles so a million rows do not drift
+	class HeightIndex
+	{
+	public:
+		//Replaces all rows with 'count' rows of the same height
+		void Assign(
+			u32 count,
+			f32 height);
+		//Replaces all rows with the given heights
+		void Assign(span<const f32> newHeights);
+
+		//Inserting and erasing rebuilds the tree in O(n)
+		void Insert(
+			u32 row,
+			u32 count,
+			f32 height);
+		void Erase(
+			u32 row,
+			u32 count);
+
+		void SetHeight(
+			u32 row,
+			f32 height);
+		inline f32 GetHeight(u32 row) const { return row < heights.size() ? heights[row] : 0.0f; }
+
+		//Returns the summed height of all rows above 'row'
+		f64 GetOffset(u32 row) const;
+
+		//Returns the row that covers 'offset', offsets past the end return the last row
+		u32 FindRow(f64 offset) const;
+
+		inline u32 GetCount() const { return static_cast<u32>(heights.size()); }
+		inline f64 GetTotalHeight() const { return totalHeight; }
+	private:
+		void Rebuild();
+
+		vector<f32> heights{};
+
+		//1-based, tree[i] holds the sum of the (i & -i) rows ending at row i - 1
+		vector<f64> tree{};
+
+		f64 totalHeight{};
+	};
+
+	struct VirtualListStats
+	{
+		u32 visibleRows{};
+		u32 boundRows{};    //rows handed to the binder in the last update
+		u32 recycledRows{}; //pooled widgets that switched to another row in the last update
+	};
+
+	//Called when a pooled widget starts showing a row,
+	//the binder sets the texture, color or atlas region of the widget for that row
+	using RowBinder = function<void(u32 row, Image* widget)>;
+
+	//Scrolling list that only keeps enough row widgets alive to fill its viewport.
+	//Widgets are recycled as rows scroll in and out, and positioned from a height index
+	//so variable height rows scroll at a cost that does not depend on the row count
+	class VirtualList
+	{
+	public:
+		static constexpr u32 NONE = (numeric_limits<u32>::max)();
+
+		//Creates the row pool, must be called with the window context current.
+		//'pos' is the top-left corner of the viewport in window pixels,
+		//rows are never shorter than 'minRowHeight' so the pool always covers the viewport
+		bool Initialize(
+			u32 windowID,
+			vec2 pos,
+			vec2 size,
+			f32 minRowHeight,
+			OpenGL_Shader* shader);
+
+		//Removes the pooled widgets from the image registry in one pass
+		void Shutdown();
+
+		//Grows the pool if the new viewport fits more rows,
+		//must be called with the window context current
+		void SetViewport(
+			vec2 pos,
+			vec2 size);
+		inline vec2 GetViewportPos() const { return viewportPos; }
+		inline vec2 GetViewportSize() const { return viewportSize; }
+
+		void SetRowCount(
+			u32 count,
+			f32 height);
+		//Replaces all rows, indents are optional and shift rows to the right
+		void SetRows(
+			span<const f32> heights,
+			span<const f32> indents = {});
+		void InsertRows(
+			u32 row,
+			u32 count,
+			f32 height);
+		void EraseRows(
+			u32 row,
+			u32 count);
+
+		void SetRowHeight(
+			u32 row,
+			f32 height);
+		inline f32 GetRowHeight(u32 row) const { return heightIndex.GetHeight(row); }
+
+		inline u32 GetRowCount() const { return heightIndex.GetCount(); }
+		inline f64 GetContentHeight() const { return heightIndex.GetTotalHeight(); }
+
+		inline void SetRowBinder(const RowBinder& newBinder)
+		{
+			binder = newBinder;
+			InvalidateAll();
+		}
+
+		//Rebinds the row on the next update if it is visible
+		void Invalidate(u32 row);
+		void InvalidateAll();
+
+		//Clamped so the last row never scrolls above the bottom of the viewport
+		void SetScroll(f64 offset);
+		inline void ScrollBy(f64 delta) { SetScroll(scroll + delta); }
+		//Scrolls the least amount needed to show the whole row
+		void ScrollToRow(u32 row);
+		inline f64 GetScroll() const { return scroll; }
+
+		//Returns the row under the point or NONE
+		u32 GetRowAt(vec2 point) const;
+
+		//Recycles and positions the pooled widgets for the current scroll,
+		//only rows that were not visible before are handed to the binder
+		void Update();
+
+		inline u32 GetFirstVisibleRow() const { return firstVisible; }
+		inline u32 GetVisibleRowCount() const { return visibleCount; }
+		inline u32 GetPoolSize() const { return static_cast<u32>(pool.size()); }
+
+		inline const VirtualListStats& GetStats() const { return stats; }
+
+		//Returns true if the widget belongs to the pool of any list,
+		//window layout must leave these widgets where their list put them
+		static bool IsPooledWidget(const Widget* widget);
+	private:
+		struct PooledRow
+		{
+			Image* widget{};
+			ContentHandle handle{};
+			u32 row = NONE;
+		};
+
+		void GrowPool();
+		void ClampScroll();
+
+		//flags the layout for the next update and requests a redraw so that update happens
+		void MarkLayoutDirty();
+
+		u32 windowID{};
+		OpenGL_Shader* shader{};
+
+		vec2 viewportPos{};
+		vec2 viewportSize{};
+		f32 minRowHeight = 1.0f;
+
+		HeightIndex heightIndex{};
+		vector<f32> indents{};
+
+		//row r is always shown by pool[r % pool.size()], visible rows never share a slot
+		vector<PooledRow> pool{};
+
+		RowBinder binder{};
+
+		f64 scroll{};
+		u32 firstVisible{};
+		u32 visibleCount{};
+
+		//rows or scroll changed since the last update and widgets must be moved
+		bool isLayoutDirty = true;
+
+		VirtualListStats stats{};
+	};
+
+	//Called when a pooled widget starts showing a tree node
+	using NodeBinder = function<void(
+		u32 node,
+		u32 depth,
+		bool isExpanded,
+		Image* widget)>;
+
+	//Collapsible tree on top of a VirtualList, only the rows of expanded
+	//branches exist in the list and each level is indented by 'indentWidth'
+	class VirtualTree
+	{
+	public:
+		static constexpr u32 NONE = FlatHierarchy<void>::NONE;
+
+		//Must be called with the window context current
+		bool Initialize(
+			u32 windowID,
+			vec2 pos,
+			vec2 size,
+			f32 minRowHeight,
+			f32 newIndentWidth,
+			OpenGL_Shader* shader);
+		void Shutdown();
+
+		//Adds a collapsed node as the last child of parent, or as a root if parent is NONE.
+		//Returns the node or NONE if the parent is invalid
+		u32 AddNode(
+			u32 parent = NONE,
+			f32 height = 0.0f);
+		//Removes the node and all of its descendants
+		bool RemoveNode(u32 node);
+		void Clear();
+
+		void SetExpanded(
+			u32 node,
+			bool newValue);
+		inline void Toggle(u32 node) { SetExpanded(node, !IsExpanded(node)); }
+		inline bool IsExpanded(u32 node) const { return node < expanded.size() && expanded[node]; }
+
+		inline void SetNodeBinder(const NodeBinder& newBinder)
+		{
+			binder = newBinder;
+			list.InvalidateAll();
+		}
+
+		//Rebinds the node on the next update if it is visible
+		void Invalidate(u32 node);
+
+		//Returns the node shown at the row or under the point, NONE if there is none
+		inline u32 GetNodeAtRow(u32 row) const { return row < rowNodes.size() ? rowNodes[row] : NONE; }
+		inline u32 GetNodeAt(vec2 point) const { return GetNodeAtRow(list.GetRowAt(point)); }
+
+		//Scrolls the least amount needed to show the node, expanding its ancestors
+		void ScrollToNode(u32 node);
+
+		//Rebuilds the visible rows if nodes were added, removed or toggled,
+		//then updates the list
+		void Update();
+
+		inline VirtualList& GetList() { return list; }
+	private:
+		void MarkRowsDirty();
+		void RebuildRows();
+
+		VirtualList list{};
+		FlatHierarchy<void> nodes{};
+
+		f32 defaultHeight{};
+		f32 indentWidth{};
+
+		//indexed by node
+		vector<f32> heights{};
+		vector<u8> expanded{};
+
+		//node shown at each list row, and the row of each node or NONE if hidden
+		vector<u32> rowNodes{};
+		vector<u32> nodeRows{};
+
+		NodeBinder binder{};
+
+		bool areRowsDirty = true;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/math_utils.hpp"
+
+namespace Solin::Graphics
+{
+	using std::unordered_map;
+	using std::vector;
+	using std::span;
+
+	//Content of a KalaWindow registry grouped by window ID.
+	//The registry itself is shared with the prebuilt KalaWindow library and keeps its layout,
+	//so instead of scanning and copying runtimeContent on every GetAllWindowContent call
+	//the content is grouped here once and handed out as spans
+	template<typename T>
+	class WindowContent
+	{
+	public:
+		//Regroups on the first lookup after Invalidate or after the registry size changed.
+		//The returned span stays valid until the next regroup
+		static inline span<T* const> Get(u32 windowID)
+		{
+			const vector<T*>& content = T::registry.runtimeContent;
+
+			if (isDirty
+				|| lastSize != content.size())
+			{
+				Rebuild(content);
+			}
+
+			auto it = byWindow.find(windowID);
+			return it != byWindow.end()
+				? span<T* const>(it->second)
+				: span<T* const>{};
+		}
+
+		//Forces a regroup on the next lookup, called before and after the window pump of every frame
+		//and after content was removed, since a removal followed by an addition keeps the size
+		static inline void Invalidate() { isDirty = true; }
+	private:
+		//Existing vectors are cleared instead of freed so their capacity is reused
+		//and steady state regroups never allocate
+		static inline void Rebuild(const vector<T*>& content)
+		{
+			for (auto& [windowID, windowContent] : byWindow) windowContent.clear();
+
+			for (T* c : content)
+			{
+				if (c) byWindow[c->GetWindowID()].push_back(c);
+			}
+
+			//drop windows that no longer own anything
+			for (auto it = byWindow.begin(); it != byWindow.end();)
+			{
+				if (it->second.empty()) it = byWindow.erase(it);
+				else ++it;
+			}
+
+			lastSize = content.size();
+			isDirty = false;
+		}
+
+		static inline unordered_map<u32, vector<T*>> byWindow{};
+		static inline size_t lastSize{};
+		static inline bool isDirty = true;
+	};
+}
\ No newline at end of file
@@ -7,12 +7,20 @@
 #include "KalaWindow/include/core/crash.hpp"
 
 #include "core/core_program.hpp"
+#include "core/scheduler.hpp"
+#include "core/profiler.hpp"
+#include "core/line_index_store.hpp"
+#include "core/file_io.hpp"
 #include "graphics/render.hpp"
 
 using KalaWindow::Core::KalaWindowCore;
 using KalaWindow::Core::CrashHandler;
 
 using Solin::Graphics::Render;
+using Solin::Core::FrameScheduler;
+using Solin::Core::Profiler;
+using Solin::Core::LineIndexStore;
+using Solin::Core::FileIO;
 
 namespace Solin::Core
 {
@@ -22,6 +30,8 @@ namespace Solin::Core
 			"Solin IDE",
 			Shutdown);
 		
+		FrameScheduler::Initialize();
+		FileIO::Initialize();
 		Render::Initialize();
 	}
 	
@@ -29,13 +39,30 @@ namespace Solin::Core
 	{
 		while (true)
 		{
+			//blocks here while idle until input, a timer or a redraw request arrives
+			FrameScheduler::WaitForEvents();
+
+			Profiler::BeginFrame();
+
 			KalaWindowCore::UpdateDeltaTime();
-			Render::Update();
+			FrameScheduler::RunDueTimers();
+			FileIO::DeliverCompletions();
+
+			bool didRedraw = Render::Update();
+
+			//idle wakeups that did not redraw would skew the frame time percentiles
+			if (didRedraw) Profiler::EndFrame();
+
+			FrameScheduler::EndFrame(didRedraw);
 		}
 	}
 	
 	void SolinCore::Shutdown()
 	{
-		
+		FileIO::Shutdown();
+
+		//sidecars still being written would be left half finished
+		LineIndexStore::Flush();
+		FrameScheduler::Shutdown();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,691 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <string_view>
+#include <algorithm>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "core/directory_walker.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+
+using Solin::Core::DirectoryWalker;
+using Solin::Core::WalkEntry;
+using Solin::Core::WalkOptions;
+using Solin::Core::WalkStats;
+using Solin::Core::WalkBatchCallback;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::deque;
+using std::shared_ptr;
+using std::make_shared;
+using std::unique_ptr;
+using std::make_unique;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::atomic;
+using std::ifstream;
+using std::getline;
+using std::max;
+using std::move;
+using std::error_code;
+using std::exception;
+using std::filesystem::path;
+using std::filesystem::is_directory;
+using std::filesystem::directory_iterator;
+using std::filesystem::directory_options;
+
+struct IgnoreRule
+{
+	string pattern{};
+	bool isNegated{};
+	bool isDirectoryOnly{};
+	bool isAnchored{}; //matched against the path below the rule's directory instead of the name only
+};
+
+//Rules of one ignore file, deeper levels point at the levels of their parent directories
+struct IgnoreLevel
+{
+	shared_ptr<const IgnoreLevel> parent{};
+	string base{}; //directory of the rules relative to the root, empty for the root
+	vector<IgnoreRule> rules{};
+};
+
+struct WalkDirectory
+{
+	string fullPath{};
+	string relativePath{}; //'/' separated, empty for the root
+	shared_ptr<const IgnoreLevel> ignore{};
+};
+
+struct RawEntry
+{
+	string name{};
+	bool isDirectory{};
+	u64 size{};
+};
+
+//each thread pops its own newest directory first and steals the oldest of the others,
+//so a thread stays deep in one subtree while stolen work covers whole other subtrees
+struct WorkQueue
+{
+	mutex queueMutex{};
+	deque<WalkDirectory> directories{};
+};
+
+struct WalkContext
+{
+	const WalkOptions* options{};
+	const WalkBatchCallback* onBatch{};
+
+	vector<unique_ptr<WorkQueue>> queues{};
+
+	//directories queued or being read, the walk is done when it reaches 0
+	atomic<u64> pendingCount{};
+
+	atomic<bool> isRootUnreadable{};
+
+	mutex batchMutex{};
+};
+
+static void RunWalker(
+	WalkContext& context,
+	size_t threadIndex,
+	WalkStats& outStats);
+static bool ReadDirectory(
+	const string& fullPath,
+	bool readSizes,
+	vector<RawEntry>& outEntries);
+static shared_ptr<const IgnoreLevel> LoadIgnoreFile(
+	const path& filePath,
+	const string& base,
+	shared_ptr<const IgnoreLevel> parent);
+static bool ParseIgnoreLine(
+	string_view line,
+	IgnoreRule& outRule);
+static bool IsIgnored(
+	const IgnoreLevel* level,
+	const string& relativePath,
+	string_view name,
+	bool isDirectory);
+static bool MatchGlob(
+	string_view pattern,
+	string_view text);
+
+namespace Solin::Core
+{
+	bool DirectoryWalker::Walk(
+		const path& root,
+		const WalkOptions& options,
+		const WalkBatchCallback& onBatch,
+		WalkStats* outStats)
+	{
+		PROFILE_ZONE("DirectoryWalker::Walk");
+
+		error_code ec{};
+		if (!is_directory(root, ec))
+		{
+			Log::Print(
+				"Cannot walk '" + root.string() + "' because it is not a directory!",
+				"DIRECTORY_WALKER",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		//user globs sit below every ignore file, like core.excludesFile does for git
+		auto rootIgnore = make_shared<IgnoreLevel>();
+		for (const string& glob : options.excludeGlobs)
+		{
+			IgnoreRule rule{};
+			if (ParseIgnoreLine(glob, rule)) rootIgnore->rules.push_back(move(rule));
+		}
+
+		shared_ptr<const IgnoreLevel> ignore = rootIgnore;
+		if (options.useGitignore) ignore = LoadIgnoreFile(root / ".git" / "info" / "exclude", "", ignore);
+
+		WalkContext context{};
+		context.options = &options;
+		context.onBatch = &onBatch;
+
+		size_t threadCount = options.threadCount != 0
+			? options.threadCount
+			: max(thread::hardware_concurrency(), 1u);
+
+		for (size_t i = 0; i < threadCount; ++i) context.queues.push_back(make_unique<WorkQueue>());
+
+		string rootPath = root.string();
+		while (rootPath.size() > 1
+			&& (rootPath.back() == '/' || rootPath.back() == '\\'))
+		{
+			rootPath.pop_back();
+		}
+
+		context.queues[0]->directories.push_back({ rootPath, "", ignore });
+		context.pendingCount = 1;
+
+		vector<WalkStats> threadStats(threadCount);
+		vector<thread> walkers{};
+		for (size_t i = 1; i < threadCount; ++i)
+		{
+			walkers.emplace_back(
+				RunWalker,
+				std::ref(context),
+				i,
+				std::ref(threadStats[i]));
+		}
+
+		RunWalker(context, 0, threadStats[0]);
+		for (thread& walker : walkers) walker.join();
+
+		if (outStats)
+		{
+			*outStats = {};
+			for (const WalkStats& s : threadStats)
+			{
+				outStats->fileCount += s.fileCount;
+				outStats->directoryCount += s.directoryCount;
+				outStats->ignoredCount += s.ignoredCount;
+				outStats->totalBytes += s.totalBytes;
+				outStats->unreadableCount += s.unreadableCount;
+			}
+		}
+
+		if (context.isRootUnreadable)
+		{
+			Log::Print(
+				"Cannot walk '" + root.string() + "' because it could not be opened!",
+				"DIRECTORY_WALKER",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		return true;
+	}
+}
+
+void RunWalker(
+	WalkContext& context,
+	size_t threadIndex,
+	WalkStats& outStats)
+{
+	PROFILE_ZONE("DirectoryWalker::RunWalker");
+
+	const WalkOptions& options = *context.options;
+	size_t queueCount = context.queues.size();
+
+	vector<WalkEntry> batch{};
+	batch.reserve(options.batchSize);
+
+	auto flush = [&]()
+		{
+			if (batch.empty()) return;
+
+			{
+				lock_guard lock(context.batchMutex);
+				if (*context.onBatch) (*context.onBatch)(batch);
+			}
+			batch.clear();
+		};
+
+	vector<RawEntry> entries{};
+	u32 idleRounds{};
+
+	while (true)
+	{
+		WalkDirectory directory{};
+		bool hasWork{};
+
+		{
+			WorkQueue& own = *context.queues[threadIndex];
+			lock_guard lock(own.queueMutex);
+			if (!own.directories.empty())
+			{
+				directory = move(own.directories.back());
+				own.directories.pop_back();
+				hasWork = true;
+			}
+		}
+
+		for (size_t offset = 1; !hasWork && offset < queueCount; ++offset)
+		{
+			WorkQueue& victim = *context.queues[(threadIndex + offset) % queueCount];
+			lock_guard lock(victim.queueMutex);
+			if (!victim.directories.empty())
+			{
+				directory = move(victim.directories.front());
+				victim.directories.pop_front();
+				hasWork = true;
+			}
+		}
+
+		if (!hasWork)
+		{
+			if (context.pendingCount.load() == 0) break;
+
+			//other threads are still reading and may queue more, hand out entries meanwhile
+			flush();
+
+			if (++idleRounds < 64) std::this_thread::yield();
+			else std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+			continue;
+		}
+		idleRounds = 0;
+
+		entries.clear();
+		if (!ReadDirectory(directory.fullPath, options.readSizes, entries))
+		{
+			++outStats.unreadableCount;
+			if (directory.relativePath.empty()) context.isRootUnreadable = true;
+
+			--context.pendingCount;
+			continue;
+		}
+
+		//this directory's own ignore file applies to its entries, so it is read before any of them
+		shared_ptr<const IgnoreLevel> ignore = directory.ignore;
+		if (options.useGitignore)
+		{
+			for (const RawEntry& entry : entries)
+			{
+				if (entry.name == ".gitignore"
+					&& !entry.isDirectory)
+				{
+					ignore = LoadIgnoreFile(directory.fullPath + "/.gitignore", directory.relativePath, ignore);
+					break;
+				}
+			}
+		}
+
+		vector<WalkDirectory> children{};
+		for (RawEntry& entry : entries)
+		{
+			string relativePath = directory.relativePath.empty()
+				? entry.name
+				: directory.relativePath + "/" + entry.name;
+
+			if ((options.useGitignore
+				&& entry.isDirectory
+				&& entry.name == ".git")
+				|| IsIgnored(ignore.get(), relativePath, entry.name, entry.isDirectory))
+			{
+				++outStats.ignoredCount;
+				continue;
+			}
+
+			string fullPath = directory.fullPath + "/" + entry.name;
+
+			if (entry.isDirectory)
+			{
+				++outStats.directoryCount;
+				children.push_back({ fullPath, move(relativePath), ignore });
+			}
+			else
+			{
+				++outStats.fileCount;
+				outStats.totalBytes += entry.size;
+			}
+
+			batch.push_back({ path(move(fullPath)), entry.size, entry.isDirectory });
+			if (batch.size() >= options.batchSize) flush();
+		}
+
+		if (!children.empty())
+		{
+			context.pendingCount += children.size();
+
+			WorkQueue& own = *context.queues[threadIndex];
+			lock_guard lock(own.queueMutex);
+			for (WalkDirectory& child : children) own.directories.push_back(move(child));
+		}
+
+		//children are counted before this directory is finished, so the count never hits 0 early
+		--context.pendingCount;
+	}
+
+	flush();
+}
+
+bool ReadDirectory(
+	const string& fullPath,
+	bool readSizes,
+	vector<RawEntry>& outEntries)
+{
+#ifdef __linux__
+	int fd = open(fullPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	//getdents64 hands over the entry types with the names, so only unknown types and sizes need a stat
+	alignas(8) char buffer[64 * 1024];
+
+	while (true)
+	{
+		long bytes = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+		if (bytes <= 0)
+		{
+			close(fd);
+			return bytes == 0;
+		}
+
+		for (long offset = 0; offset < bytes;)
+		{
+			//layout of struct linux_dirent64, which glibc does not declare
+			const char* record = buffer + offset;
+			u16 recordLength = *reinterpret_cast<const u16*>(record + 16);
+			u8 type = static_cast<u8>(record[18]);
+			const char* name = record + 19;
+
+			offset += recordLength;
+
+			if (name[0] == '.'
+				&& (name[1] == '\0'
+				|| (name[1] == '.' && name[2] == '\0')))
+			{
+				continue;
+			}
+
+			RawEntry entry{};
+			entry.name = name;
+			entry.isDirectory = type == DT_DIR;
+
+			if (type == DT_UNKNOWN
+				|| (readSizes && type == DT_REG))
+			{
+				struct stat info{};
+				if (fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) == 0)
+				{
+					entry.isDirectory = S_ISDIR(info.st_mode);
+					if (S_ISREG(info.st_mode)) entry.size = static_cast<u64>(info.st_size);
+				}
+			}
+
+			outEntries.push_back(move(entry));
+		}
+	}
+#else
+	//the iterator keeps the type and size it got from the listing, so these do not stat again on Windows
+	error_code ec{};
+	directory_iterator it(fullPath, directory_options::skip_permission_denied, ec);
+	if (ec) return false;
+
+	for (; it != directory_iterator(); it.increment(ec))
+	{
+		if (ec) return false;
+
+		RawEntry entry{};
+
+		//names that have no narrow form throw here, on a walker thread that would end the program
+		try
+		{
+			entry.name = it->path().filename().string();
+		}
+		catch (exception&)
+		{
+			continue;
+		}
+
+		entry.isDirectory = it->is_directory(ec) && !it->is_symlink(ec);
+
+		if (readSizes
+			&& it->is_regular_file(ec))
+		{
+			entry.size = static_cast<u64>(it->file_size(ec));
+		}
+
+		outEntries.push_back(move(entry));
+	}
+
+	return true;
+#endif
+}
+
+shared_ptr<const IgnoreLevel> LoadIgnoreFile(
+	const path& filePath,
+	const string& base,
+	shared_ptr<const IgnoreLevel> parent)
+{
+	ifstream in(filePath);
+	if (!in) return parent;
+
+	auto level = make_shared<IgnoreLevel>();
+	level->parent = move(parent);
+	level->base = base;
+
+	string line{};
+	while (getline(in, line))
+	{
+		IgnoreRule rule{};
+		if (ParseIgnoreLine(line, rule)) level->rules.push_back(move(rule));
+	}
+
+	if (level->rules.empty()) return level->parent;
+
+	return level;
+}
+
+bool ParseIgnoreLine(
+	string_view line,
+	IgnoreRule& outRule)
+{
+	if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+	//trailing spaces are dropped unless escaped
+	while (!line.empty()
+		&& line.back() == ' '
+		&& !(line.size() > 1 && line[line.size() - 2] == '\\'))
+	{
+		line.remove_suffix(1);
+	}
+
+	if (line.empty()
+		|| line[0] == '#')
+	{
+		return false;
+	}
+
+	if (line[0] == '!')
+	{
+		outRule.isNegated = true;
+		line.remove_prefix(1);
+	}
+	else if (line.size() > 1
+		&& line[0] == '\\'
+		&& (line[1] == '!' || line[1] == '#'))
+	{
+		line.remove_prefix(1);
+	}
+
+	if (!line.empty() && line.back() == '/')
+	{
+		outRule.isDirectoryOnly = true;
+		line.remove_suffix(1);
+	}
+
+	//a slash anywhere but at the end ties the pattern to the directory of the ignore file
+	outRule.isAnchored = line.find('/') != string_view::npos;
+	if (!line.empty() && line[0] == '/') line.remove_prefix(1);
+
+	if (line.empty()) return false;
+
+	outRule.pattern = string(line);
+
+	return true;
+}
+
+bool IsIgnored(
+	const IgnoreLevel* level,
+	const string& relativePath,
+	string_view name,
+	bool isDirectory)
+{
+	//deeper ignore files win over their parents and later rules win within a file
+	for (; level; level = level->parent.get())
+	{
+		string_view below = relativePath;
+		if (!level->base.empty())
+		{
+			if (below.size() <= level->base.size()
+				|| below.compare(0, level->base.size(), level->base) != 0
+				|| below[level->base.size()] != '/')
+			{
+				continue;
+			}
+
+			below.remove_prefix(level->base.size() + 1);
+		}
+
+		for (auto rule = level->rules.rbegin(); rule != level->rules.rend(); ++rule)
+		{
+			if (rule->isDirectoryOnly && !isDirectory) continue;
+
+			if (MatchGlob(rule->pattern, rule->isAnchored ? below : name)) return !rule->isNegated;
+		}
+	}
+
+	return false;
+}
+
+bool MatchGlob(
+	string_view pattern,
+	string_view text)
+{
+	while (!pattern.empty())
+	{
+		if (pattern.size() >= 2
+			&& pattern[0] == '*'
+			&& pattern[1] == '*')
+		{
+			string_view rest = pattern.substr(2);
+			if (rest.empty()) return true;
+
+			//"**/" also matches zero directories
+			if (rest[0] == '/')
+			{
+				rest.remove_prefix(1);
+				if (MatchGlob(rest, text)) return true;
+
+				for (size_t i = 0; i < text.size(); ++i)
+				{
+					if (text[i] == '/'
+						&& MatchGlob(rest, text.substr(i + 1)))
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			for (size_t i = 0; i <= text.size(); ++i)
+			{
+				if (MatchGlob(rest, text.substr(i))) return true;
+			}
+
+			return false;
+		}
+
+		char c = pattern[0];
+
+		if (c == '*')
+		{
+			string_view rest = pattern.substr(1);
+			for (size_t i = 0; ; ++i)
+			{
+				if (MatchGlob(rest, text.substr(i))) return true;
+				if (i == text.size() || text[i] == '/') return false;
+			}
+		}
+
+		if (text.empty()) return false;
+
+		if (c == '?')
+		{
+			if (text[0] == '/') return false;
+		}
+		else if (c == '[')
+		{
+			//a ']' right after the opening bracket or its negation is a literal
+			size_t close = 1;
+			if (close < pattern.size() && (pattern[close] == '!' || pattern[close] == '^')) ++close;
+			if (close < pattern.size() && pattern[close] == ']') ++close;
+			while (close < pattern.size() && pattern[close] != ']') ++close;
+
+			if (close < pattern.size())
+			{
+				string_view set = pattern.substr(1, close - 1);
+
+				bool isNegated = set[0] == '!' || set[0] == '^';
+				if (isNegated) set.remove_prefix(1);
+
+				bool isMatch{};
+				for (size_t i = 0; i < set.size(); ++i)
+				{
+					if (i + 2 < set.size()
+						&& set[i + 1] == '-')
+					{
+						isMatch = isMatch || (text[0] >= set[i] && text[0] <= set[i + 2]);
+						i += 2;
+					}
+					else isMatch = isMatch || text[0] == set[i];
+				}
+
+				if (isMatch == isNegated
+					|| text[0] == '/')
+				{
+					return false;
+				}
+
+				pattern.remove_prefix(close + 1);
+				text.remove_prefix(1);
+				continue;
+			}
+
+			//no closing bracket, so it is a literal '['
+			if (text[0] != '[') return false;
+		}
+		else
+		{
+			if (c == '\\' && pattern.size() > 1)
+			{
+				pattern.remove_prefix(1);
+				c = pattern[0];
+			}
+
+			if (text[0] != c) return false;
+		}
+
+		pattern.remove_prefix(1);
+		text.remove_prefix(1);
+	}
+
+	return text.empty();
+}
\ No newline at end of file
@@ -0,0 +1,1027 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <deque>
+#include <unordered_set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <exception>
+#include <system_error>
+
+#include "KalaHeaders/log_utils.hpp"
+#include "KalaHeaders/file_utils.hpp"
+
+#include "core/file_io.hpp"
+#include "core/scheduler.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::ReadBinaryLinesFromFile;
+using KalaHeaders::WriteBinaryLinesToFile;
+
+using Solin::Core::FileIO;
+using Solin::Core::FileIOKind;
+using Solin::Core::FileIOResult;
+using Solin::Core::FileIOCallback;
+using Solin::Core::FrameScheduler;
+
+using std::string;
+using std::vector;
+using std::function;
+using std::deque;
+using std::unordered_set;
+using std::unique_ptr;
+using std::make_unique;
+using std::thread;
+using std::mutex;
+using std::condition_variable;
+using std::unique_lock;
+using std::lock_guard;
+using std::atomic;
+using std::ostringstream;
+using std::min;
+using std::max;
+using std::clamp;
+using std::ceil;
+using std::log2;
+using std::move;
+using std::strerror;
+using std::calloc;
+using std::free;
+using std::to_string;
+using std::exception;
+using std::error_code;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::filesystem::path;
+using std::filesystem::status;
+using std::filesystem::exists;
+using std::filesystem::permissions;
+using std::filesystem::perm_options;
+using std::filesystem::rename;
+using std::filesystem::remove;
+#ifdef __linux__
+using std::atomic_ref;
+using std::memory_order_acquire;
+using std::memory_order_release;
+#endif
+
+using TimePoint = steady_clock::time_point;
+
+//workers mostly wait on the disk, so their count does not follow the core count
+constexpr u32 DEFAULT_WORKER_COUNT = 4;
+
+#ifdef __linux__
+constexpr u32 URING_ENTRIES = 64;
+
+//page cache hits are copied inline on the completion thread,
+//so large files move in steps this big to keep other requests from waiting behind them
+constexpr size_t URING_CHUNK_BYTES = 8ULL * 1024 * 1024;
+
+//user_data of the no-op that tells the completion thread to stop
+constexpr u64 URING_STOP_TAG = 0;
+
+enum class UringStage : u8
+{
+	STAGE_OPEN,
+	STAGE_STAT,
+	STAGE_TRANSFER,
+	STAGE_SYNC,
+	STAGE_CLOSE
+};
+#endif
+
+struct PendingRequest
+{
+	FileIOResult result{};
+	path target{};
+
+	//writes go to this file next to the target and are renamed over it once complete,
+	//so a failed or interrupted save never leaves the target truncated
+	path tempTarget{};
+
+	function<string()> job{};
+	FileIOCallback onComplete{};
+
+	TimePoint submitTime{};
+	TimePoint readyTime{};
+
+#ifdef __linux__
+	//io_uring only reads the path and stat buffer after submission, so both live here
+	string nativePath{};
+	struct statx statBuffer{};
+	UringStage stage{};
+	int fd = -1;
+	size_t fileSize{};    //bytes to move in total
+	size_t chunkEnd{};    //end of the chunk currently in flight
+	size_t transferred{};
+#endif
+};
+
+static u32 lastRequestID{};
+
+static vector<thread> workers{};
+static mutex queueMutex{};
+static condition_variable queueCondition{};
+static deque<unique_ptr<PendingRequest>> queuedRequests{};
+static bool isStopping{};
+
+//filled by the worker and completion threads, emptied on the main thread
+static mutex doneMutex{};
+static vector<unique_ptr<PendingRequest>> doneRequests{};
+
+#ifdef __linux__
+struct UringRing
+{
+	int fd = -1;
+
+	void* sqRing{};
+	size_t sqRingSize{};
+	void* cqRing{};
+	size_t cqRingSize{};
+	io_uring_sqe* sqes{};
+	size_t sqesSize{};
+
+	u32* sqHead{};
+	u32* sqTail{};
+	u32* sqMask{};
+	u32* sqArray{};
+
+	u32* cqHead{};
+	u32* cqTail{};
+	u32* cqMask{};
+	io_uring_cqe* cqes{};
+};
+
+static UringRing ring{};
+static bool isUringActive{};
+static thread completionThread{};
+
+//submissions come from the main thread and from the completion thread
+static mutex submitMutex{};
+
+static atomic<u32> uringInFlight{};
+
+//every request holds at most one entry in the kernel, so keeping fewer requests in the ring
+//than the completion queue has slots means it can never overflow, one slot stays free for the stop no-op.
+//Requests past this go to the worker threads
+static u32 uringCapacity{};
+
+//requests the kernel currently holds, guarded by submitMutex.
+//If the ring fails they are finished with an error instead of waiting for completions that never come
+static unordered_set<PendingRequest*> uringRequests{};
+static bool isUringBroken{};
+#endif
+
+static u32 Enqueue(unique_ptr<PendingRequest> request);
+static void RunWorker();
+static void Finish(unique_ptr<PendingRequest> request);
+
+//Renames the temporary file of a successful write over its target and keeps the permissions
+//the target had, a failed write only removes the temporary file
+static void CommitWrite(PendingRequest& request);
+static string FormatErrno(
+	const char* action,
+	const path& target,
+	int err);
+
+#ifdef __linux__
+static bool StartUring();
+static void StopUring();
+static void RunCompletions();
+static bool SubmitSqe(
+	u8 opcode,
+	PendingRequest* request);
+static void AdvanceUring(
+	PendingRequest* request,
+	i32 res);
+
+//Finishes every request the kernel still holds with an error after io_uring_enter failed for good,
+//later reads and writes go to the worker threads
+static void FailUring(int err);
+
+//fsync for the worker threads, so a renamed file is on disk just like one written through the ring
+static string SyncFile(const path& target);
+#endif
+
+namespace Solin::Core
+{
+	void LatencyHistogram::Add(f64 microseconds)
+	{
+		size_t bucket = microseconds < 2.0
+			? 0
+			: min(static_cast<size_t>(log2(microseconds)), BUCKET_COUNT - 1);
+
+		++buckets[bucket];
+		++count;
+		maxMicroseconds = max(maxMicroseconds, microseconds);
+	}
+
+	f64 LatencyHistogram::GetPercentile(f64 percentile) const
+	{
+		if (count == 0) return 0.0;
+
+		u64 target = max(static_cast<u64>(ceil(count * clamp(percentile, 0.0, 100.0) / 100.0)), u64{ 1 });
+
+		u64 seen{};
+		for (size_t i = 0; i < BUCKET_COUNT; ++i)
+		{
+			seen += buckets[i];
+			if (seen >= target) return static_cast<f64>(u64{ 2 } << i);
+		}
+
+		return maxMicroseconds;
+	}
+
+	void FileIO::Initialize(u32 threadCount)
+	{
+		u32 workerCount = threadCount != 0
+			? threadCount
+			: DEFAULT_WORKER_COUNT;
+
+		isStopping = false;
+		for (u32 i = 0; i < workerCount; ++i) workers.emplace_back(RunWorker);
+
+#ifdef __linux__
+		isUringActive = StartUring();
+		stats.isUringActive = isUringActive;
+
+		if (!isUringActive)
+		{
+			Log::Print(
+				"io_uring is not available, file reads and writes fall back to worker threads.",
+				"FILE_IO",
+				LogType::LOG_INFO);
+		}
+#endif
+	}
+
+	u32 FileIO::Read(
+		const path& target,
+		const FileIOCallback& onComplete)
+	{
+		auto request = make_unique<PendingRequest>();
+		request->result.kind = FileIOKind::KIND_READ;
+		request->target = target;
+		request->onComplete = onComplete;
+
+		u32 requestID = Enqueue(move(request));
+		if (requestID != 0) ++stats.pendingCount;
+
+		return requestID;
+	}
+
+	u32 FileIO::Write(
+		const path& target,
+		vector<u8>&& data,
+		const FileIOCallback& onComplete)
+	{
+		//matches WriteBinaryLinesToFile, which the worker threads fall back to
+		if (data.empty())
+		{
+			Log::Print(
+				"Cannot write file '" + target.string() + "' because the data is empty!",
+				"FILE_IO",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		auto request = make_unique<PendingRequest>();
+		request->result.kind = FileIOKind::KIND_WRITE;
+		request->result.data = move(data);
+		request->target = target;
+		request->onComplete = onComplete;
+
+		u32 requestID = Enqueue(move(request));
+		if (requestID != 0) ++stats.pendingCount;
+
+		return requestID;
+	}
+
+	u32 FileIO::Submit(
+		const function<string()>& job,
+		const FileIOCallback& onComplete)
+	{
+		if (!job)
+		{
+			Log::Print(
+				"Cannot submit a file job without a function!",
+				"FILE_IO",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		auto request = make_unique<PendingRequest>();
+		request->result.kind = FileIOKind::KIND_TASK;
+		request->job = job;
+		request->onComplete = onComplete;
+
+		u32 requestID = Enqueue(move(request));
+		if (requestID != 0) ++stats.pendingCount;
+
+		return requestID;
+	}
+
+	void FileIO::DeliverCompletions()
+	{
+		vector<unique_ptr<PendingRequest>> finished{};
+		{
+			lock_guard lock(doneMutex);
+			if (doneRequests.empty()) return;
+
+			finished.swap(doneRequests);
+		}
+
+		PROFILE_ZONE("FileIO::DeliverCompletions");
+
+		for (auto& request : finished)
+		{
+			f64 microseconds = duration<f64, std::micro>(request->readyTime - request->submitTime).count();
+			stats.latency[static_cast<size_t>(request->result.kind)].Add(microseconds);
+
+			--stats.pendingCount;
+
+			if (request->onComplete) request->onComplete(request->result);
+		}
+
+		Profiler::RecordCounter("File IO pending", static_cast<f64>(stats.pendingCount));
+	}
+
+	void FileIO::Shutdown()
+	{
+		PROFILE_ZONE("FileIO::Shutdown");
+
+		//workers drain the queue before they exit, so queued writes still land on disk
+		{
+			lock_guard lock(queueMutex);
+			isStopping = true;
+		}
+		queueCondition.notify_all();
+
+		for (thread& worker : workers) worker.join();
+		workers.clear();
+
+#ifdef __linux__
+		if (isUringActive)
+		{
+			while (uringInFlight.load() != 0) std::this_thread::yield();
+
+			StopUring();
+			isUringActive = false;
+			stats.isUringActive = false;
+		}
+#endif
+
+		lock_guard lock(doneMutex);
+		doneRequests.clear();
+		stats.pendingCount = 0;
+	}
+}
+
+u32 Enqueue(unique_ptr<PendingRequest> request)
+{
+	if (workers.empty())
+	{
+		Log::Print(
+			"Cannot submit a file request before FileIO::Initialize or after FileIO::Shutdown!",
+			"FILE_IO",
+			LogType::LOG_ERROR,
+			2);
+
+		return 0;
+	}
+
+	u32 requestID = ++lastRequestID;
+	if (requestID == 0) requestID = ++lastRequestID;
+
+	request->result.requestID = requestID;
+	request->submitTime = steady_clock::now();
+
+	if (request->result.kind == FileIOKind::KIND_WRITE)
+	{
+		const path& target = request->target;
+		request->tempTarget = target.parent_path()
+			/ ("." + target.filename().string() + "." + to_string(requestID) + ".tmp");
+	}
+
+#ifdef __linux__
+	if (isUringActive
+		&& request->result.kind != FileIOKind::KIND_TASK)
+	{
+		request->nativePath = request->result.kind == FileIOKind::KIND_WRITE
+			? request->tempTarget.string()
+			: request->target.string();
+		request->stage = UringStage::STAGE_OPEN;
+
+		PendingRequest* raw = request.release();
+
+		if (uringInFlight.fetch_add(1) < uringCapacity
+			&& SubmitSqe(IORING_OP_OPENAT, raw))
+		{
+			return requestID;
+		}
+
+		//the ring is full or refused it, the worker threads can still do the job
+		--uringInFlight;
+		request.reset(raw);
+	}
+#endif
+
+	{
+		lock_guard lock(queueMutex);
+		queuedRequests.push_back(move(request));
+	}
+	queueCondition.notify_one();
+
+	return requestID;
+}
+
+void RunWorker()
+{
+	while (true)
+	{
+		unique_ptr<PendingRequest> request{};
+		{
+			unique_lock lock(queueMutex);
+			queueCondition.wait(
+				lock,
+				[] { return isStopping || !queuedRequests.empty(); });
+
+			if (queuedRequests.empty()) return;
+
+			request = move(queuedRequests.front());
+			queuedRequests.pop_front();
+		}
+
+		FileIOResult& result = request->result;
+
+		//a throwing job must not take the worker down with it, its request still has to be delivered
+		try
+		{
+			switch (result.kind)
+			{
+			case FileIOKind::KIND_READ:
+			{
+				PROFILE_ZONE("FileIO::WorkerRead");
+				result.error = ReadBinaryLinesFromFile(request->target, result.data);
+				break;
+			}
+			case FileIOKind::KIND_WRITE:
+			{
+				PROFILE_ZONE("FileIO::WorkerWrite");
+				result.error = WriteBinaryLinesToFile(request->tempTarget, result.data);
+#ifdef __linux__
+				if (result.error.empty()) result.error = SyncFile(request->tempTarget);
+#endif
+				break;
+			}
+			default:
+			{
+				PROFILE_ZONE("FileIO::WorkerTask");
+				result.error = request->job();
+				break;
+			}
+			}
+		}
+		catch (exception& e)
+		{
+			result.error = string("File request failed with an exception! Reason: ") + e.what();
+		}
+		catch (...)
+		{
+			result.error = "File request failed with an unknown exception!";
+		}
+
+		Finish(move(request));
+	}
+}
+
+void Finish(unique_ptr<PendingRequest> request)
+{
+	if (request->result.kind == FileIOKind::KIND_WRITE)
+	{
+		CommitWrite(*request);
+
+		//the written bytes are not needed anymore and may be large
+		vector<u8>().swap(request->result.data);
+	}
+
+	request->readyTime = steady_clock::now();
+	{
+		lock_guard lock(doneMutex);
+		doneRequests.push_back(move(request));
+	}
+
+	FrameScheduler::Wake();
+}
+
+void CommitWrite(PendingRequest& request)
+{
+	PROFILE_ZONE("FileIO::CommitWrite");
+
+	FileIOResult& result = request.result;
+	error_code ec{};
+
+	if (result.error.empty())
+	{
+		//a new file keeps the default permissions the temporary file was created with
+		if (exists(request.target, ec))
+		{
+			permissions(
+				request.tempTarget,
+				status(request.target, ec).permissions(),
+				perm_options::replace,
+				ec);
+		}
+
+		rename(request.tempTarget, request.target, ec);
+		if (!ec) return;
+
+		ostringstream oss{};
+		oss << "Failed to replace target '" << request.target
+			<< "' with the written file! Reason: " << ec.message();
+
+		result.error = oss.str();
+	}
+
+	remove(request.tempTarget, ec);
+}
+
+string FormatErrno(
+	const char* action,
+	const path& target,
+	int err)
+{
+	ostringstream oss{};
+	oss << "Failed to " << action << " target '" << target
+		<< "'! Reason: (errno " << err << "): " << strerror(err);
+
+	return oss.str();
+}
+
+#ifdef __linux__
+bool StartUring()
+{
+	io_uring_params params{};
+	int fd = static_cast<int>(syscall(__NR_io_uring_setup, URING_ENTRIES, &params));
+
+	//old kernels, containers and seccomp profiles often refuse io_uring
+	if (fd < 0) return false;
+
+	//open, statx and close through the ring need 5.6, the same kernel that added probing
+	auto probe = static_cast<io_uring_probe*>(calloc(1, sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)));
+	bool isSupported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+
+	for (u8 op : { IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_CLOSE })
+	{
+		isSupported = isSupported
+			&& op <= probe->last_op
+			&& (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+	}
+	free(probe);
+
+	if (!isSupported)
+	{
+		close(fd);
+		return false;
+	}
+
+	ring.fd = fd;
+	uringCapacity = params.cq_entries - 1;
+	ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+	ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	bool isSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (isSingleMap) ring.sqRingSize = ring.cqRingSize = max(ring.sqRingSize, ring.cqRingSize);
+
+	ring.sqRing = mmap(
+		nullptr,
+		ring.sqRingSize,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		IORING_OFF_SQ_RING);
+
+	ring.cqRing = isSingleMap
+		? ring.sqRing
+		: mmap(
+			nullptr,
+			ring.cqRingSize,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,
+			fd,
+			IORING_OFF_CQ_RING);
+
+	ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = mmap(
+		nullptr,
+		ring.sqesSize,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		IORING_OFF_SQES);
+
+	if (ring.sqRing == MAP_FAILED
+		|| ring.cqRing == MAP_FAILED
+		|| sqes == MAP_FAILED)
+	{
+		if (ring.sqRing != MAP_FAILED) munmap(ring.sqRing, ring.sqRingSize);
+		if (!isSingleMap && ring.cqRing != MAP_FAILED) munmap(ring.cqRing, ring.cqRingSize);
+		if (sqes != MAP_FAILED) munmap(sqes, ring.sqesSize);
+		close(fd);
+
+		ring = {};
+		return false;
+	}
+
+	u8* sq = static_cast<u8*>(ring.sqRing);
+	ring.sqHead = reinterpret_cast<u32*>(sq + params.sq_off.head);
+	ring.sqTail = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+	ring.sqMask = reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+	ring.sqArray = reinterpret_cast<u32*>(sq + params.sq_off.array);
+	ring.sqes = static_cast<io_uring_sqe*>(sqes);
+
+	u8* cq = static_cast<u8*>(ring.cqRing);
+	ring.cqHead = reinterpret_cast<u32*>(cq + params.cq_off.head);
+	ring.cqTail = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+	ring.cqMask = reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+	ring.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	completionThread = thread(RunCompletions);
+
+	return true;
+}
+
+void StopUring()
+{
+	//a broken ring already stopped its completion thread
+	SubmitSqe(IORING_OP_NOP, nullptr);
+	completionThread.join();
+
+	munmap(ring.sqes, ring.sqesSize);
+	if (ring.cqRing != ring.sqRing) munmap(ring.cqRing, ring.cqRingSize);
+	munmap(ring.sqRing, ring.sqRingSize);
+	close(ring.fd);
+
+	ring = {};
+	isUringBroken = false;
+}
+
+bool SubmitSqe(
+	u8 opcode,
+	PendingRequest* request)
+{
+	lock_guard lock(submitMutex);
+
+	if (isUringBroken) return false;
+
+	//every submission is entered right away, so the kernel has always consumed the previous ones
+	u32 tail = *ring.sqTail;
+	u32 index = tail & *ring.sqMask;
+
+	io_uring_sqe& sqe = ring.sqes[index];
+	sqe = {};
+	sqe.opcode = opcode;
+	sqe.user_data = request
+		? reinterpret_cast<u64>(request)
+		: URING_STOP_TAG;
+
+	if (request)
+	{
+		switch (opcode)
+		{
+		case IORING_OP_OPENAT:
+			sqe.fd = AT_FDCWD;
+			sqe.addr = reinterpret_cast<u64>(request->nativePath.c_str());
+			sqe.open_flags = request->result.kind == FileIOKind::KIND_READ
+				? O_RDONLY | O_CLOEXEC
+				: O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+			sqe.len = 0644;
+			break;
+		case IORING_OP_STATX:
+			sqe.fd = request->fd;
+			sqe.addr = reinterpret_cast<u64>("");
+			sqe.statx_flags = AT_EMPTY_PATH;
+			sqe.len = STATX_SIZE;
+			sqe.off = reinterpret_cast<u64>(&request->statBuffer);
+			break;
+		case IORING_OP_READ:
+		case IORING_OP_WRITE:
+			sqe.fd = request->fd;
+			sqe.addr = reinterpret_cast<u64>(request->result.data.data() + request->transferred);
+			sqe.len = static_cast<u32>(request->chunkEnd - request->transferred);
+			sqe.off = request->transferred;
+			break;
+		case IORING_OP_FSYNC:
+		case IORING_OP_CLOSE:
+			sqe.fd = request->fd;
+			break;
+		}
+	}
+
+	ring.sqArray[index] = index;
+	atomic_ref<u32>(*ring.sqTail).store(tail + 1, memory_order_release);
+
+	while (true)
+	{
+		long submitted = syscall(__NR_io_uring_enter, ring.fd, 1, 0, 0, nullptr, 0);
+		if (submitted == 1)
+		{
+			if (request) uringRequests.insert(request);
+			return true;
+		}
+
+		if (submitted < 0
+			&& errno == EINTR)
+		{
+			continue;
+		}
+
+		//EAGAIN and EBUSY are not waited out here, the completion thread submits too
+		//and would spin forever on a backlog only it can drain while the main thread waits for the lock.
+		//Take the entry back so the next submission does not send it again
+		atomic_ref<u32>(*ring.sqTail).store(tail, memory_order_release);
+		return false;
+	}
+}
+
+void RunCompletions()
+{
+	while (true)
+	{
+		long waited = syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+		if (waited < 0
+			&& errno != EINTR
+			&& errno != EAGAIN
+			&& errno != EBUSY)
+		{
+			FailUring(errno);
+			return;
+		}
+
+		u32 head = *ring.cqHead;
+		u32 tail = atomic_ref<u32>(*ring.cqTail).load(memory_order_acquire);
+
+		bool shouldStop{};
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+			u64 tag = cqe.user_data;
+			i32 res = cqe.res;
+
+			//the slot is free as soon as it was copied, follow-up submissions may need it
+			atomic_ref<u32>(*ring.cqHead).store(head + 1, memory_order_release);
+
+			if (tag == URING_STOP_TAG) shouldStop = true;
+			else AdvanceUring(reinterpret_cast<PendingRequest*>(tag), res);
+		}
+
+		if (shouldStop) return;
+	}
+}
+
+void AdvanceUring(
+	PendingRequest* request,
+	i32 res)
+{
+	FileIOResult& result = request->result;
+	bool isRead = result.kind == FileIOKind::KIND_READ;
+
+	auto finish = [request]()
+		{
+			{
+				lock_guard lock(submitMutex);
+				uringRequests.erase(request);
+			}
+
+			Finish(unique_ptr<PendingRequest>(request));
+			--uringInFlight;
+		};
+
+	//on any failure after the open only the close is still sent
+	auto fail = [&](const char* action, int err)
+		{
+			result.error = FormatErrno(action, request->target, err);
+			if (isRead) result.data.clear();
+
+			if (request->fd >= 0)
+			{
+				request->stage = UringStage::STAGE_CLOSE;
+				if (SubmitSqe(IORING_OP_CLOSE, request)) return;
+
+				close(request->fd);
+			}
+
+			finish();
+		};
+
+	u8 transferOp = isRead
+		? IORING_OP_READ
+		: IORING_OP_WRITE;
+
+	//reads grow the buffer one chunk at a time so zeroing a huge file does not stall the thread either,
+	//writes send at most one chunk of the data they already hold
+	auto submitChunk = [&]()
+		{
+			request->chunkEnd = min(request->transferred + URING_CHUNK_BYTES, request->fileSize);
+			if (isRead) result.data.resize(request->chunkEnd);
+
+			return SubmitSqe(transferOp, request);
+		};
+
+	switch (request->stage)
+	{
+	case UringStage::STAGE_OPEN:
+	{
+		if (res < 0)
+		{
+			fail("open", -res);
+			return;
+		}
+
+		request->fd = res;
+
+		if (isRead)
+		{
+			request->stage = UringStage::STAGE_STAT;
+			if (!SubmitSqe(IORING_OP_STATX, request)) fail("stat", EIO);
+		}
+		else
+		{
+			request->fileSize = result.data.size();
+			request->stage = UringStage::STAGE_TRANSFER;
+			if (!submitChunk()) fail("write", EIO);
+		}
+		return;
+	}
+	case UringStage::STAGE_STAT:
+	{
+		if (res < 0)
+		{
+			fail("stat", -res);
+			return;
+		}
+
+		request->fileSize = static_cast<size_t>(request->statBuffer.stx_size);
+
+		//capacity only, pages are touched chunk by chunk
+		result.data.reserve(request->fileSize);
+
+		if (request->fileSize == 0)
+		{
+			request->stage = UringStage::STAGE_CLOSE;
+			if (!SubmitSqe(IORING_OP_CLOSE, request))
+			{
+				close(request->fd);
+				finish();
+			}
+			return;
+		}
+
+		request->stage = UringStage::STAGE_TRANSFER;
+		if (!submitChunk()) fail("read", EIO);
+		return;
+	}
+	case UringStage::STAGE_TRANSFER:
+	{
+		if (res < 0)
+		{
+			fail(isRead ? "read" : "write", -res);
+			return;
+		}
+
+		if (res == 0)
+		{
+			if (!isRead)
+			{
+				fail("write", EIO);
+				return;
+			}
+
+			//the file shrank since the stat, keep what was there
+			result.data.resize(request->transferred);
+			request->fileSize = request->transferred;
+		}
+
+		request->transferred += static_cast<size_t>(res);
+
+		//short transfers continue where they stopped
+		if (request->transferred < request->fileSize)
+		{
+			if (!submitChunk()) fail(isRead ? "read" : "write", EIO);
+			return;
+		}
+
+		//the data has to be on disk before the rename makes it the target
+		if (!isRead)
+		{
+			request->stage = UringStage::STAGE_SYNC;
+			if (!SubmitSqe(IORING_OP_FSYNC, request)) fail("sync", EIO);
+			return;
+		}
+
+		request->stage = UringStage::STAGE_CLOSE;
+		if (!SubmitSqe(IORING_OP_CLOSE, request))
+		{
+			close(request->fd);
+			finish();
+		}
+		return;
+	}
+	case UringStage::STAGE_SYNC:
+	{
+		if (res < 0)
+		{
+			fail("sync", -res);
+			return;
+		}
+
+		request->stage = UringStage::STAGE_CLOSE;
+		if (!SubmitSqe(IORING_OP_CLOSE, request))
+		{
+			close(request->fd);
+			finish();
+		}
+		return;
+	}
+	case UringStage::STAGE_CLOSE:
+	{
+		//a failed close after a write may mean the data never reached the disk
+		if (res < 0
+			&& result.error.empty()
+			&& !isRead)
+		{
+			result.error = FormatErrno("close", request->target, -res);
+		}
+
+		finish();
+		return;
+	}
+	}
+}
+
+void FailUring(int err)
+{
+	vector<PendingRequest*> stranded{};
+	{
+		lock_guard lock(submitMutex);
+		isUringBroken = true;
+
+		stranded.assign(uringRequests.begin(), uringRequests.end());
+		uringRequests.clear();
+	}
+
+	//SubmitSqe now refuses everything, so Enqueue hands new requests to the worker threads
+	for (PendingRequest* request : stranded)
+	{
+		FileIOResult& result = request->result;
+
+		result.error = FormatErrno("complete the request for", request->target, err);
+		if (result.kind == FileIOKind::KIND_READ) result.data.clear();
+
+		if (request->fd >= 0) close(request->fd);
+
+		Finish(unique_ptr<PendingRequest>(request));
+		--uringInFlight;
+	}
+}
+
+string SyncFile(const path& target)
+{
+	int fd = open(target.c_str(), O_WRONLY | O_CLOEXEC);
+	if (fd < 0) return FormatErrno("open", target, errno);
+
+	string result{};
+	if (fsync(fd) != 0) result = FormatErrno("sync", target, errno);
+
+	close(fd);
+
+	return result;
+}
+#endif
\ No newline at end of file
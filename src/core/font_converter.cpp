@@ -0,0 +1,374 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+
+#include "KalaHeaders/log_utils.hpp"
+#include "KalaHeaders/file_utils.hpp"
+
+#include "KalaWindow/include/ui/import_kfont.hpp"
+
+#include "core/font_converter.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::ReadLinesFromFile;
+using KalaHeaders::WriteBinaryLinesToFile;
+
+using KalaFont::MappedKalaFont;
+using KalaFont::GlyphView;
+using KalaFont::GlyphCompression;
+using KalaFont::KalaFontHeaderV2;
+using KalaFont::KalaFontGlyphEntryV2;
+using KalaFont::KalaFontCodepointEntryV2;
+using KalaFont::KFONT_V2_HEADER_SIZE;
+using KalaFont::KFONT_V2_GLYPH_ENTRY_SIZE;
+using KalaFont::KFONT_V2_CODEPOINT_ENTRY_SIZE;
+
+using std::vector;
+using std::string;
+using std::stoul;
+using std::to_string;
+using std::exception;
+using std::stable_sort;
+using std::sort;
+using std::unique;
+using std::lower_bound;
+using std::memcpy;
+using std::filesystem::path;
+
+static void AppendVarint(vector<u8>& out, u32 value);
+static void EncodeDeltaVarint(const GlyphView& glyph, vector<u8>& out);
+static bool ReadCodepointMap(
+	const path& mapPath,
+	vector<KalaFontCodepointEntryV2>& outPairs);
+
+template<typename T>
+static void AppendRaw(vector<u8>& out, const T& value)
+{
+	size_t offset = out.size();
+	out.resize(offset + sizeof(T));
+	memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+namespace Solin::Core
+{
+	bool FontConverter::UpgradeKalaFont(
+		const path& inPath,
+		const path& outPath,
+		const path& codepointMapPath,
+		bool compress)
+	{
+		PROFILE_ZONE("FontConverter::UpgradeKalaFont");
+
+		MappedKalaFont font{};
+		if (!font.Open(inPath)) return false;
+
+		u32 glyphCount = font.GetGlyphCount();
+
+		vector<GlyphView> glyphs(glyphCount);
+		for (u32 g = 0; g < glyphCount; ++g)
+		{
+			if (!font.GetGlyph(g, glyphs[g])) return false;
+		}
+
+		//the glyph table is sorted by glyph index so glyphs can be found by binary search
+		stable_sort(
+			glyphs.begin(),
+			glyphs.end(),
+			[](const GlyphView& a, const GlyphView& b) { return a.glyphIndex < b.glyphIndex; });
+
+		//
+		// CODEPOINT TABLE
+		//
+
+		vector<KalaFontCodepointEntryV2> codepoints{};
+		if (!codepointMapPath.empty())
+		{
+			vector<KalaFontCodepointEntryV2> pairs{};
+			if (!ReadCodepointMap(codepointMapPath, pairs)) return false;
+
+			//map file pairs hold glyph indices, the table stores positions in the glyph table
+			for (const auto& pair : pairs)
+			{
+				auto it = lower_bound(
+					glyphs.begin(),
+					glyphs.end(),
+					pair.glyph,
+					[](const GlyphView& g, u32 index) { return g.glyphIndex < index; });
+
+				if (it == glyphs.end()
+					|| it->glyphIndex != pair.glyph)
+				{
+					Log::Print(
+						"Skipped codepoint '" + to_string(pair.codepoint) + "' because font '"
+						+ inPath.string() + "' has no glyph '" + to_string(pair.glyph) + "'!",
+						"FONT_CONVERTER",
+						LogType::LOG_WARNING);
+
+					continue;
+				}
+
+				codepoints.push_back({ pair.codepoint, static_cast<u32>(it - glyphs.begin()) });
+			}
+
+			//the first mapping of a codepoint wins
+			stable_sort(
+				codepoints.begin(),
+				codepoints.end(),
+				[](const auto& a, const auto& b) { return a.codepoint < b.codepoint; });
+			codepoints.erase(
+				unique(
+					codepoints.begin(),
+					codepoints.end(),
+					[](const auto& a, const auto& b) { return a.codepoint == b.codepoint; }),
+				codepoints.end());
+		}
+
+		//
+		// GLYPH DATA
+		//
+
+		vector<KalaFontGlyphEntryV2> entries(glyphCount);
+		vector<u8> data{};
+		vector<u8> compressed{};
+
+		u64 totalVertexFloats{};
+		u64 totalIndices{};
+		u32 compressedCount{};
+
+		for (u32 g = 0; g < glyphCount; ++g)
+		{
+			const GlyphView& glyph = glyphs[g];
+			KalaFontGlyphEntryV2& entry = entries[g];
+
+			entry.glyphIndex = glyph.glyphIndex;
+			entry.advanceWidth = glyph.advanceWidth;
+			entry.leftSideBearing = glyph.leftSideBearing;
+			entry.anchor = glyph.anchor;
+			entry.transform[0] = glyph.transform.m00;
+			entry.transform[1] = glyph.transform.m01;
+			entry.transform[2] = glyph.transform.m10;
+			entry.transform[3] = glyph.transform.m11;
+			entry.vertexFloats = static_cast<u32>(glyph.vertices.size());
+			entry.indexCount = static_cast<u32>(glyph.indices.size());
+
+			totalVertexFloats += entry.vertexFloats;
+			totalIndices += entry.indexCount;
+
+			size_t rawSize = glyph.vertices.size_bytes() + glyph.indices.size_bytes();
+
+			compressed.clear();
+			if (compress) EncodeDeltaVarint(glyph, compressed);
+
+			entry.dataOffset = static_cast<u32>(data.size());
+
+			if (compress
+				&& compressed.size() < rawSize)
+			{
+				entry.compression = GlyphCompression::COMPRESSION_DELTA_VARINT;
+				entry.dataSize = static_cast<u32>(compressed.size());
+
+				data.insert(data.end(), compressed.begin(), compressed.end());
+				++compressedCount;
+			}
+			else
+			{
+				entry.compression = GlyphCompression::COMPRESSION_NONE;
+				entry.dataSize = static_cast<u32>(rawSize);
+
+				size_t offset = data.size();
+				data.resize(offset + rawSize);
+
+				if (!glyph.vertices.empty()) memcpy(data.data() + offset, glyph.vertices.data(), glyph.vertices.size_bytes());
+				if (!glyph.indices.empty()) memcpy(data.data() + offset + glyph.vertices.size_bytes(), glyph.indices.data(), glyph.indices.size_bytes());
+			}
+
+			//uncompressed glyphs are read in place, so every glyph starts 4 byte aligned
+			data.resize((data.size() + 3) & ~static_cast<size_t>(3));
+		}
+
+		//
+		// FILE
+		//
+
+		KalaFontHeaderV2 header{};
+		header.glyphCount = glyphCount;
+		header.codepointCount = static_cast<u32>(codepoints.size());
+		header.glyphTableOffset = KFONT_V2_HEADER_SIZE;
+		header.codepointTableOffset = header.glyphTableOffset + glyphCount * KFONT_V2_GLYPH_ENTRY_SIZE;
+		header.dataOffset = header.codepointTableOffset + header.codepointCount * KFONT_V2_CODEPOINT_ENTRY_SIZE;
+		header.dataSize = static_cast<u32>(data.size());
+		header.totalVertexFloats = static_cast<u32>(totalVertexFloats);
+		header.totalIndices = static_cast<u32>(totalIndices);
+
+		if (static_cast<u64>(header.dataOffset) + data.size() > 0xFFFFFFFFull)
+		{
+			Log::Print(
+				"Cannot convert font '" + inPath.string() + "' because it is too large for version 2!",
+				"FONT_CONVERTER",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		vector<u8> out{};
+		out.reserve(header.dataOffset + data.size());
+
+		AppendRaw(out, header);
+		for (const auto& entry : entries) AppendRaw(out, entry);
+		for (const auto& codepoint : codepoints) AppendRaw(out, codepoint);
+		out.insert(out.end(), data.begin(), data.end());
+
+		//the source stays mapped until here, it must be released before it can be overwritten
+		font.Close();
+
+		string result = WriteBinaryLinesToFile(outPath, out);
+		if (!result.empty())
+		{
+			Log::Print(
+				result,
+				"FONT_CONVERTER",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		Log::Print(
+			"Upgraded font '" + inPath.string() + "' to '" + outPath.string() + "' with "
+			+ to_string(glyphCount) + " glyphs, " + to_string(compressedCount) + " compressed and "
+			+ to_string(codepoints.size()) + " codepoints.",
+			"FONT_CONVERTER",
+			LogType::LOG_SUCCESS);
+
+		return true;
+	}
+
+	bool FontConverter::RunFromArguments(
+		int argc,
+		char* argv[],
+		int& outExitCode)
+	{
+		if (argc < 2
+			|| string(argv[1]) != "--upgrade-kfont")
+		{
+			return false;
+		}
+
+		if (argc < 4)
+		{
+			Log::Print(
+				"Usage: --upgrade-kfont <in.kfont> <out.kfont> [codepoint map]",
+				"FONT_CONVERTER",
+				LogType::LOG_ERROR,
+				2);
+
+			outExitCode = 1;
+			return true;
+		}
+
+		path codepointMapPath = argc > 4 ? path(argv[4]) : path{};
+
+		outExitCode = UpgradeKalaFont(
+			argv[2],
+			argv[3],
+			codepointMapPath) ? 0 : 1;
+
+		return true;
+	}
+}
+
+void AppendVarint(vector<u8>& out, u32 value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<u8>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<u8>(value));
+}
+
+void EncodeDeltaVarint(const GlyphView& glyph, vector<u8>& out)
+{
+	//neighbouring points share sign, exponent and high mantissa bits,
+	//so xor with the previous value of the same axis leaves mostly low bits
+	u32 previous[2]{};
+	for (size_t i = 0; i < glyph.vertices.size(); ++i)
+	{
+		u32 bits{};
+		memcpy(&bits, &glyph.vertices[i], sizeof(u32));
+
+		AppendVarint(out, bits ^ previous[i & 1]);
+		previous[i & 1] = bits;
+	}
+
+	//triangle indices mostly step by small amounts
+	u32 previousIndex{};
+	for (u32 index : glyph.indices)
+	{
+		u32 delta = index - previousIndex;
+		u32 zigzag = (delta << 1) ^ (0u - (delta >> 31));
+
+		AppendVarint(out, zigzag);
+		previousIndex = index;
+	}
+}
+
+bool ReadCodepointMap(
+	const path& mapPath,
+	vector<KalaFontCodepointEntryV2>& outPairs)
+{
+	vector<string> lines{};
+
+	string result = ReadLinesFromFile(mapPath, lines);
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"FONT_CONVERTER",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	for (size_t i = 0; i < lines.size(); ++i)
+	{
+		const string& line = lines[i];
+		if (line.empty()
+			|| line[0] == '#')
+		{
+			continue;
+		}
+
+		try
+		{
+			size_t used{};
+			u32 codepoint = static_cast<u32>(stoul(line, &used, 0));
+			u32 glyphIndex = static_cast<u32>(stoul(line.substr(used), nullptr, 0));
+
+			outPairs.push_back({ codepoint, glyphIndex });
+		}
+		catch (exception&)
+		{
+			Log::Print(
+				"Codepoint map '" + mapPath.string() + "' has an invalid pair on line " + to_string(i + 1) + "!",
+				"FONT_CONVERTER",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
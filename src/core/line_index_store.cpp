@@ -0,0 +1,416 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <vector>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "core/line_index_store.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::MappedFile;
+using KalaHeaders::LineIndex;
+using KalaHeaders::MapFile;
+using KalaHeaders::IndexLines;
+using KalaHeaders::ExtendLineIndex;
+using KalaHeaders::CreateDirectory;
+using KalaHeaders::WriteBinaryLinesToFile;
+
+using Solin::Core::LineIndexStore;
+
+using std::vector;
+using std::string;
+using std::future;
+using std::async;
+using std::launch;
+using std::mutex;
+using std::scoped_lock;
+using std::ostringstream;
+using std::hex;
+using std::setw;
+using std::setfill;
+using std::memcpy;
+using std::memcmp;
+using std::min;
+using std::max;
+using std::move;
+using std::error_code;
+using std::filesystem::path;
+using std::filesystem::exists;
+using std::filesystem::absolute;
+using std::filesystem::file_size;
+using std::filesystem::last_write_time;
+
+//bump when the sidecar layout changes so older sidecars are rebuilt
+constexpr u32 LINE_INDEX_VERSION = 2;
+
+//the content hash reads this many evenly spaced blocks of the indexed bytes
+constexpr size_t HASH_SAMPLE_COUNT = 16;
+constexpr size_t HASH_SAMPLE_BYTES = 4096;
+
+struct LineIndexHeader
+{
+	char magic[4]{ 'K', 'L', 'I', 'X' };
+	u32 version = LINE_INDEX_VERSION;
+	u64 fileSize{};
+	i64 writeTime{};
+	u64 sampleHash{};
+	u64 startCount{};   //line starts stored after the header, the first one is always 0
+	u64 payloadBytes{};
+};
+
+static_assert(sizeof(LineIndexHeader) == 48, "LineIndexHeader must stay tightly packed");
+
+static vector<future<void>> pendingWrites{};
+
+//two opens of the same file must not write its sidecar at the same time
+static mutex writeMutex{};
+
+static path GetSidecarPath(
+	const path& filePath,
+	const path& cacheDir);
+static i64 GetWriteTime(const path& filePath);
+static u64 SampleHash(
+	const u8* data,
+	size_t size);
+//Checks that every stored line start after the first directly follows a line break,
+//an append leaves them all in place while an edit of the old bytes almost never does
+static bool AreStartsAtLineBreaks(
+	const u8* data,
+	const vector<size_t>& starts,
+	size_t count);
+static bool AreStartsAtLineBreaks(
+	const u8* data,
+	const vector<size_t>& starts,
+	size_t count)
+{
+	PROFILE_ZONE("LineIndexStore::AreStartsAtLineBreaks");
+
+	count = min(count, starts.size());
+
+	u8 missing{};
+	for (size_t i = 1; i < count; ++i) missing |= data[starts[i] - 1] ^ '\n';
+
+	return missing == 0;
+}
+
+bool ReadSidecar(
+	const path& sidecarPath,
+	LineIndexHeader& outHeader,
+	vector<size_t>& outStarts);
+static void QueueWrite(
+	const path& sidecarPath,
+	const path& cacheDir,
+	const LineIndex& index,
+	i64 writeTime);
+
+namespace Solin::Core
+{
+	bool LineIndexStore::Open(
+		const path& filePath,
+		const path& cacheDir,
+		LineIndex& outIndex)
+	{
+		PROFILE_ZONE("LineIndexStore::Open");
+
+		error_code ec{};
+		u64 size = file_size(filePath, ec);
+		if (ec) size = 0;
+
+		i64 writeTime = GetWriteTime(filePath);
+
+		path sidecarPath{};
+		if (!cacheDir.empty()
+			&& size > 0)
+		{
+			sidecarPath = GetSidecarPath(filePath, cacheDir);
+
+			LineIndexHeader header{};
+			vector<size_t> knownStarts{};
+
+			//appending keeps the old bytes, so their line starts and hash stay valid
+			if (ReadSidecar(sidecarPath, header, knownStarts)
+				&& (header.fileSize < size
+				|| (header.fileSize == size
+				&& header.writeTime == writeTime)))
+			{
+				size_t resume = knownStarts.back();
+
+				//the sampled blocks alone miss edits between them, so a grown file
+				//also has to keep a line break in front of every reused start
+				if (ExtendLineIndex(filePath, move(knownStarts), outIndex).empty()
+					&& SampleHash(outIndex.GetFile().GetData(), header.fileSize) == header.sampleHash
+					&& (header.fileSize == size
+					|| AreStartsAtLineBreaks(
+						outIndex.GetFile().GetData(),
+						outIndex.GetLineStarts(),
+						static_cast<size_t>(header.startCount))))
+				{
+					if (header.fileSize == size)
+					{
+						++stats.reusedCount;
+						return true;
+					}
+
+					++stats.extendedCount;
+					stats.scannedBytes += size - resume;
+
+					QueueWrite(sidecarPath, cacheDir, outIndex, writeTime);
+					return true;
+				}
+			}
+		}
+
+		string result = IndexLines(filePath, outIndex);
+		if (!result.empty())
+		{
+			Log::Print(
+				result,
+				"LINE_INDEX",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		++stats.rebuiltCount;
+		stats.scannedBytes += outIndex.GetFile().GetSize();
+
+		if (!sidecarPath.empty()) QueueWrite(sidecarPath, cacheDir, outIndex, writeTime);
+
+		return true;
+	}
+
+	void LineIndexStore::Flush()
+	{
+		PROFILE_ZONE("LineIndexStore::Flush");
+
+		for (future<void>& write : pendingWrites) write.wait();
+		pendingWrites.clear();
+	}
+}
+
+path GetSidecarPath(
+	const path& filePath,
+	const path& cacheDir)
+{
+	error_code ec{};
+	path fullPath = absolute(filePath, ec);
+	if (ec) fullPath = filePath;
+
+	//sidecars are named after the file path, the header tells whether the contents still match
+	u64 hash = 14695981039346656037ull;
+	for (char c : fullPath.generic_string())
+	{
+		hash ^= static_cast<u8>(c);
+		hash *= 1099511628211ull;
+	}
+
+	ostringstream oss{};
+	oss << hex << setw(16) << setfill('0') << hash << ".klix";
+
+	return cacheDir / oss.str();
+}
+
+i64 GetWriteTime(const path& filePath)
+{
+	error_code ec{};
+	auto time = last_write_time(filePath, ec);
+
+	return ec
+		? 0
+		: static_cast<i64>(time.time_since_epoch().count());
+}
+
+u64 SampleHash(
+	const u8* data,
+	size_t size)
+{
+	constexpr u64 FNV_PRIME = 1099511628211ull;
+
+	u64 hash = 14695981039346656037ull ^ size;
+	hash *= FNV_PRIME;
+
+	//small files are hashed whole, larger ones by blocks spread from the start to the end,
+	//the last block always ends on the last byte
+	size_t blockBytes = min(size, HASH_SAMPLE_BYTES);
+	size_t blockCount = size <= HASH_SAMPLE_COUNT * HASH_SAMPLE_BYTES
+		? (size + blockBytes - 1) / blockBytes
+		: HASH_SAMPLE_COUNT;
+
+	for (size_t b = 0; b < blockCount; ++b)
+	{
+		size_t start = b + 1 == blockCount
+			? size - blockBytes
+			: (size - blockBytes) / max(blockCount - 1, size_t{ 1 }) * b;
+		size_t end = min(start + blockBytes, size);
+
+		for (size_t i = start; i < end; ++i)
+		{
+			hash ^= data[i];
+			hash *= FNV_PRIME;
+		}
+	}
+
+	return hash;
+}
+
+bool ReadSidecar(
+	const path& sidecarPath,
+	LineIndexHeader& outHeader,
+	vector<size_t>& outStarts)
+{
+	PROFILE_ZONE("LineIndexStore::ReadSidecar");
+
+	if (!exists(sidecarPath)) return false;
+
+	MappedFile file{};
+	if (!MapFile(sidecarPath, file).empty()) return false;
+
+	const u8* data = file.GetData();
+	size_t size = file.GetSize();
+
+	LineIndexHeader header{};
+	if (size < sizeof(header)) return false;
+	memcpy(&header, data, sizeof(header));
+
+	//a sidecar cut short by a crash or written by another version is rebuilt
+	if (memcmp(header.magic, "KLIX", 4) != 0
+		|| header.version != LINE_INDEX_VERSION
+		|| header.startCount == 0
+		|| header.payloadBytes != size - sizeof(header)
+		|| header.startCount - 1 > header.payloadBytes)
+	{
+		return false;
+	}
+
+	vector<size_t> starts(static_cast<size_t>(header.startCount));
+
+	//line lengths are stored as LEB128 varints, most lines fit in one or two bytes
+	const u8* cursor = data + sizeof(header);
+	const u8* end = data + size;
+
+	size_t offset{};
+	for (size_t i = 1; i < starts.size(); ++i)
+	{
+		u64 delta{};
+
+		//typical lines are just around 128 bytes long, so one and two byte lengths
+		//are decoded without branching on the continuation bit
+		if (end - cursor >= 2
+			&& (cursor[0] & cursor[1] & 0x80) == 0)
+		{
+			u64 twoBytes = cursor[0] >> 7;
+			delta = (cursor[0] & 0x7F) | ((cursor[1] & (0u - twoBytes)) << 7);
+			cursor += 1 + twoBytes;
+		}
+		else
+		{
+			u32 shift{};
+			while (true)
+			{
+				if (cursor == end || shift > 63) return false;
+
+				u8 byte = *cursor++;
+				delta |= static_cast<u64>(byte & 0x7F) << shift;
+				shift += 7;
+
+				if ((byte & 0x80) == 0) break;
+			}
+		}
+
+		offset += delta;
+		if (delta == 0
+			|| offset > header.fileSize
+			|| (cursor == end
+			&& i + 1 < starts.size()))
+		{
+			return false;
+		}
+
+		starts[i] = offset;
+	}
+	if (cursor != end) return false;
+
+	outHeader = header;
+	outStarts = move(starts);
+
+	return true;
+}
+
+void QueueWrite(
+	const path& sidecarPath,
+	const path& cacheDir,
+	const LineIndex& index,
+	i64 writeTime)
+{
+	PROFILE_ZONE("LineIndexStore::QueueWrite");
+
+	//finished writes are dropped so the list only holds running ones
+	erase_if(pendingWrites, [](const future<void>& write)
+		{
+			return write.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+
+	const u8* data = index.GetFile().GetData();
+	size_t size = index.GetFile().GetSize();
+
+	LineIndexHeader header{};
+	header.fileSize = size;
+	header.writeTime = writeTime;
+	header.sampleHash = SampleHash(data, size);
+
+	//the final start only marks the end of the file unless the file ends with a newline
+	vector<size_t> starts = index.GetLineStarts();
+	if (data[size - 1] != '\n') starts.pop_back();
+
+	header.startCount = starts.size();
+
+	//the mapping may be closed before the write runs, so only copies are handed over
+	pendingWrites.push_back(async(
+		launch::async,
+		[sidecarPath, cacheDir, header, starts = move(starts)]() mutable
+		{
+			vector<u8> out(sizeof(header));
+			out.reserve(sizeof(header) + starts.size() * 2);
+
+			for (size_t i = 1; i < starts.size(); ++i)
+			{
+				u64 delta = starts[i] - starts[i - 1];
+				while (delta >= 0x80)
+				{
+					out.push_back(static_cast<u8>(delta) | 0x80);
+					delta >>= 7;
+				}
+				out.push_back(static_cast<u8>(delta));
+			}
+
+			header.payloadBytes = out.size() - sizeof(header);
+			memcpy(out.data(), &header, sizeof(header));
+
+			scoped_lock lock(writeMutex);
+
+			string result{};
+			if (!exists(cacheDir)) result = CreateDirectory(cacheDir);
+			if (result.empty()) result = WriteBinaryLinesToFile(sidecarPath, out);
+
+			//a missing sidecar only costs a rescan next time
+			if (!result.empty())
+			{
+				Log::Print(
+					result,
+					"LINE_INDEX",
+					LogType::LOG_WARNING);
+			}
+		}));
+}
\ No newline at end of file
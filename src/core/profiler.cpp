@@ -0,0 +1,351 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+
+#include "KalaHeaders/file_utils.hpp"
+
+#include "KalaWindow/include/core/core.hpp"
+
+using KalaHeaders::WriteTextToFile;
+
+using KalaWindow::Core::KalaWindowCore;
+
+using std::array;
+using std::vector;
+using std::unique_ptr;
+using std::make_unique;
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+using std::ostringstream;
+using std::nth_element;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+using Solin::Core::ProfileEvent;
+using Solin::Core::ProfileEventType;
+
+//must be a power of two so the write index can be masked
+constexpr size_t RING_CAPACITY = 1 << 15;
+constexpr size_t RING_MASK = RING_CAPACITY - 1;
+
+constexpr size_t FRAME_SAMPLE_COUNT = 512;
+
+//Seqlock slot, sequence is 2 * index + 1 while event index is written
+//and 2 * index + 2 once it is complete, so a reader can tell a torn or
+//overwritten slot apart from the event it expected
+struct RingSlot
+{
+	atomic<u64> sequence{};
+	atomic<const char*> name{};
+	atomic<u64> startNS{};
+	atomic<u64> durationNS{};
+	atomic<f64> value{};
+	atomic<ProfileEventType> type{};
+};
+
+//Single producer ring, only the owning thread writes
+//and the trace writer reads whatever has not been overwritten yet
+struct ThreadRing
+{
+	u32 threadID{};
+	atomic<u64> head{};
+	array<RingSlot, RING_CAPACITY> slots{};
+
+	//set when the owning thread exited, the next new thread takes the ring over
+	//and keeps writing after the events that are already in it
+	atomic<bool> isRetired{};
+};
+
+//Retires the ring of its thread when the thread exits, so short lived
+//worker threads do not leave one ring each behind
+struct RingOwner
+{
+	ThreadRing* ring{};
+
+	~RingOwner()
+	{
+		if (ring) ring->isRetired.store(true, std::memory_order_release);
+	}
+};
+
+static const steady_clock::time_point startTime = steady_clock::now();
+
+static mutex ringMutex{};
+static vector<unique_ptr<ThreadRing>> rings{};
+
+static thread_local RingOwner localRing{};
+
+//routes the zones of the KalaHeaders file and log functions into the profiler
+[[maybe_unused]] static const bool isHookInstalled = []
+	{
+		KalaHeaders::ProfileHook::getTime = &Solin::Core::Profiler::GetTimeNS;
+		KalaHeaders::ProfileHook::recordZone = &Solin::Core::Profiler::RecordZone;
+		return true;
+	}();
+
+//frame stats are only touched by the main thread
+static u64 frameStartNS{};
+static array<f64, FRAME_SAMPLE_COUNT> frameSamples{};
+static size_t frameSampleCount{};
+static size_t frameSampleNext{};
+
+static void PushEvent(const ProfileEvent& e);
+//Copies event index of the ring, false if the owning thread is writing or already overwrote it
+static bool ReadEvent(
+	const ThreadRing& ring,
+	u64 index,
+	ProfileEvent& out);
+static void AppendEscaped(ostringstream& oss, const char* value);
+
+namespace Solin::Core
+{
+	u64 Profiler::GetTimeNS()
+	{
+		return static_cast<u64>(duration_cast<nanoseconds>(steady_clock::now() - startTime).count());
+	}
+
+	void Profiler::RecordZone(
+		const char* name,
+		u64 startNS,
+		u64 endNS)
+	{
+		if (!IsEnabled()
+			|| !name)
+		{
+			return;
+		}
+
+		PushEvent(
+		{
+			.name = name,
+			.startNS = startNS,
+			.durationNS = endNS - startNS,
+			.type = ProfileEventType::EVENT_ZONE
+		});
+	}
+
+	void Profiler::RecordCounter(
+		const char* name,
+		f64 value)
+	{
+		if (!IsEnabled()
+			|| !name)
+		{
+			return;
+		}
+
+		PushEvent(
+		{
+			.name = name,
+			.startNS = GetTimeNS(),
+			.value = value,
+			.type = ProfileEventType::EVENT_COUNTER
+		});
+	}
+
+	void Profiler::BeginFrame()
+	{
+		frameStartNS = GetTimeNS();
+	}
+
+	void Profiler::EndFrame()
+	{
+		if (!IsEnabled()) return;
+
+		u64 endNS = GetTimeNS();
+
+		RecordZone("Frame", frameStartNS, endNS);
+		PushEvent(
+		{
+			.name = "Frame",
+			.startNS = endNS,
+			.type = ProfileEventType::EVENT_FRAME
+		});
+
+		frameSamples[frameSampleNext] = static_cast<f64>(endNS - frameStartNS) / 1'000'000.0;
+		frameSampleNext = (frameSampleNext + 1) % FRAME_SAMPLE_COUNT;
+		if (frameSampleCount < FRAME_SAMPLE_COUNT) ++frameSampleCount;
+	}
+
+	FrameStats Profiler::GetFrameStats()
+	{
+		FrameStats result{};
+		result.frameTime = KalaWindowCore::GetFrameTime();
+		result.sampleCount = static_cast<u32>(frameSampleCount);
+
+		if (frameSampleCount == 0) return result;
+
+		vector<f64> sorted(
+			frameSamples.begin(),
+			frameSamples.begin() + frameSampleCount);
+
+		auto Percentile = [&sorted](f64 p)
+			{
+				size_t index = static_cast<size_t>(p * static_cast<f64>(sorted.size() - 1));
+				nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+				return sorted[index];
+			};
+
+		result.p50 = Percentile(0.50);
+		result.p95 = Percentile(0.95);
+		result.p99 = Percentile(0.99);
+
+		return result;
+	}
+
+	string Profiler::WriteChromeTrace(const path& target)
+	{
+		ostringstream oss{};
+		oss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		bool isFirst = true;
+		auto Separator = [&]()
+			{
+				if (!isFirst) oss << ",\n";
+				isFirst = false;
+			};
+
+		vector<ProfileEvent> snapshot{};
+		snapshot.reserve(RING_CAPACITY);
+
+		//the lock is released before writing since the file functions record zones too
+		{
+			lock_guard lock(ringMutex);
+			for (const auto& ring : rings)
+			{
+				u64 head = ring->head.load(std::memory_order_acquire);
+				u64 first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+				//events the owning thread overwrote while they were copied are dropped
+				snapshot.clear();
+				ProfileEvent e{};
+				for (u64 i = first; i < head; ++i)
+				{
+					if (ReadEvent(*ring, i, e)) snapshot.push_back(e);
+				}
+
+				Separator();
+				oss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadID
+					<< ",\"args\":{\"name\":\"Thread " << ring->threadID << "\"}}";
+
+				for (const ProfileEvent& e : snapshot)
+				{
+
+					Separator();
+					oss << "{\"name\":\"";
+					AppendEscaped(oss, e.name);
+					oss << "\",\"pid\":1,\"tid\":" << ring->threadID
+						<< ",\"ts\":" << static_cast<f64>(e.startNS) / 1000.0;
+
+					switch (e.type)
+					{
+					case ProfileEventType::EVENT_ZONE:
+						oss << ",\"ph\":\"X\",\"dur\":" << static_cast<f64>(e.durationNS) / 1000.0 << "}";
+						break;
+					case ProfileEventType::EVENT_COUNTER:
+						oss << ",\"ph\":\"C\",\"args\":{\"value\":" << e.value << "}}";
+						break;
+					case ProfileEventType::EVENT_FRAME:
+						oss << ",\"ph\":\"i\",\"s\":\"g\"}";
+						break;
+					}
+				}
+			}
+		}
+
+		oss << "]}";
+
+		return WriteTextToFile(target, oss.str());
+	}
+}
+
+void PushEvent(const ProfileEvent& e)
+{
+	if (!localRing.ring)
+	{
+		lock_guard lock(ringMutex);
+
+		for (const auto& ring : rings)
+		{
+			if (ring->isRetired.load(std::memory_order_acquire))
+			{
+				ring->isRetired.store(false, std::memory_order_relaxed);
+				localRing.ring = ring.get();
+				break;
+			}
+		}
+
+		if (!localRing.ring)
+		{
+			unique_ptr<ThreadRing> newRing = make_unique<ThreadRing>();
+			newRing->threadID = static_cast<u32>(rings.size() + 1);
+
+			localRing.ring = newRing.get();
+			rings.push_back(move(newRing));
+		}
+	}
+
+	ThreadRing* ring = localRing.ring;
+
+	u64 index = ring->head.load(std::memory_order_relaxed);
+	RingSlot& slot = ring->slots[index & RING_MASK];
+
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.name.store(e.name, std::memory_order_relaxed);
+	slot.startNS.store(e.startNS, std::memory_order_relaxed);
+	slot.durationNS.store(e.durationNS, std::memory_order_relaxed);
+	slot.value.store(e.value, std::memory_order_relaxed);
+	slot.type.store(e.type, std::memory_order_relaxed);
+
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+	ring->head.store(index + 1, std::memory_order_release);
+}
+
+bool ReadEvent(
+	const ThreadRing& ring,
+	u64 index,
+	ProfileEvent& out)
+{
+	const RingSlot& slot = ring.slots[index & RING_MASK];
+	u64 expected = 2 * index + 2;
+
+	if (slot.sequence.load(std::memory_order_acquire) != expected) return false;
+
+	out.name = slot.name.load(std::memory_order_relaxed);
+	out.startNS = slot.startNS.load(std::memory_order_relaxed);
+	out.durationNS = slot.durationNS.load(std::memory_order_relaxed);
+	out.value = slot.value.load(std::memory_order_relaxed);
+	out.type = slot.type.load(std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == expected;
+}
+
+void AppendEscaped(ostringstream& oss, const char* value)
+{
+	for (const char* c = value; *c; ++c)
+	{
+		if (*c == '"'
+			|| *c == '\\')
+		{
+			oss << '\\';
+		}
+		oss << *c;
+	}
+}
\ No newline at end of file
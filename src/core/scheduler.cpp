@@ -0,0 +1,416 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "KalaWindow/include/graphics/window.hpp"
+
+#include "core/scheduler.hpp"
+
+#ifndef _WIN32
+//only for the ConnectionNumber and QLength macros, which read the Display directly and need no libX11 link.
+//Included last because its macros (None, Bool, Status...) would break the headers above
+#include <X11/Xlib.h>
+#endif
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+
+using std::vector;
+using std::function;
+using std::atomic;
+using std::ostringstream;
+using std::fixed;
+using std::setprecision;
+using std::remove_if;
+using std::find_if;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+
+using TimePoint = steady_clock::time_point;
+
+struct ScheduledTimer
+{
+	u32 ID{};
+	f64 intervalSeconds{};
+	TimePoint nextDue{};
+	function<void()> callback{};
+	bool isRepeating{};
+};
+
+static vector<ScheduledTimer> timers{};
+static u32 lastTimerID{};
+
+//first frame is always drawn
+static atomic<bool> isRedrawPending{ true };
+
+#ifdef _WIN32
+static HANDLE wakeEvent{};
+#else
+//Wake writes a byte here so the poll in WaitForEvents returns,
+//both ends are non-blocking so a full pipe just means a wake is already pending
+static int wakePipe[2]{ -1, -1 };
+static vector<pollfd> waitFds{};
+#endif
+
+//stats of the currently measured one second window
+static TimePoint windowStart{};
+static f64 windowCPUStart{};
+static f64 windowBlockedSeconds{};
+static u64 windowWakeups{};
+static u64 windowFrames{};
+
+static f64 GetProcessCPUSeconds();
+static f64 GetSecondsUntilNextTimer(TimePoint now);
+
+namespace Solin::Core
+{
+	void FrameScheduler::Initialize(SchedulerMode newMode)
+	{
+		mode = newMode;
+
+#ifdef _WIN32
+		//auto-reset so a single Wake() only releases one wait
+		if (!wakeEvent) wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#else
+		if (wakePipe[0] < 0
+			&& pipe(wakePipe) == 0)
+		{
+			for (int fd : wakePipe)
+			{
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+				fcntl(fd, F_SETFD, FD_CLOEXEC);
+			}
+		}
+#endif
+
+		windowStart = steady_clock::now();
+		windowCPUStart = GetProcessCPUSeconds();
+	}
+
+	void FrameScheduler::WaitForEvents()
+	{
+		if (mode == SchedulerMode::MODE_CONTINUOUS
+			|| isRedrawPending.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		TimePoint waitStart = steady_clock::now();
+		f64 timeout = GetSecondsUntilNextTimer(waitStart);
+
+		//a timer is already due
+		if (timeout == 0.0) return;
+
+#ifdef _WIN32
+		DWORD timeoutMS = timeout < 0.0
+			? INFINITE
+			: static_cast<DWORD>(timeout * 1000.0) + 1;
+
+		DWORD result = MsgWaitForMultipleObjectsEx(
+			1,
+			&wakeEvent,
+			timeoutMS,
+			QS_ALLINPUT,
+			MWMO_INPUTAVAILABLE);
+
+		//any window message may change what is on screen (input, resize, focus)
+		if (result == WAIT_OBJECT_0 + 1) isRedrawPending.store(true, std::memory_order_release);
+#else
+		//the wake pipe first, then the X11 connection of every window
+		waitFds.clear();
+		if (wakePipe[0] >= 0) waitFds.push_back({ wakePipe[0], POLLIN, 0 });
+
+		for (const auto& window : KalaWindow::Graphics::Window::registry.runtimeContent)
+		{
+			Display* display = reinterpret_cast<Display*>(window->GetWindowData().display);
+			if (!display) continue;
+
+			//events Xlib already read off the socket would never wake the poll
+			if (QLength(display) > 0)
+			{
+				isRedrawPending.store(true, std::memory_order_release);
+				return;
+			}
+
+			int fd = ConnectionNumber(display);
+			bool isListed{};
+			for (const pollfd& p : waitFds) isListed = isListed || p.fd == fd;
+
+			if (!isListed) waitFds.push_back({ fd, POLLIN, 0 });
+		}
+
+		//without a pending timer nothing but input or a wake can change the screen
+		int timeoutMS = timeout < 0.0
+			? -1
+			: static_cast<int>(timeout * 1000.0) + 1;
+
+		int result = poll(
+			waitFds.data(),
+			static_cast<nfds_t>(waitFds.size()),
+			timeoutMS);
+
+		if (result > 0)
+		{
+			for (size_t i = 0; i < waitFds.size(); ++i)
+			{
+				if (waitFds[i].revents == 0) continue;
+
+				if (waitFds[i].fd == wakePipe[0])
+				{
+					char drain[64]{};
+					while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+				}
+				//any X11 event may change what is on screen (input, resize, focus)
+				else isRedrawPending.store(true, std::memory_order_release);
+			}
+		}
+#endif
+
+		windowBlockedSeconds += duration<f64>(steady_clock::now() - waitStart).count();
+	}
+
+	void FrameScheduler::RunDueTimers()
+	{
+		if (timers.empty()) return;
+
+		TimePoint now = steady_clock::now();
+
+		//callbacks may add or remove timers, so only IDs are collected first
+		vector<u32> dueTimers{};
+		for (const auto& t : timers)
+		{
+			if (t.nextDue <= now) dueTimers.push_back(t.ID);
+		}
+
+		for (u32 ID : dueTimers)
+		{
+			auto it = find_if(
+				timers.begin(),
+				timers.end(),
+				[ID](const ScheduledTimer& t) { return t.ID == ID; });
+
+			if (it == timers.end()) continue;
+
+			function<void()> callback = it->callback;
+
+			if (it->isRepeating)
+			{
+				//skip missed intervals instead of firing them all at once after a long block
+				while (it->nextDue <= now)
+				{
+					it->nextDue += duration_cast<steady_clock::duration>(duration<f64>(it->intervalSeconds));
+				}
+			}
+			else timers.erase(it);
+
+			if (callback) callback();
+		}
+	}
+
+	void FrameScheduler::RequestRedraw()
+	{
+		isRedrawPending.store(true, std::memory_order_release);
+		Wake();
+	}
+
+	void FrameScheduler::Wake()
+	{
+#ifdef _WIN32
+		if (wakeEvent) SetEvent(wakeEvent);
+#else
+		if (wakePipe[1] >= 0)
+		{
+			char byte = 1;
+			[[maybe_unused]] ssize_t written = write(wakePipe[1], &byte, 1);
+		}
+#endif
+	}
+
+	bool FrameScheduler::ConsumeRedraw()
+	{
+		bool wasPending = isRedrawPending.exchange(false, std::memory_order_acq_rel);
+
+		return mode == SchedulerMode::MODE_CONTINUOUS
+			|| wasPending;
+	}
+
+	u32 FrameScheduler::AddTimer(
+		f64 intervalSeconds,
+		const function<void()>& callback,
+		bool isRepeating)
+	{
+		if (!callback
+			|| intervalSeconds <= 0.0)
+		{
+			Log::Print(
+				"Cannot add a timer without a callback or with an interval of zero or less!",
+				"SCHEDULER",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		u32 newID = ++lastTimerID;
+
+		timers.push_back(
+		{
+			.ID = newID,
+			.intervalSeconds = intervalSeconds,
+			.nextDue = steady_clock::now()
+				+ duration_cast<steady_clock::duration>(duration<f64>(intervalSeconds)),
+			.callback = callback,
+			.isRepeating = isRepeating
+		});
+
+		return newID;
+	}
+
+	void FrameScheduler::RemoveTimer(u32 timerID)
+	{
+		timers.erase(remove_if(
+			timers.begin(),
+			timers.end(),
+			[timerID](const ScheduledTimer& t) { return t.ID == timerID; }),
+			timers.end());
+	}
+
+	void FrameScheduler::EndFrame(bool didRedraw)
+	{
+		++windowWakeups;
+		if (didRedraw) ++windowFrames;
+
+		++stats.totalWakeups;
+		if (didRedraw) ++stats.totalFrames;
+
+		TimePoint now = steady_clock::now();
+		f64 elapsed = duration<f64>(now - windowStart).count();
+
+		if (elapsed < 1.0) return;
+
+		f64 cpuNow = GetProcessCPUSeconds();
+
+		stats.wakeupsPerSecond = static_cast<f64>(windowWakeups) / elapsed;
+		stats.framesPerSecond = static_cast<f64>(windowFrames) / elapsed;
+		stats.cpuPercent = (cpuNow - windowCPUStart) / elapsed * 100.0;
+		stats.idlePercent = clamp(windowBlockedSeconds / elapsed * 100.0, 0.0, 100.0);
+
+		windowStart = now;
+		windowCPUStart = cpuNow;
+		windowBlockedSeconds = 0.0;
+		windowWakeups = 0;
+		windowFrames = 0;
+
+		if (isStatsLoggingEnabled)
+		{
+			ostringstream oss{};
+			oss << fixed << setprecision(1)
+				<< "wakeups/s: " << stats.wakeupsPerSecond
+				<< ", frames/s: " << stats.framesPerSecond
+				<< ", cpu: " << stats.cpuPercent << "%"
+				<< ", idle: " << stats.idlePercent << "%";
+
+			Log::Print(
+				oss.str(),
+				"SCHEDULER",
+				LogType::LOG_INFO);
+		}
+	}
+
+	void FrameScheduler::Shutdown()
+	{
+		timers.clear();
+
+#ifdef _WIN32
+		if (wakeEvent)
+		{
+			CloseHandle(wakeEvent);
+			wakeEvent = nullptr;
+		}
+#else
+		for (int& fd : wakePipe)
+		{
+			if (fd >= 0) close(fd);
+			fd = -1;
+		}
+#endif
+	}
+}
+
+f64 GetProcessCPUSeconds()
+{
+#ifdef _WIN32
+	FILETIME creationTime{};
+	FILETIME exitTime{};
+	FILETIME kernelTime{};
+	FILETIME userTime{};
+
+	if (!GetProcessTimes(
+		GetCurrentProcess(),
+		&creationTime,
+		&exitTime,
+		&kernelTime,
+		&userTime))
+	{
+		return 0.0;
+	}
+
+	auto ToSeconds = [](const FILETIME& ft)
+		{
+			ULARGE_INTEGER value{};
+			value.LowPart = ft.dwLowDateTime;
+			value.HighPart = ft.dwHighDateTime;
+
+			//FILETIME is in 100 nanosecond units
+			return static_cast<f64>(value.QuadPart) / 10'000'000.0;
+		};
+
+	return ToSeconds(kernelTime) + ToSeconds(userTime);
+#else
+	//clock() is process CPU time on POSIX
+	return static_cast<f64>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+f64 GetSecondsUntilNextTimer(TimePoint now)
+{
+	if (timers.empty()) return -1.0;
+
+	TimePoint nextDue = timers.front().nextDue;
+	for (const auto& t : timers)
+	{
+		if (t.nextDue < nextDue) nextDue = t.nextDue;
+	}
+
+	if (nextDue <= now) return 0.0;
+
+	return duration<f64>(nextDue - now).count();
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#include "stb/stb_image.h"
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "KalaWindow/include/graphics/opengl/opengl_functions_core.hpp"
+
+#include "core/scheduler.hpp"
+#include "graphics/atlas.hpp"
+#include "graphics/scene.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+
+using namespace KalaWindow::Graphics::OpenGLFunctions;
+using KalaWindow::UI::Widget;
+
+using Solin::Graphics::SkylinePacker;
+using Solin::Graphics::AtlasRect;
+using Solin::Graphics::AtlasRegion;
+using Solin::Graphics::TextureAtlas;
+using Solin::Graphics::RetainedScene;
+using Solin::Graphics::DIRTY_TEXTURE;
+using Solin::Core::FrameScheduler;
+
+using std::unordered_map;
+using std::vector;
+using std::string;
+using std::to_string;
+using std::memcpy;
+
+//empty border around each image so linear filtering never samples a neighbour
+constexpr u32 ATLAS_PADDING = 1;
+
+struct AtlasPage
+{
+	u32 textureID{};
+	SkylinePacker packer{};
+	u32 regionCount{};
+};
+
+struct WindowAtlas
+{
+	vector<AtlasPage> pages{};
+};
+
+static unordered_map<u32, WindowAtlas> atlases{};
+static unordered_map<u32, AtlasRegion> regions{};
+static unordered_map<u32, u32> regionWindows{};
+//widget ID to region ID, IDs so a widget removed without detaching
+//can never hand its region to a new widget at the same address
+static unordered_map<u32, u32> widgetRegions{};
+
+//padded upload of the current AddPixels call, reused between calls
+static vector<u8> uploadBuffer{};
+
+static u32 nextRegionID = 1;
+
+static bool CreatePage(AtlasPage& page);
+
+namespace Solin::Graphics
+{
+	//
+	// TEXTURE ATLAS
+	//
+
+	u32 TextureAtlas::AddImage(
+		u32 windowID,
+		const string& path)
+	{
+		PROFILE_ZONE("TextureAtlas::AddImage");
+
+		int width{};
+		int height{};
+		int channels{};
+
+		stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		if (!pixels)
+		{
+			Log::Print(
+				"Failed to load atlas image '" + path + "'! Reason: " + stbi_failure_reason(),
+				"TEXTURE_ATLAS",
+				LogType::LOG_ERROR,
+				2);
+
+			return 0;
+		}
+
+		u32 regionID = AddPixels(
+			windowID,
+			pixels,
+			static_cast<u32>(width),
+			static_cast<u32>(height));
+
+		stbi_image_free(pixels);
+
+		return regionID;
+	}
+
+	u32 TextureAtlas::AddPixels(
+		u32 windowID,
+		const u8* pixels,
+		u32 width,
+		u32 height)
+	{
+		if (!pixels
+			|| width == 0
+			|| height == 0
+			|| width > MAX_IMAGE_SIZE
+			|| height > MAX_IMAGE_SIZE)
+		{
+			return 0;
+		}
+
+		WindowAtlas& atlas = atlases[windowID];
+
+		u32 paddedWidth = width + ATLAS_PADDING * 2;
+		u32 paddedHeight = height + ATLAS_PADDING * 2;
+
+		AtlasRect rect{};
+		u32 pageIndex = static_cast<u32>(atlas.pages.size());
+
+		for (u32 i = 0; i < atlas.pages.size(); ++i)
+		{
+			if (atlas.pages[i].packer.Insert(paddedWidth, paddedHeight, rect))
+			{
+				pageIndex = i;
+				break;
+			}
+		}
+
+		if (pageIndex == atlas.pages.size())
+		{
+			if (atlas.pages.size() >= MAX_PAGES)
+			{
+				Log::Print(
+					"All atlas pages of window '" + to_string(windowID) + "' are full!",
+					"TEXTURE_ATLAS",
+					LogType::LOG_ERROR,
+					2);
+
+				return 0;
+			}
+
+			AtlasPage newPage{};
+			if (!CreatePage(newPage)
+				|| !newPage.packer.Insert(paddedWidth, paddedHeight, rect))
+			{
+				return 0;
+			}
+
+			atlas.pages.push_back(newPage);
+		}
+
+		AtlasPage& page = atlas.pages[pageIndex];
+
+		//the gutter is uploaded too, a rect reused after RemoveRegion
+		//still holds the pixels of its previous image there
+		uploadBuffer.assign(static_cast<size_t>(paddedWidth) * paddedHeight * 4, 0);
+
+		size_t rowBytes = static_cast<size_t>(width) * 4;
+		size_t paddedRowBytes = static_cast<size_t>(paddedWidth) * 4;
+		for (u32 y = 0; y < height; ++y)
+		{
+			memcpy(
+				uploadBuffer.data() + (y + ATLAS_PADDING) * paddedRowBytes + ATLAS_PADDING * 4,
+				pixels + y * rowBytes,
+				rowBytes);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, page.textureID);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(
+			GL_TEXTURE_2D,
+			0,
+			static_cast<GLint>(rect.x),
+			static_cast<GLint>(rect.y),
+			static_cast<GLsizei>(paddedWidth),
+			static_cast<GLsizei>(paddedHeight),
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			uploadBuffer.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		++page.regionCount;
+
+		f32 pageSize = static_cast<f32>(PAGE_SIZE);
+
+		u32 regionID = nextRegionID++;
+		regions[regionID] =
+		{
+			.ID = regionID,
+			.textureID = page.textureID,
+			.page = pageIndex,
+			.uvMin = vec2(
+				static_cast<f32>(rect.x + ATLAS_PADDING) / pageSize,
+				static_cast<f32>(rect.y + ATLAS_PADDING) / pageSize),
+			.uvMax = vec2(
+				static_cast<f32>(rect.x + ATLAS_PADDING + width) / pageSize,
+				static_cast<f32>(rect.y + ATLAS_PADDING + height) / pageSize),
+			.size = vec2(static_cast<f32>(width), static_cast<f32>(height)),
+			.rect = rect
+		};
+		regionWindows[regionID] = windowID;
+
+		return regionID;
+	}
+
+	void TextureAtlas::RemoveRegion(u32 regionID)
+	{
+		auto it = regions.find(regionID);
+		if (it == regions.end()) return;
+
+		u32 windowID = regionWindows[regionID];
+		WindowAtlas& atlas = atlases[windowID];
+
+		if (it->second.page < atlas.pages.size())
+		{
+			AtlasPage& page = atlas.pages[it->second.page];
+			page.packer.Free(it->second.rect);
+			if (page.regionCount > 0) --page.regionCount;
+		}
+
+		bool wasAssigned{};
+		for (auto w = widgetRegions.begin(); w != widgetRegions.end();)
+		{
+			if (w->second == regionID)
+			{
+				w = widgetRegions.erase(w);
+				wasAssigned = true;
+			}
+			else ++w;
+		}
+
+		//the detached widgets fall back to their own texture, which the scene can not see
+		if (wasAssigned)
+		{
+			RetainedScene::InvalidateWindow(windowID);
+			FrameScheduler::RequestRedraw();
+		}
+
+		regions.erase(it);
+		regionWindows.erase(regionID);
+	}
+
+	const AtlasRegion* TextureAtlas::GetRegion(u32 regionID)
+	{
+		auto it = regions.find(regionID);
+		return it == regions.end() ? nullptr : &it->second;
+	}
+
+	void TextureAtlas::AssignRegion(
+		const Widget* widget,
+		u32 regionID)
+	{
+		if (!widget) return;
+
+		bool didChange{};
+		if (regionID == 0
+			|| !regions.contains(regionID))
+		{
+			didChange = widgetRegions.erase(widget->GetID()) > 0;
+		}
+		else
+		{
+			u32& assigned = widgetRegions[widget->GetID()];
+			didChange = assigned != regionID;
+			assigned = regionID;
+		}
+
+		//the scene only compares widget state, a new region is invisible to it
+		if (didChange)
+		{
+			RetainedScene::MarkDirty(widget, DIRTY_TEXTURE);
+			FrameScheduler::RequestRedraw();
+		}
+	}
+
+	const AtlasRegion* TextureAtlas::GetWidgetRegion(const Widget* widget)
+	{
+		if (widgetRegions.empty()) return nullptr;
+
+		auto it = widgetRegions.find(widget->GetID());
+		return it == widgetRegions.end() ? nullptr : GetRegion(it->second);
+	}
+
+	AtlasStats TextureAtlas::GetStats(u32 windowID)
+	{
+		AtlasStats stats{};
+
+		auto it = atlases.find(windowID);
+		if (it == atlases.end()
+			|| it->second.pages.empty())
+		{
+			return stats;
+		}
+
+		for (const auto& page : it->second.pages)
+		{
+			stats.regionCount += page.regionCount;
+			stats.occupancy += page.packer.GetOccupancy();
+			stats.fragmentation += page.packer.GetFragmentation();
+		}
+
+		stats.pageCount = static_cast<u32>(it->second.pages.size());
+		stats.occupancy /= static_cast<f32>(stats.pageCount);
+		stats.fragmentation /= static_cast<f32>(stats.pageCount);
+
+		return stats;
+	}
+
+	void TextureAtlas::RemoveWindow(
+		u32 windowID,
+		bool isContextAlive)
+	{
+		auto it = atlases.find(windowID);
+		if (it == atlases.end()) return;
+
+		if (isContextAlive)
+		{
+			for (auto& page : it->second.pages) glDeleteTextures(1, &page.textureID);
+		}
+
+		for (auto r = regionWindows.begin(); r != regionWindows.end();)
+		{
+			if (r->second != windowID)
+			{
+				++r;
+				continue;
+			}
+
+			u32 regionID = r->first;
+			for (auto w = widgetRegions.begin(); w != widgetRegions.end();)
+			{
+				if (w->second == regionID) w = widgetRegions.erase(w);
+				else ++w;
+			}
+
+			regions.erase(regionID);
+			r = regionWindows.erase(r);
+		}
+
+		atlases.erase(it);
+	}
+}
+
+bool CreatePage(AtlasPage& page)
+{
+	glGenTextures(1, &page.textureID);
+	if (page.textureID == 0)
+	{
+		Log::Print(
+			"Failed to create an atlas page texture!",
+			"TEXTURE_ATLAS",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, page.textureID);
+	glTexStorage2D(
+		GL_TEXTURE_2D,
+		1,
+		GL_RGBA8,
+		TextureAtlas::PAGE_SIZE,
+		TextureAtlas::PAGE_SIZE);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	page.packer.Initialize(TextureAtlas::PAGE_SIZE, TextureAtlas::PAGE_SIZE);
+
+	return true;
+}
\ No newline at end of file
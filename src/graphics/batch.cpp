@@ -0,0 +1,354 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "KalaWindow/include/graphics/opengl/opengl.hpp"
+#include "KalaWindow/include/graphics/opengl/opengl_functions_core.hpp"
+
+#include "graphics/batch.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+
+using KalaWindow::Graphics::OpenGL::OpenGL_Global;
+using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+using KalaWindow::Graphics::OpenGL::ShaderType;
+using namespace KalaWindow::Graphics::OpenGLFunctions;
+
+using Solin::Graphics::QuadInstance;
+using Solin::Graphics::QuadBatch;
+
+using std::string;
+using std::string_view;
+using std::unordered_map;
+using std::max;
+
+static_assert(sizeof(QuadInstance) == 14 * sizeof(f32), "QuadInstance must stay tightly packed for upload");
+
+//Instanced variant of the stock quad shader, the model matrix of
+//createumodel is rebuilt from the instance pos, size and rotation
+static constexpr string_view shader_batch_vertex =
+R"(
+	#version 330 core
+
+	layout (location = 0) in vec2 aPos;
+	layout (location = 1) in vec2 iPos;
+	layout (location = 2) in vec2 iSize;
+	layout (location = 3) in vec2 iRot;
+	layout (location = 4) in vec4 iColor;
+	layout (location = 5) in vec4 iUV;
+
+	out vec2 TexCoord;
+	out vec4 Color;
+
+	uniform mat4 uProjection;
+
+	void main()
+	{
+		vec2 scaled = aPos * iSize;
+		vec2 worldPos = vec2(
+			iRot.x * scaled.x + iRot.y * scaled.y,
+			-iRot.y * scaled.x + iRot.x * scaled.y) + iPos;
+
+		gl_Position = uProjection * vec4(worldPos, 0.0, 1.0);
+
+		TexCoord = mix(iUV.xy, iUV.zw, aPos + 0.5);
+		Color = iColor;
+	}
+)";
+
+static constexpr string_view shader_batch_fragment =
+R"(
+	#version 330 core
+
+	in vec2 TexCoord;
+	in vec4 Color;
+	out vec4 FragColor;
+
+	uniform sampler2D uTexture0;
+	uniform bool uUseTexture = false;
+
+	void main()
+	{
+		float safeOpacity = clamp(Color.a, 0.0, 1.0);
+		vec3 safeColor = clamp(Color.rgb, 0.0, 1.0);
+
+		if (safeOpacity < 0.1) discard;
+
+		vec4 texColor = vec4(1.0);
+		if (uUseTexture) texColor = texture(uTexture0, TexCoord);
+
+		FragColor = vec4(texColor.rgb * safeColor, texColor.a * safeOpacity);
+	}
+)";
+
+//two triangles covering the same unit quad as the widget geometry
+static constexpr f32 QUAD_VERTICES[] =
+{
+	-0.5f,  0.5f,   0.5f,  0.5f,   0.5f, -0.5f,
+	 0.5f, -0.5f,  -0.5f, -0.5f,  -0.5f,  0.5f
+};
+
+//the instance buffer never shrinks and grows in steps of at least this many quads
+constexpr size_t MIN_INSTANCE_CAPACITY = 256;
+
+struct BatchTarget
+{
+	u32 VAO{};
+	u32 quadVBO{};
+	u32 instanceVBO{};
+	size_t capacityBytes{};
+
+	OpenGL_Shader* shader{};
+};
+
+static unordered_map<u32, BatchTarget> targets{};
+
+//instancing is core in 3.3 but not part of the KalaWindow function table
+static PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstancedProc{};
+static PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc{};
+
+static bool LoadInstancingFunctions();
+static void SetInstanceAttributes(u32 firstInstance);
+
+namespace Solin::Graphics
+{
+	bool BatchRenderer::Initialize(u32 windowID)
+	{
+		if (targets.contains(windowID)) return true;
+
+		if (!LoadInstancingFunctions())
+		{
+			Log::Print(
+				"Instanced drawing is not available, widgets will be drawn one by one.",
+				"BATCH",
+				LogType::LOG_WARNING);
+
+			return false;
+		}
+
+		OpenGL_Shader* shader = OpenGL_Shader::CreateShader(
+			windowID,
+			"batch_quad",
+			{ {
+				{.shaderData = string(shader_batch_vertex), .type = ShaderType::SHADER_VERTEX },
+				{.shaderData = string(shader_batch_fragment), .type = ShaderType::SHADER_FRAGMENT }
+			} });
+
+		if (!shader)
+		{
+			Log::Print(
+				"Failed to create the batch shader, widgets will be drawn one by one.",
+				"BATCH",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		BatchTarget target{};
+		target.shader = shader;
+
+		glGenVertexArrays(1, &target.VAO);
+		glGenBuffers(1, &target.quadVBO);
+		glGenBuffers(1, &target.instanceVBO);
+
+		glBindVertexArray(target.VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, target.quadVBO);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			sizeof(QUAD_VERTICES),
+			QUAD_VERTICES,
+			GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), nullptr);
+
+		target.capacityBytes = MIN_INSTANCE_CAPACITY * sizeof(QuadInstance);
+
+		glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			static_cast<GLsizeiptr>(target.capacityBytes),
+			nullptr,
+			GL_STREAM_DRAW);
+
+		for (u32 location = 1; location <= 5; ++location)
+		{
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisorProc(location, 1);
+		}
+		SetInstanceAttributes(0);
+
+		glBindVertexArray(0);
+
+		targets[windowID] = target;
+
+		return true;
+	}
+
+	bool BatchRenderer::IsAvailable(u32 windowID)
+	{
+		return targets.contains(windowID);
+	}
+
+	void BatchRenderer::Draw(
+		u32 windowID,
+		const QuadBatchBuilder& builder,
+		const mat4& projection)
+	{
+		PROFILE_ZONE("BatchRenderer::Draw");
+
+		auto it = targets.find(windowID);
+		if (it == targets.end()
+			|| builder.GetBatches().empty())
+		{
+			return;
+		}
+
+		BatchTarget& target = it->second;
+		size_t bytes = builder.GetInstanceBytes();
+
+		if (!target.shader->Bind()) return;
+
+		u32 programID = target.shader->GetProgramID();
+		target.shader->SetMat4(programID, "uProjection", projection);
+		target.shader->SetInt(programID, "uTexture0", 0);
+
+		glBindVertexArray(target.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+
+		if (bytes > target.capacityBytes)
+		{
+			target.capacityBytes = max(bytes, target.capacityBytes * 2);
+		}
+
+		//orphaning lets the driver hand out fresh storage instead of
+		//waiting for draws of the previous frame that still read the old data
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			static_cast<GLsizeiptr>(target.capacityBytes),
+			nullptr,
+			GL_STREAM_DRAW);
+		glBufferSubData(
+			GL_ARRAY_BUFFER,
+			0,
+			static_cast<GLsizeiptr>(bytes),
+			builder.GetInstances().data());
+
+		stats.quadCount += static_cast<u32>(builder.GetInstances().size());
+		stats.batchCount += static_cast<u32>(builder.GetBatches().size());
+		stats.uploadedBytes += bytes;
+
+		glActiveTexture(GL_TEXTURE0);
+
+		for (const QuadBatch& batch : builder.GetBatches())
+		{
+			bool useTexture = batch.textureID != 0;
+
+			target.shader->SetBool(programID, "uUseTexture", useTexture);
+			if (useTexture) glBindTexture(GL_TEXTURE_2D, batch.textureID);
+
+			//3.3 has no base instance, so the instance attributes are offset instead
+			SetInstanceAttributes(batch.firstInstance);
+
+			glDrawArraysInstancedProc(
+				GL_TRIANGLES,
+				0,
+				6,
+				static_cast<GLsizei>(batch.instanceCount));
+
+			++stats.drawCalls;
+		}
+
+		glBindVertexArray(0);
+	}
+
+	void BatchRenderer::RemoveWindow(
+		u32 windowID,
+		bool isContextAlive)
+	{
+		auto it = targets.find(windowID);
+		if (it == targets.end()) return;
+
+		BatchTarget& target = it->second;
+
+		if (isContextAlive)
+		{
+			glDeleteBuffers(1, &target.quadVBO);
+			glDeleteBuffers(1, &target.instanceVBO);
+			glDeleteVertexArrays(1, &target.VAO);
+		}
+
+		targets.erase(it);
+	}
+}
+
+bool LoadInstancingFunctions()
+{
+	if (glDrawArraysInstancedProc
+		&& glVertexAttribDivisorProc)
+	{
+		return true;
+	}
+
+#ifdef _WIN32
+	//wglGetProcAddress is looked up the same way as glScissor so opengl32.lib does not need to be linked
+	using WGLGetProcAddress = PROC(WINAPI*)(LPCSTR);
+
+	HMODULE openGLLib = ToVar<HMODULE>(OpenGL_Global::GetOpenGLLibrary());
+	if (!openGLLib) return false;
+
+	WGLGetProcAddress wglGetProc = reinterpret_cast<WGLGetProcAddress>(GetProcAddress(openGLLib, "wglGetProcAddress"));
+	if (!wglGetProc) return false;
+
+	glDrawArraysInstancedProc = reinterpret_cast<PFNGLDRAWARRAYSINSTANCEDPROC>(wglGetProc("glDrawArraysInstanced"));
+	glVertexAttribDivisorProc = reinterpret_cast<PFNGLVERTEXATTRIBDIVISORPROC>(wglGetProc("glVertexAttribDivisor"));
+#endif
+
+	return glDrawArraysInstancedProc
+		&& glVertexAttribDivisorProc;
+}
+
+void SetInstanceAttributes(u32 firstInstance)
+{
+	constexpr GLsizei stride = sizeof(QuadInstance);
+	const size_t base = static_cast<size_t>(firstInstance) * sizeof(QuadInstance);
+
+	auto Offset = [base](size_t member)
+		{
+			return reinterpret_cast<const void*>(base + member);
+		};
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(QuadInstance, pos)));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(QuadInstance, size)));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(QuadInstance, rot)));
+
+	//color and opacity are adjacent and read as one vec4
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(QuadInstance, color)));
+
+	//uvMin and uvMax are adjacent too
+	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(QuadInstance, uvMin)));
+}
\ No newline at end of file
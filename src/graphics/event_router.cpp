@@ -0,0 +1,362 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_map>
+#include <array>
+#include <string>
+
+#include "KalaWindow/include/ui/image.hpp"
+#include "KalaWindow/include/ui/text.hpp"
+
+#include "graphics/event_router.hpp"
+#include "graphics/hit_index.hpp"
+
+using KalaHeaders::vec2;
+
+using KalaWindow::Core::Input;
+using KalaWindow::Core::Key;
+using KalaWindow::Core::MouseButton;
+using KalaWindow::UI::Widget;
+using KalaWindow::UI::Image;
+using KalaWindow::UI::Text;
+
+using Solin::Graphics::EventRouter;
+using Solin::Graphics::EventHandler;
+using Solin::Graphics::RoutedEvent;
+using Solin::Graphics::RoutedEventType;
+using Solin::Graphics::HitIndex;
+
+using std::unordered_map;
+using std::array;
+using std::string;
+using std::move;
+
+constexpr size_t EVENT_COUNT = static_cast<size_t>(RoutedEventType::EVENT_COUNT);
+
+struct WidgetHandlers
+{
+	array<EventHandler, EVENT_COUNT> slots{};
+
+	//generation of the last change to each slot, so a handler that replaced or cleared itself
+	//is not restored while handlers of other slots can still change while it runs
+	array<u32, EVENT_COUNT> versions{};
+};
+
+struct WindowRoute
+{
+	//widgets are tracked by ID so a removed widget is never called through a stale pointer
+	u32 focusID{};
+	u32 captureID{};
+	u32 hoverID{};
+
+	//capture taken by a pressed button, released with that button
+	bool isImplicitCapture{};
+	MouseButton captureButton{};
+
+	vec2 lastCursorPos{};
+	bool hasCursorPos{};
+};
+
+static unordered_map<u32, WidgetHandlers> handlers{};
+static unordered_map<u32, WindowRoute> routes{};
+
+//shared by all widgets, so an entry erased and created again while a handler runs
+//never hands out a version that handler saved
+static u32 handlerGeneration{};
+
+static Widget* FindWidget(u32 widgetID);
+static bool HasHandler(u32 widgetID, RoutedEventType type);
+
+namespace Solin::Graphics
+{
+	void EventRouter::SetHandler(
+		Widget* widget,
+		RoutedEventType type,
+		EventHandler&& handler)
+	{
+		if (!widget
+			|| type == RoutedEventType::EVENT_COUNT)
+		{
+			return;
+		}
+
+		WidgetHandlers& entry = handlers[widget->GetID()];
+		entry.slots[static_cast<size_t>(type)] = move(handler);
+		entry.versions[static_cast<size_t>(type)] = ++handlerGeneration;
+	}
+
+	void EventRouter::ClearHandler(
+		Widget* widget,
+		RoutedEventType type)
+	{
+		if (!widget
+			|| type == RoutedEventType::EVENT_COUNT)
+		{
+			return;
+		}
+
+		auto it = handlers.find(widget->GetID());
+		if (it == handlers.end()) return;
+
+		it->second.slots[static_cast<size_t>(type)].Reset();
+		it->second.versions[static_cast<size_t>(type)] = ++handlerGeneration;
+	}
+
+	void EventRouter::ClearHandlers(Widget* widget)
+	{
+		if (widget) handlers.erase(widget->GetID());
+	}
+
+	void EventRouter::SetFocus(
+		u32 windowID,
+		Widget* widget)
+	{
+		WindowRoute& route = routes[windowID];
+
+		u32 newID = widget ? widget->GetID() : 0;
+		if (route.focusID == newID) return;
+
+		u32 oldID = route.focusID;
+		route.focusID = newID;
+
+		RoutedEvent e{};
+		if (oldID != 0) Send(RoutedEventType::FOCUS_LOST, oldID, e);
+		if (newID != 0) Send(RoutedEventType::FOCUS_GAINED, newID, e);
+	}
+
+	Widget* EventRouter::GetFocus(u32 windowID)
+	{
+		auto it = routes.find(windowID);
+		return it != routes.end()
+			? FindWidget(it->second.focusID)
+			: nullptr;
+	}
+
+	void EventRouter::SetCapture(
+		u32 windowID,
+		Widget* widget)
+	{
+		WindowRoute& route = routes[windowID];
+
+		route.captureID = widget ? widget->GetID() : 0;
+		route.isImplicitCapture = false;
+	}
+
+	Widget* EventRouter::GetCapture(u32 windowID)
+	{
+		auto it = routes.find(windowID);
+		return it != routes.end()
+			? FindWidget(it->second.captureID)
+			: nullptr;
+	}
+
+	bool EventRouter::Dispatch(
+		u32 windowID,
+		Input* input,
+		vec2 cursorPos)
+	{
+		PROFILE_ZONE("EventRouter::Dispatch");
+
+		if (!input) return false;
+
+		WindowRoute& route = routes[windowID];
+		u32 dispatchedBefore = stats.dispatchedEvents;
+
+		//targets whose widgets were removed since the last dispatch are dropped
+		if (!FindWidget(route.focusID)) route.focusID = 0;
+		if (!FindWidget(route.captureID)) route.captureID = 0;
+		if (!FindWidget(route.hoverID)) route.hoverID = 0;
+
+		RoutedEvent e{};
+		e.cursorPos = cursorPos;
+		e.cursorDelta = route.hasCursorPos
+			? cursorPos - route.lastCursorPos
+			: vec2(0.0f);
+
+		route.lastCursorPos = cursorPos;
+		route.hasCursorPos = true;
+
+		bool hasMoved = e.cursorDelta != vec2(0.0f);
+
+		//one grid lookup per frame, widgets can move under a still cursor
+		Widget* top = HitIndex::GetTopWidget(windowID, cursorPos);
+		u32 topID = top ? top->GetID() : 0;
+		++stats.hitTests;
+
+		if (topID != route.hoverID)
+		{
+			if (route.hoverID != 0) Send(RoutedEventType::MOUSE_LEFT, route.hoverID, e);
+			if (topID != 0) Send(RoutedEventType::MOUSE_ENTERED, topID, e);
+
+			route.hoverID = topID;
+		}
+
+		for (u32 b = static_cast<u32>(MouseButton::Left);
+			b < static_cast<u32>(MouseButton::MouseButtonCount);
+			++b)
+		{
+			MouseButton button = static_cast<MouseButton>(b);
+			e.button = button;
+
+			if (input->IsMouseButtonPressed(button))
+			{
+				if (route.captureID == 0
+					&& topID != 0)
+				{
+					route.captureID = topID;
+					route.isImplicitCapture = true;
+					route.captureButton = button;
+				}
+
+				//clicking moves the focus, clicking empty space clears it
+				if (button == MouseButton::Left) SetFocus(windowID, top);
+
+				Send(RoutedEventType::MOUSE_PRESSED, route.captureID != 0 ? route.captureID : topID, e);
+			}
+
+			if (input->IsMouseButtonHeld(button)
+				&& route.captureID != 0)
+			{
+				Send(RoutedEventType::MOUSE_HELD, route.captureID, e);
+				if (hasMoved) Send(RoutedEventType::MOUSE_DRAGGED, route.captureID, e);
+			}
+
+			if (input->IsMouseButtonReleased(button))
+			{
+				Send(RoutedEventType::MOUSE_RELEASED, route.captureID != 0 ? route.captureID : topID, e);
+
+				if (route.isImplicitCapture
+					&& route.captureButton == button)
+				{
+					route.captureID = 0;
+					route.isImplicitCapture = false;
+				}
+			}
+		}
+		e.button = MouseButton::Unknown;
+
+		f32 scrollDelta = input->GetScrollwheelDelta();
+		if (scrollDelta != 0.0f)
+		{
+			e.scrollDelta = scrollDelta;
+			Send(RoutedEventType::MOUSE_SCROLLED, route.captureID != 0 ? route.captureID : topID, e);
+			e.scrollDelta = 0.0f;
+		}
+
+		//keys are only scanned when the focused widget listens to them
+		u32 focusID = route.focusID;
+		if (focusID != 0
+			&& handlers.contains(focusID))
+		{
+			bool wantsPressed = HasHandler(focusID, RoutedEventType::KEY_PRESSED);
+			bool wantsReleased = HasHandler(focusID, RoutedEventType::KEY_RELEASED);
+			bool wantsHeld = HasHandler(focusID, RoutedEventType::KEY_HELD);
+
+			if (wantsPressed
+				|| wantsReleased
+				|| wantsHeld)
+			{
+				for (u32 k = static_cast<u32>(Key::Unknown) + 1;
+					k < static_cast<u32>(Key::KeyCount);
+					++k)
+				{
+					Key key = static_cast<Key>(k);
+					e.key = key;
+
+					if (wantsPressed
+						&& input->IsKeyPressed(key))
+					{
+						Send(RoutedEventType::KEY_PRESSED, focusID, e);
+					}
+					if (wantsHeld
+						&& input->IsKeyHeld(key))
+					{
+						Send(RoutedEventType::KEY_HELD, focusID, e);
+					}
+					if (wantsReleased
+						&& input->IsKeyReleased(key))
+					{
+						Send(RoutedEventType::KEY_RELEASED, focusID, e);
+					}
+				}
+				e.key = Key::Unknown;
+			}
+
+			const string& typed = input->GetTypedLetter();
+			if (!typed.empty())
+			{
+				e.text = typed;
+				Send(RoutedEventType::TEXT_TYPED, focusID, e);
+			}
+		}
+
+		return stats.dispatchedEvents != dispatchedBefore;
+	}
+
+	void EventRouter::RemoveWindow(u32 windowID)
+	{
+		routes.erase(windowID);
+	}
+
+	bool EventRouter::Send(
+		RoutedEventType type,
+		u32 widgetID,
+		RoutedEvent& e)
+	{
+		auto it = handlers.find(widgetID);
+		if (it == handlers.end()) return false;
+
+		size_t slot = static_cast<size_t>(type);
+		if (!it->second.slots[slot]) return false;
+
+		Widget* widget = FindWidget(widgetID);
+		if (!widget)
+		{
+			handlers.erase(it);
+			return false;
+		}
+
+		e.type = type;
+		e.target = widget;
+
+		//the handler is moved out while it runs so it can safely set or clear handlers,
+		//including its own, without destroying itself mid-call
+		u32 version = it->second.versions[slot];
+		EventHandler handler = move(it->second.slots[slot]);
+
+		handler(e);
+
+		auto after = handlers.find(widgetID);
+		if (after != handlers.end()
+			&& after->second.versions[slot] == version)
+		{
+			after->second.slots[slot] = move(handler);
+		}
+
+		++stats.dispatchedEvents;
+		if (type <= RoutedEventType::TEXT_TYPED) ++stats.keyEvents;
+		else if (type <= RoutedEventType::MOUSE_LEFT) ++stats.mouseEvents;
+
+		return true;
+	}
+}
+
+Widget* FindWidget(u32 widgetID)
+{
+	if (widgetID == 0) return nullptr;
+
+	//widget IDs are unique across all widget types
+	if (Image* image = Image::registry.GetContent(widgetID)) return image;
+	return Text::registry.GetContent(widgetID);
+}
+
+bool HasHandler(u32 widgetID, RoutedEventType type)
+{
+	auto it = handlers.find(widgetID);
+	return it != handlers.end()
+		&& it->second.slots[static_cast<size_t>(type)];
+}
\ No newline at end of file
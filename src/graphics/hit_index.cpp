@@ -0,0 +1,470 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include "graphics/hit_index.hpp"
+
+using KalaHeaders::vec2;
+using KalaHeaders::radians;
+
+using KalaWindow::Utils::Transform2D;
+using KalaWindow::Utils::PosTarget;
+using KalaWindow::Utils::RotTarget;
+using KalaWindow::Utils::SizeTarget;
+using KalaWindow::UI::Widget;
+using KalaWindow::UI::Image;
+using KalaWindow::UI::Text;
+
+using Solin::Graphics::HitIndex;
+
+using std::unordered_map;
+using std::vector;
+using std::array;
+using std::sort;
+using std::floor;
+using std::ceil;
+using std::min;
+using std::max;
+using std::clamp;
+using std::sin;
+using std::cos;
+
+//Widgets are stored by ID and resolved through their registry on every query,
+//events are routed before the next sync so a widget may be gone by then
+struct HitEntry
+{
+	u32 widgetID{};
+	bool isText{};
+
+	vec2 min{};
+	vec2 max{};
+
+	//inputs of the bounds above, they are only computed again when one of these changed
+	vec2 pos{};
+	f32 rot{};
+	vec2 size{};
+	vec2 localMin{};
+	vec2 localMax{};
+
+	//inclusive cell range the entry is stored in
+	u32 cellMinX{};
+	u32 cellMinY{};
+	u32 cellMaxX{};
+	u32 cellMaxY{};
+
+	//sync pass this entry was last seen in, unseen entries belong to removed widgets
+	u64 lastSeenSync{};
+
+	//last query that reported this entry, avoids duplicates from multi cell entries
+	u64 queryStamp{};
+};
+
+struct WindowGrid
+{
+	vec2 viewportSize{};
+	u32 columns{};
+	u32 rows{};
+
+	vector<vector<u32>> cells{};
+
+	vector<HitEntry> entries{};
+	vector<u32> freeEntries{};
+	unordered_map<u32, u32> entryIndex{};
+
+	u64 syncIndex{};
+	u64 queryIndex{};
+};
+
+static unordered_map<u32, WindowGrid> grids{};
+
+static u32 ToCell(f32 value, u32 count);
+static void InsertEntry(WindowGrid& grid, u32 index);
+static void EraseEntry(WindowGrid& grid, u32 index);
+static bool Contains(const HitEntry& entry, vec2 point);
+//Bounds of the vertices of the widget before its transform is applied
+static void GetLocalBounds(
+	const Widget* widget,
+	vec2& outMin,
+	vec2& outMax);
+//Computes the window space bounds of the entry from its cached transform and local bounds,
+//rotated the same way createumodel rotates the vertices
+static void UpdateBounds(HitEntry& entry);
+//Returns the widget of the entry or nullptr if it was removed since the last sync
+static void GetLocalBounds(
+	const Widget* widget,
+	vec2& outMin,
+	vec2& outMax)
+{
+	const vector<vec2>& vertices = widget->GetVertices();
+
+	//widgets without geometry still hit test as the unit quad
+	if (vertices.empty())
+	{
+		outMin = vec2(-0.5f);
+		outMax = vec2(0.5f);
+		return;
+	}
+
+	outMin = vertices[0];
+	outMax = vertices[0];
+	for (const vec2& v : vertices)
+	{
+		outMin = vec2(min(outMin.x, v.x), min(outMin.y, v.y));
+		outMax = vec2(max(outMax.x, v.x), max(outMax.y, v.y));
+	}
+}
+
+void UpdateBounds(HitEntry& entry)
+{
+	f32 rads = radians(entry.rot);
+	f32 c = cos(rads);
+	f32 s = sin(rads);
+
+	const array<vec2, 4> corners =
+	{
+		vec2(entry.localMin.x, entry.localMin.y),
+		vec2(entry.localMax.x, entry.localMin.y),
+		vec2(entry.localMax.x, entry.localMax.y),
+		vec2(entry.localMin.x, entry.localMax.y)
+	};
+
+	for (size_t i = 0; i < corners.size(); ++i)
+	{
+		vec2 local = vec2(corners[i].x * entry.size.x, corners[i].y * entry.size.y);
+		vec2 world = entry.pos + vec2(
+			c * local.x + s * local.y,
+			-s * local.x + c * local.y);
+
+		entry.min = i == 0 ? world : vec2(min(entry.min.x, world.x), min(entry.min.y, world.y));
+		entry.max = i == 0 ? world : vec2(max(entry.max.x, world.x), max(entry.max.y, world.y));
+	}
+}
+
+Widget* Resolve(const HitEntry& entry);
+
+namespace Solin::Graphics
+{
+	void HitIndex::Sync(
+		u32 windowID,
+		vec2 viewportSize,
+		span<Image* const> images,
+		span<Text* const> texts)
+	{
+		PROFILE_ZONE("HitIndex::Sync");
+
+		WindowGrid& grid = grids[windowID];
+
+		if (grid.viewportSize != viewportSize)
+		{
+			grid.viewportSize = viewportSize;
+			grid.columns = static_cast<u32>(ceil(max(viewportSize.x, 1.0f) / CELL_SIZE));
+			grid.rows = static_cast<u32>(ceil(max(viewportSize.y, 1.0f) / CELL_SIZE));
+
+			grid.cells.assign(grid.columns * grid.rows, {});
+			grid.entries.clear();
+			grid.freeEntries.clear();
+			grid.entryIndex.clear();
+		}
+
+		++grid.syncIndex;
+
+		auto Track = [&grid](Widget* widget, bool isText)
+			{
+				Transform2D* transform = widget->GetTransform();
+				if (!transform) return;
+
+				//Widget::GetAABB ignores the vertices and shifts the box by a fixed offset,
+				//so the bounds are computed here from the combined transform and the vertices
+				vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
+				f32 rot = transform->GetRot(RotTarget::ROT_COMBINED);
+				vec2 size = transform->GetSize(SizeTarget::SIZE_COMBINED);
+
+				vec2 localMin{};
+				vec2 localMax{};
+				GetLocalBounds(widget, localMin, localMax);
+
+				auto it = grid.entryIndex.find(widget->GetID());
+				if (it != grid.entryIndex.end())
+				{
+					HitEntry& entry = grid.entries[it->second];
+					entry.lastSeenSync = grid.syncIndex;
+
+					if (entry.pos == pos
+						&& entry.rot == rot
+						&& entry.size == size
+						&& entry.localMin == localMin
+						&& entry.localMax == localMax)
+					{
+						return;
+					}
+
+					EraseEntry(grid, it->second);
+					entry.pos = pos;
+					entry.rot = rot;
+					entry.size = size;
+					entry.localMin = localMin;
+					entry.localMax = localMax;
+					UpdateBounds(entry);
+					InsertEntry(grid, it->second);
+
+					return;
+				}
+
+				u32 index{};
+				if (!grid.freeEntries.empty())
+				{
+					index = grid.freeEntries.back();
+					grid.freeEntries.pop_back();
+				}
+				else
+				{
+					index = static_cast<u32>(grid.entries.size());
+					grid.entries.push_back({});
+				}
+
+				grid.entries[index] =
+				{
+					.widgetID = widget->GetID(),
+					.isText = isText,
+					.pos = pos,
+					.rot = rot,
+					.size = size,
+					.localMin = localMin,
+					.localMax = localMax,
+					.lastSeenSync = grid.syncIndex
+				};
+				grid.entryIndex[widget->GetID()] = index;
+
+				UpdateBounds(grid.entries[index]);
+				InsertEntry(grid, index);
+			};
+
+		for (Image* image : images)
+		{
+			if (image) Track(image, false);
+		}
+		for (Text* text : texts)
+		{
+			if (text) Track(text, true);
+		}
+
+		//widgets that were removed since the last sync
+		for (u32 i = 0; i < grid.entries.size(); ++i)
+		{
+			HitEntry& entry = grid.entries[i];
+			if (entry.widgetID == 0
+				|| entry.lastSeenSync == grid.syncIndex)
+			{
+				continue;
+			}
+
+			EraseEntry(grid, i);
+			grid.entryIndex.erase(entry.widgetID);
+
+			entry = {};
+			grid.freeEntries.push_back(i);
+		}
+	}
+
+	void HitIndex::HitTest(
+		u32 windowID,
+		vec2 point,
+		vector<Widget*>& out)
+	{
+		PROFILE_ZONE("HitIndex::HitTest");
+
+		out.clear();
+
+		auto it = grids.find(windowID);
+		if (it == grids.end()
+			|| it->second.cells.empty())
+		{
+			return;
+		}
+
+		WindowGrid& grid = it->second;
+
+		u32 cell = ToCell(point.y, grid.rows) * grid.columns + ToCell(point.x, grid.columns);
+		for (u32 index : grid.cells[cell])
+		{
+			const HitEntry& entry = grid.entries[index];
+			if (!Contains(entry, point)) continue;
+
+			Widget* widget = Resolve(entry);
+			if (widget
+				&& widget->IsInteractable())
+			{
+				out.push_back(widget);
+			}
+		}
+
+		sort(
+			out.begin(),
+			out.end(),
+			[](const Widget* a, const Widget* b)
+			{
+				return a->GetZOrder() > b->GetZOrder();
+			});
+	}
+
+	Widget* HitIndex::GetTopWidget(
+		u32 windowID,
+		vec2 point)
+	{
+		auto it = grids.find(windowID);
+		if (it == grids.end()
+			|| it->second.cells.empty())
+		{
+			return nullptr;
+		}
+
+		WindowGrid& grid = it->second;
+
+		Widget* top{};
+
+		u32 cell = ToCell(point.y, grid.rows) * grid.columns + ToCell(point.x, grid.columns);
+		for (u32 index : grid.cells[cell])
+		{
+			const HitEntry& entry = grid.entries[index];
+			if (!Contains(entry, point)) continue;
+
+			Widget* widget = Resolve(entry);
+			if (!widget
+				|| !widget->IsInteractable())
+			{
+				continue;
+			}
+
+			if (!top
+				|| widget->GetZOrder() > top->GetZOrder())
+			{
+				top = widget;
+			}
+		}
+
+		return top;
+	}
+
+	void HitIndex::QueryRect(
+		u32 windowID,
+		vec2 min,
+		vec2 max,
+		vector<Widget*>& out)
+	{
+		PROFILE_ZONE("HitIndex::QueryRect");
+
+		out.clear();
+
+		auto it = grids.find(windowID);
+		if (it == grids.end()
+			|| it->second.cells.empty())
+		{
+			return;
+		}
+
+		WindowGrid& grid = it->second;
+		u64 stamp = ++grid.queryIndex;
+
+		u32 minX = ToCell(min.x, grid.columns);
+		u32 minY = ToCell(min.y, grid.rows);
+		u32 maxX = ToCell(max.x, grid.columns);
+		u32 maxY = ToCell(max.y, grid.rows);
+
+		for (u32 y = minY; y <= maxY; ++y)
+		{
+			for (u32 x = minX; x <= maxX; ++x)
+			{
+				for (u32 index : grid.cells[y * grid.columns + x])
+				{
+					HitEntry& entry = grid.entries[index];
+					if (entry.queryStamp == stamp) continue;
+					entry.queryStamp = stamp;
+
+					if (entry.min.x <= max.x
+						&& entry.max.x >= min.x
+						&& entry.min.y <= max.y
+						&& entry.max.y >= min.y)
+					{
+						if (Widget* widget = Resolve(entry)) out.push_back(widget);
+					}
+				}
+			}
+		}
+	}
+
+	void HitIndex::RemoveWindow(u32 windowID)
+	{
+		grids.erase(windowID);
+	}
+}
+
+u32 ToCell(f32 value, u32 count)
+{
+	//anything outside of the viewport lands in the border cells
+	f32 cell = floor(value / HitIndex::CELL_SIZE);
+	return static_cast<u32>(clamp(cell, 0.0f, static_cast<f32>(count - 1)));
+}
+
+void InsertEntry(WindowGrid& grid, u32 index)
+{
+	HitEntry& entry = grid.entries[index];
+
+	entry.cellMinX = ToCell(entry.min.x, grid.columns);
+	entry.cellMinY = ToCell(entry.min.y, grid.rows);
+	entry.cellMaxX = ToCell(entry.max.x, grid.columns);
+	entry.cellMaxY = ToCell(entry.max.y, grid.rows);
+
+	for (u32 y = entry.cellMinY; y <= entry.cellMaxY; ++y)
+	{
+		for (u32 x = entry.cellMinX; x <= entry.cellMaxX; ++x)
+		{
+			grid.cells[y * grid.columns + x].push_back(index);
+		}
+	}
+}
+
+void EraseEntry(WindowGrid& grid, u32 index)
+{
+	const HitEntry& entry = grid.entries[index];
+
+	for (u32 y = entry.cellMinY; y <= entry.cellMaxY; ++y)
+	{
+		for (u32 x = entry.cellMinX; x <= entry.cellMaxX; ++x)
+		{
+			vector<u32>& cell = grid.cells[y * grid.columns + x];
+
+			//cell order does not matter, so the last index takes the freed spot
+			for (size_t i = 0; i < cell.size(); ++i)
+			{
+				if (cell[i] == index)
+				{
+					cell[i] = cell.back();
+					cell.pop_back();
+					break;
+				}
+			}
+		}
+	}
+}
+
+bool Contains(const HitEntry& entry, vec2 point)
+{
+	return point.x >= entry.min.x
+		&& point.x <= entry.max.x
+		&& point.y >= entry.min.y
+		&& point.y <= entry.max.y;
+}
+
+Widget* Resolve(const HitEntry& entry)
+{
+	return entry.isText
+		? static_cast<Widget*>(Text::registry.GetContent(entry.widgetID))
+		: static_cast<Widget*>(Image::registry.GetContent(entry.widgetID));
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include "graphics/batch.hpp"
+
+using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+
+using std::stable_sort;
+using std::less;
+
+namespace Solin::Graphics
+{
+	void QuadBatchBuilder::Clear()
+	{
+		entries.clear();
+		sortedIndices.clear();
+		instances.clear();
+		batches.clear();
+	}
+
+	void QuadBatchBuilder::Add(
+		u16 zOrder,
+		const OpenGL_Shader* shader,
+		u32 textureID,
+		const QuadInstance& instance)
+	{
+		entries.push_back(
+		{
+			.zOrder = zOrder,
+			.shader = shader,
+			.textureID = textureID,
+			.instance = instance
+		});
+	}
+
+	void QuadBatchBuilder::Build()
+	{
+		PROFILE_ZONE("QuadBatchBuilder::Build");
+
+		sortedIndices.resize(entries.size());
+		for (u32 i = 0; i < sortedIndices.size(); ++i) sortedIndices[i] = i;
+
+		stable_sort(
+			sortedIndices.begin(),
+			sortedIndices.end(),
+			[this](u32 a, u32 b)
+			{
+				const QuadEntry& ea = entries[a];
+				const QuadEntry& eb = entries[b];
+
+				if (ea.zOrder != eb.zOrder) return ea.zOrder < eb.zOrder;
+				if (ea.shader != eb.shader) return less<const OpenGL_Shader*>{}(ea.shader, eb.shader);
+				return ea.textureID < eb.textureID;
+			});
+
+		instances.clear();
+		batches.clear();
+		instances.reserve(entries.size());
+
+		for (u32 index : sortedIndices)
+		{
+			const QuadEntry& e = entries[index];
+
+			//Z order only decides the sort, neighbours with different Z can still share a draw
+			if (batches.empty()
+				|| batches.back().shader != e.shader
+				|| batches.back().textureID != e.textureID)
+			{
+				batches.push_back(
+				{
+					.shader = e.shader,
+					.textureID = e.textureID,
+					.firstInstance = static_cast<u32>(instances.size())
+				});
+			}
+
+			instances.push_back(e.instance);
+			++batches.back().instanceCount;
+		}
+	}
+}
\ No newline at end of file
@@ -3,10 +3,26 @@
 //This is free software, and you are welcome to redistribute it under certain conditions.
 //Read LICENSE.md for more information.
 
+#include "core/profiler.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
 #include <string>
 #include <vector>
+#include <span>
 #include <filesystem>
 #include <sstream>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
 
 #include "KalaHeaders/log_utils.hpp"
 #include "KalaHeaders/math_utils.hpp"
@@ -28,7 +44,16 @@
 #include "KalaWindow/include/ui/text.hpp"
 #include "KalaWindow/include/utils/transform2d.hpp"
 
+#include "core/scheduler.hpp"
 #include "graphics/render.hpp"
+#include "graphics/scene.hpp"
+#include "graphics/batch.hpp"
+#include "graphics/hit_index.hpp"
+#include "graphics/atlas.hpp"
+#include "graphics/virtual_list.hpp"
+#include "graphics/event_router.hpp"
+#include "graphics/text_run.hpp"
+#include "graphics/window_content.hpp"
 
 using KalaHeaders::Log;
 using KalaHeaders::LogType;
@@ -36,9 +61,11 @@ using KalaHeaders::vec2;
 using KalaHeaders::vec3;
 using KalaHeaders::mat4;
 using KalaHeaders::ortho;
+using KalaHeaders::radians;
 
 using KalaWindow::Core::KalaWindowCore;
 using KalaWindow::Core::Input;
+using KalaWindow::Core::Key;
 using KalaWindow::Utils::Registry;
 using KalaWindow::Graphics::Window_Global;
 using KalaWindow::Graphics::Window;
@@ -57,6 +84,7 @@ using KalaWindow::Graphics::OpenGL::Shader::shader_quad_fragment;
 using KalaWindow::Graphics::OpenGL::Shader::shader_text_vertex;
 using KalaWindow::Graphics::OpenGL::Shader::shader_text_fragment;
 using namespace KalaWindow::Graphics::OpenGLFunctions;
+using KalaWindow::UI::Widget;
 using KalaWindow::UI::Image;
 using KalaWindow::UI::Font;
 using KalaWindow::UI::Text;
@@ -65,14 +93,87 @@ using KalaWindow::Utils::PosTarget;
 using KalaWindow::Utils::RotTarget;
 using KalaWindow::Utils::SizeTarget;
 
+using Solin::Core::FrameScheduler;
+using Solin::Core::Profiler;
+using Solin::Graphics::RetainedScene;
+using Solin::Graphics::FrameDamage;
+using Solin::Graphics::DamageRect;
+using Solin::Graphics::QuadBatchBuilder;
+using Solin::Graphics::QuadInstance;
+using Solin::Graphics::BatchRenderer;
+using Solin::Graphics::HitIndex;
+using Solin::Graphics::TextureAtlas;
+using Solin::Graphics::AtlasRegion;
+using Solin::Graphics::VirtualList;
+using Solin::Graphics::EventRouter;
+using Solin::Graphics::TextRunRenderer;
+using Solin::Graphics::LineLayoutCache;
+using Solin::Graphics::LayoutCacheStats;
+using Solin::Graphics::WindowContent;
+
 using std::string;
 using std::vector;
+using std::span;
+using std::unordered_map;
+using std::to_string;
+using std::stable_sort;
+using std::floor;
+using std::ceil;
 using std::filesystem::path;
 using std::filesystem::current_path;
 using std::ostringstream;
 
-static void Redraw(Window* window);
+//Returns true if a frame was drawn and swapped
+static bool Redraw(Window* window);
 static void Resize(Window* window);
+static void DrawWidgets(
+	u32 windowID,
+	span<Image* const> images,
+	span<Text* const> text,
+	const mat4& projection,
+	const DamageRect* damageRect);
+#ifdef _DEBUG
+static void DumpTrace();
+#endif
+
+//Returns the retained framebuffer of the window, resized to size,
+//or 0 if framebuffer objects could not be loaded.
+//isRecreated is true when the previous contents were lost
+static GLuint GetRetainedTarget(
+	u32 windowID,
+	vec2 size,
+	bool& isRecreated);
+static void ReleaseRetainedTarget(
+	u32 windowID,
+	bool isContextAlive);
+
+//Drops every piece of per-window state Solin keeps for the window,
+//isContextAlive is false if the window and its context were already destroyed
+static void ReleaseWindow(
+	u32 windowID,
+	bool isContextAlive);
+
+//Makes the next WindowContent lookup of every content type Solin draws group the registries again
+static void InvalidateWindowContent();
+
+//Returns true if the widget still uses the stock unit quad the batch shader draws,
+//widgets given custom geometry through SetVertices must render on their own
+static void InvalidateWindowContent()
+{
+	WindowContent<Input>::Invalidate();
+	WindowContent<OpenGL_Context>::Invalidate();
+	WindowContent<Image>::Invalidate();
+	WindowContent<Text>::Invalidate();
+}
+
+bool HasDefaultQuad(const Widget* widget);
+
+//Copies the widgets into out in draw order, lowest z-order first.
+//Stable, so widgets on the same z-order keep their creation order
+template<typename T>
+static void SortByZOrder(
+	span<T* const> widgets,
+	vector<T*>& out);
 
 static Window* CreateNewWindow(
 	const string& name,
@@ -83,6 +184,44 @@ constexpr vec3 NORMALIZED_BACKGROUND_COLOR = vec3(0.29f, 0.36f, 0.85f);
 
 constexpr vec2 BASE_SIZE = vec2(1280.0f, 720.0f);
 
+//glScissor is not part of the KalaWindow function table,
+//partial redraws fall back to full redraws if it could not be loaded
+static PFNGLSCISSORPROC glScissorProc{};
+
+//not part of the KalaWindow function table either,
+//partial redraws fall back to full redraws without them
+static PFNGLBLITFRAMEBUFFERPROC glBlitFramebufferProc{};
+static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffersProc{};
+static PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffersProc{};
+
+//Offscreen copy of the last frame of a window. Damage is drawn into it and the whole
+//target is blitted to the back buffer, so partial redraws never depend on
+//how many back buffers the swap chain has or what they still hold
+struct RetainedTarget
+{
+	GLuint framebuffer{};
+	GLuint colorBuffer{};
+	GLuint depthBuffer{};
+	vec2 size{};
+};
+
+static unordered_map<u32, RetainedTarget> retainedTargets{};
+
+//damage recorded for frames that had to be redrawn entirely
+static const FrameDamage FULL_FRAME_DAMAGE{ .isEmpty = false, .isFull = true };
+
+//images drawn with this shader are batched, all others render one by one
+static const OpenGL_Shader* batchableShader{};
+static QuadBatchBuilder quadBatch{};
+
+//widgets of the window being redrawn in draw order, reused across frames
+static vector<Image*> sortedImages{};
+static vector<Text*> sortedText{};
+
+//windows created through CreateNewWindow, KalaWindow closes and destroys windows on its own
+//so the ones missing from its registry are released after each message pump
+static vector<u32> trackedWindows{};
+
 namespace Solin::Graphics
 {
 	void Render::Initialize()
@@ -94,7 +233,7 @@ namespace Solin::Graphics
 
 		u32 windowID = window->GetID();
 
-		auto contexts = OpenGL_Context::registry.GetAllWindowContent(windowID);
+		auto contexts = WindowContent<OpenGL_Context>::Get(windowID);
 		OpenGL_Context* context = contexts.empty() ? nullptr : contexts.front();
 
 		if (!context)
@@ -108,6 +247,24 @@ namespace Solin::Graphics
 
 		context->MakeContextCurrent();
 
+#ifdef _WIN32
+		//core 1.1 functions are exported by opengl32.dll itself, not by wglGetProcAddress
+		HMODULE openGLLib = ToVar<HMODULE>(OpenGL_Global::GetOpenGLLibrary());
+		if (openGLLib)
+		{
+			glScissorProc = reinterpret_cast<PFNGLSCISSORPROC>(GetProcAddress(openGLLib, "glScissor"));
+
+			using WGLGetProcAddress = PROC(WINAPI*)(LPCSTR);
+			WGLGetProcAddress wglGetProc = reinterpret_cast<WGLGetProcAddress>(GetProcAddress(openGLLib, "wglGetProcAddress"));
+			if (wglGetProc)
+			{
+				glBlitFramebufferProc = reinterpret_cast<PFNGLBLITFRAMEBUFFERPROC>(wglGetProc("glBlitFramebuffer"));
+				glDeleteFramebuffersProc = reinterpret_cast<PFNGLDELETEFRAMEBUFFERSPROC>(wglGetProc("glDeleteFramebuffers"));
+				glDeleteRenderbuffersProc = reinterpret_cast<PFNGLDELETERENDERBUFFERSPROC>(wglGetProc("glDeleteRenderbuffers"));
+			}
+		}
+#endif
+
 		glEnable(GL_FRAMEBUFFER_SRGB);
 		glEnable(GL_DEPTH_TEST);
 		glEnable(GL_CULL_FACE);
@@ -136,6 +293,10 @@ namespace Solin::Graphics
 				{.shaderData = string(shader_quad_vertex), .type = ShaderType::SHADER_VERTEX },
 				{.shaderData = string(shader_quad_fragment), .type = ShaderType::SHADER_FRAGMENT }
 			} });
+
+		batchableShader = shader01;
+		BatchRenderer::Initialize(windowID);
+		TextRunRenderer::Initialize(windowID);
 			
 		OpenGL_Shader* shader02 = OpenGL_Shader::CreateShader(
 			windowID,
@@ -173,87 +334,536 @@ namespace Solin::Graphics
 			shader01);
 	}
 	
-	void Render::Update()
+	bool Render::Update()
 	{
+		PROFILE_ZONE("Render::Update");
+
+		BatchRenderer::ResetStats();
+		TextRunRenderer::ResetStats();
+		LineLayoutCache::ResetCounters();
+		EventRouter::ResetStats();
+
+		//the pump can call the redraw callback, which must not see spans grouped before
+		//content was replaced last frame, a replace keeps the registry size the same
+		InvalidateWindowContent();
+
 		for (const auto& window : Window::registry.runtimeContent)
 		{
 			if (!window) continue;
-			
+
+			PROFILE_ZONE("Window::Update");
 			window->Update();
+		}
+
+		for (size_t i = trackedWindows.size(); i-- > 0;)
+		{
+			u32 windowID = trackedWindows[i];
+			if (Window::registry.GetContent(windowID)) continue;
+
+			ReleaseWindow(windowID, false);
+
+			trackedWindows[i] = trackedWindows.back();
+			trackedWindows.pop_back();
+		}
+
+		//grouped again after window callbacks had the chance to add or remove content
+		InvalidateWindowContent();
+
+		//routed before the redraw check so handlers that request a redraw are drawn this frame
+		for (const auto& window : Window::registry.runtimeContent)
+		{
+			if (!window) continue;
+
 			u32 windowID = window->GetID();
 
-			const vector<Input*>& inputs = Input::registry.GetAllWindowContent(windowID);
+			span<Input* const> inputs = WindowContent<Input>::Get(windowID);
 			Input* input = inputs.empty() ? nullptr : inputs.front();
 
-			if (!window->IsIdle()
+			if (!input) continue;
+
+			//window coordinates have a top-left origin, widgets a bottom-left one
+			vec2 mousePos = input->GetMousePosition();
+			vec2 cursorPos = vec2(mousePos.x, window->GetClientRectSize().y - mousePos.y);
+
+			if (EventRouter::Dispatch(windowID, input, cursorPos)) FrameScheduler::RequestRedraw();
+		}
+
+		//checked after all window messages were pumped
+		//so that callbacks fired during the pump are included
+		bool shouldRedraw = FrameScheduler::ConsumeRedraw();
+		bool didRedraw{};
+
+		for (const auto& window : Window::registry.runtimeContent)
+		{
+			if (!window) continue;
+			
+			u32 windowID = window->GetID();
+
+			span<Input* const> inputs = WindowContent<Input>::Get(windowID);
+			Input* input = inputs.empty() ? nullptr : inputs.front();
+
+			if (shouldRedraw
+				&& !window->IsIdle()
 				&& !window->IsResizing())
 			{
-				Redraw(window);
+				if (Redraw(window)) didRedraw = true;
 			}
 
+#ifdef _DEBUG
+			if (input
+				&& input->IsKeyPressed(Key::F12))
+			{
+				DumpTrace();
+			}
+#endif
+
 			if (input) input->EndFrameUpdate();
 		}
+
+		const auto& routerStats = EventRouter::GetStats();
+		Profiler::RecordCounter("Routed events", static_cast<f64>(routerStats.dispatchedEvents));
+		Profiler::RecordCounter("Routed key events", static_cast<f64>(routerStats.keyEvents));
+		Profiler::RecordCounter("Routed mouse events", static_cast<f64>(routerStats.mouseEvents));
+
+		//runs lay out when their text is set, so the cache is counted on frames without a redraw too
+		const LayoutCacheStats& layoutStats = LineLayoutCache::GetStats();
+		Profiler::RecordCounter("Layout cache hits", static_cast<f64>(layoutStats.hits));
+		Profiler::RecordCounter("Layout cache misses", static_cast<f64>(layoutStats.misses));
+		Profiler::RecordCounter("Layout cache bytes", static_cast<f64>(layoutStats.usedBytes));
+
+		if (didRedraw)
+		{
+			const auto& batchStats = BatchRenderer::GetStats();
+			Profiler::RecordCounter("Batched quads", static_cast<f64>(batchStats.quadCount));
+			Profiler::RecordCounter("Batch draw calls", static_cast<f64>(batchStats.drawCalls));
+			Profiler::RecordCounter("Batch upload bytes", static_cast<f64>(batchStats.uploadedBytes));
+
+			const auto& runStats = TextRunRenderer::GetStats();
+			Profiler::RecordCounter("Text run glyphs", static_cast<f64>(runStats.glyphCount));
+			Profiler::RecordCounter("Text run draw calls", static_cast<f64>(runStats.drawCalls));
+			Profiler::RecordCounter("Text run upload bytes", static_cast<f64>(runStats.uploadedBytes));
+			Profiler::RecordCounter("Text run uniform calls avoided", static_cast<f64>(runStats.uniformCallsAvoided));
+		}
+
+		return didRedraw;
 	}
 }
 
-void Redraw(Window* window)
+bool Redraw(Window* window)
 {
-	if (!window) return;
+	PROFILE_ZONE("Redraw");
 
-	u32 windowID = window->GetID();
+	if (!window) return false;
 
-	mat4 projection = ortho(window->GetFramebufferSize());
+	u32 windowID = window->GetID();
+	vec2 framebufferSize = window->GetFramebufferSize();
 
-	const vector<OpenGL_Context*>& contexts = OpenGL_Context::registry.GetAllWindowContent(windowID);
+	span<OpenGL_Context* const> contexts = WindowContent<OpenGL_Context>::Get(windowID);
 	OpenGL_Context* context = contexts.empty() ? nullptr : contexts.front();
 
-	if (!context) return;
-	
+	if (!context) return false;
+
+	span<Image* const> images = WindowContent<Image>::Get(windowID);
+	span<Text* const> text = WindowContent<Text>::Get(windowID);
+
+	//layout only depends on the viewport, so it is skipped while nothing is resized or added
+	if (RetainedScene::UpdateLayout(
+		windowID,
+		framebufferSize,
+		images.size() + text.size()))
+	{
+		vec2 clientRectSize = window->GetClientRectSize();
+
+		for (Image* image : images)
+		{
+			//rows of virtual lists are placed by their list
+			if (image
+				&& !VirtualList::IsPooledWidget(image))
+			{
+				image->MoveWidget(clientRectSize, vec2(1.0f, 1.0f));
+			}
+		}
+		for (Text* t : text)
+		{
+			if (t) t->MoveWidget(clientRectSize, vec2(0.5f, 0.5f));
+		}
+	}
+
+	const FrameDamage& damage = RetainedScene::CollectDamage(
+		windowID,
+		images,
+		text);
+
+	//nothing changed since the last swap, the front buffer is still valid
+	if (damage.isEmpty)
+	{
+		RetainedScene::RecordFrame(damage);
+		return false;
+	}
+
+	//only widgets whose transform changed are moved in the grid
+	HitIndex::Sync(
+		windowID,
+		framebufferSize,
+		images,
+		text);
+
+	//registry order is not draw order once content is removed
+	SortByZOrder(images, sortedImages);
+	SortByZOrder(text, sortedText);
+
+	mat4 projection = ortho(framebufferSize);
+
 	context->MakeContextCurrent();
 
+	bool isRecreated{};
+	GLuint target = GetRetainedTarget(
+		windowID,
+		framebufferSize,
+		isRecreated);
+
+	//without a retained copy of the last frame the back buffer content is unknown
+	bool isFull = damage.isFull
+		|| isRecreated
+		|| target == 0
+		|| !glScissorProc;
+
+	RetainedScene::RecordFrame(isFull ? FULL_FRAME_DAMAGE : damage);
+
+	if (target != 0) glBindFramebuffer(GL_FRAMEBUFFER, target);
+
 	glClearColor(
 		NORMALIZED_BACKGROUND_COLOR.x,
 		NORMALIZED_BACKGROUND_COLOR.y,
 		NORMALIZED_BACKGROUND_COLOR.z,
 		1.0f);
+
+	if (isFull)
+	{
+		DrawWidgets(
+			windowID,
+			sortedImages,
+			sortedText,
+			projection,
+			nullptr);
+	}
+	else
+	{
+		glEnable(GL_SCISSOR_TEST);
+		for (const auto& rect : damage.rects)
+		{
+			//outward to whole pixels, so a rect at a fractional position keeps its far edge
+			GLint left = static_cast<GLint>(floor(rect.min.x));
+			GLint bottom = static_cast<GLint>(floor(rect.min.y));
+			GLint right = static_cast<GLint>(ceil(rect.max.x));
+			GLint top = static_cast<GLint>(ceil(rect.max.y));
+
+			glScissorProc(
+				left,
+				bottom,
+				right - left,
+				top - bottom);
+
+			DrawWidgets(
+				windowID,
+				sortedImages,
+				sortedText,
+				projection,
+				&rect);
+		}
+		glDisable(GL_SCISSOR_TEST);
+	}
+
+	Profiler::RecordCounter("Images", static_cast<f64>(images.size()));
+	Profiler::RecordCounter("Text", static_cast<f64>(text.size()));
+	Profiler::RecordCounter("Damage rects", static_cast<f64>(isFull ? 0 : damage.rects.size()));
+
+	if (target != 0)
+	{
+		PROFILE_ZONE("BlitRetainedTarget");
+
+		GLint width = static_cast<GLint>(framebufferSize.x);
+		GLint height = static_cast<GLint>(framebufferSize.y);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebufferProc(
+			0, 0, width, height,
+			0, 0, width, height,
+			GL_COLOR_BUFFER_BIT,
+			GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	{
+		PROFILE_ZONE("SwapOpenGLBuffers");
+		context->SwapOpenGLBuffers();
+	}
+
+	return true;
+}
+
+void DrawWidgets(
+	u32 windowID,
+	span<Image* const> images,
+	span<Text* const> text,
+	const mat4& projection,
+	const DamageRect* damageRect)
+{
 	glClear(
 		GL_COLOR_BUFFER_BIT
 		| GL_DEPTH_BUFFER_BIT);
 
+	bool canBatch = BatchRenderer::IsAvailable(windowID);
+	quadBatch.Clear();
+	bool hasQueuedQuads{};
+
+	//queued quads are drawn before anything that renders on its own,
+	//otherwise a widget above them in z-order would end up below them
+	auto FlushBatch = [&]()
+		{
+			if (!hasQueuedQuads) return;
+
+			quadBatch.Build();
+			BatchRenderer::Draw(windowID, quadBatch, projection);
+			quadBatch.Clear();
+
+			hasQueuedQuads = false;
+		};
+
+	auto DrawWidget = [&](Widget* widget, bool isBatchable)
+		{
+			if (!widget) return;
+
+			//widgets outside of the damage are already correct in the back buffer
+			if (damageRect
+				&& !RetainedScene::IsDamaged(widget, *damageRect))
+			{
+				RetainedScene::RecordWidget(false);
+				return;
+			}
+
+			Transform2D* transform = widget->GetTransform();
+
+			if (!canBatch
+				|| !isBatchable
+				|| !transform
+				|| widget->GetShader() != batchableShader
+				|| !HasDefaultQuad(widget))
+			{
+				FlushBatch();
+
+				widget->Render(projection);
+				RetainedScene::RecordWidget(true);
+				return;
+			}
+
+			//hidden widgets are skipped just like Render does
+			if (!widget->CanUpdate()) return;
+
+			f32 rads = radians(transform->GetRot(RotTarget::ROT_COMBINED));
+
+			QuadInstance instance
+			{
+				.pos = transform->GetPos(PosTarget::POS_COMBINED),
+				.size = transform->GetSize(SizeTarget::SIZE_COMBINED),
+				.rot = vec2(cos(rads), sin(rads)),
+				.color = widget->GetNormalizedColor(),
+				.opacity = widget->GetOpacity()
+			};
+
+			//atlas regions share their page texture, so icons from one page end up in one batch
+			u32 textureID = widget->GetTexture() ? widget->GetTexture()->GetOpenGLID() : 0;
+			if (const AtlasRegion* region = TextureAtlas::GetWidgetRegion(widget))
+			{
+				textureID = region->textureID;
+				instance.uvMin = region->uvMin;
+				instance.uvMax = region->uvMax;
+			}
+
+			quadBatch.Add(
+				widget->GetZOrder(),
+				widget->GetShader(),
+				textureID,
+				instance);
+			hasQueuedQuads = true;
+
+			RetainedScene::RecordWidget(true);
+		};
+
 	glDisable(GL_CULL_FACE);
-	const vector<Image*>& images = Image::registry.GetAllWindowContent(windowID);
-	for (const auto& image : images)
+
+	//images arrive sorted by z-order, so consecutive batchable images share draws
+	for (Image* image : images) DrawWidget(image, true);
+
+	//text stays on top of all images
+	FlushBatch();
+	for (Text* t : text) DrawWidget(t, false);
+
+	//runs share one instanced draw per distinct glyph across all of their lines
+	TextRunRenderer::Draw(windowID, projection);
+	glEnable(GL_CULL_FACE);
+}
+
+void Resize(Window* window)
+{
+	FrameScheduler::RequestRedraw();
+}
+
+#ifdef _DEBUG
+void DumpTrace()
+{
+	path tracePath = current_path() / "solin_trace.json";
+
+	string result = Profiler::WriteChromeTrace(tracePath);
+
+	if (!result.empty())
 	{
-		if (image)
-		{
-			image->MoveWidget(
-				window->GetClientRectSize(),
-				vec2(1.0f, 1.0f));
+		Log::Print(
+			"Failed to write trace! Reason: " + result,
+			"PROFILER",
+			LogType::LOG_ERROR,
+			2);
 
-			image->Render(projection);
-		}
+		return;
 	}
-	
-	const vector<Text*>& text = Text::registry.GetAllWindowContent(windowID);
-	for (Text* t : text)
+
+	Log::Print(
+		"Wrote trace to '" + tracePath.string() + "'",
+		"PROFILER",
+		LogType::LOG_SUCCESS);
+}
+#endif
+
+bool HasDefaultQuad(const Widget* widget)
+{
+	//geometry every widget starts with, see Widget_Render
+	static const vector<vec2> defaultVertices =
 	{
-		if (t)
+		vec2(-0.5f,  0.5f),
+		vec2(0.5f,  0.5f),
+		vec2(0.5f, -0.5f),
+		vec2(-0.5f, -0.5f)
+	};
+	static const vector<u32> defaultIndices = { 0, 1, 2, 2, 3, 0 };
+
+	return widget->GetVertices() == defaultVertices
+		&& widget->GetIndices() == defaultIndices;
+}
+
+template<typename T>
+void SortByZOrder(
+	span<T* const> widgets,
+	vector<T*>& out)
+{
+	out.assign(widgets.begin(), widgets.end());
+
+	stable_sort(
+		out.begin(),
+		out.end(),
+		[](T* a, T* b)
 		{
-			t->MoveWidget(
-				window->GetClientRectSize(),
-				vec2(0.5f, 0.5f));
+			return (a ? a->GetZOrder() : 0) < (b ? b->GetZOrder() : 0);
+		});
+}
 
-			t->Render(projection);
-		}
+GLuint GetRetainedTarget(
+	u32 windowID,
+	vec2 size,
+	bool& isRecreated)
+{
+	isRecreated = false;
+
+	if (!glBlitFramebufferProc
+		|| !glDeleteFramebuffersProc
+		|| !glDeleteRenderbuffersProc
+		|| size.x < 1.0f
+		|| size.y < 1.0f)
+	{
+		return 0;
 	}
-	glEnable(GL_CULL_FACE);
 
-	context->SwapOpenGLBuffers();
+	auto it = retainedTargets.find(windowID);
+	if (it != retainedTargets.end()
+		&& it->second.size == size)
+	{
+		return it->second.framebuffer;
+	}
+
+	ReleaseRetainedTarget(windowID, true);
+
+	GLsizei width = static_cast<GLsizei>(size.x);
+	GLsizei height = static_cast<GLsizei>(size.y);
+
+	RetainedTarget newTarget{ .size = size };
+
+	glGenRenderbuffers(1, &newTarget.colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, newTarget.colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, width, height);
+
+	glGenRenderbuffers(1, &newTarget.depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, newTarget.depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &newTarget.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, newTarget.framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, newTarget.colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, newTarget.depthBuffer);
+
+	bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	retainedTargets[windowID] = newTarget;
+
+	if (!isComplete)
+	{
+		Log::Print(
+			"Retained framebuffer of window '" + to_string(windowID) + "' is incomplete, falling back to full redraws.",
+			"RENDER",
+			LogType::LOG_WARNING);
+
+		//kept as an empty entry of the same size so the warning is not repeated every frame
+		ReleaseRetainedTarget(windowID, true);
+		retainedTargets[windowID] = RetainedTarget{ .size = size };
+
+		return 0;
+	}
+
+	isRecreated = true;
+	return newTarget.framebuffer;
 }
 
-void Resize(Window* window)
+void ReleaseRetainedTarget(
+	u32 windowID,
+	bool isContextAlive)
 {
+	auto it = retainedTargets.find(windowID);
+	if (it == retainedTargets.end()) return;
+
+	RetainedTarget& target = it->second;
+	if (isContextAlive)
+	{
+		if (target.framebuffer != 0) glDeleteFramebuffersProc(1, &target.framebuffer);
+		if (target.colorBuffer != 0) glDeleteRenderbuffersProc(1, &target.colorBuffer);
+		if (target.depthBuffer != 0) glDeleteRenderbuffersProc(1, &target.depthBuffer);
+	}
+
+	retainedTargets.erase(it);
+}
 
+void ReleaseWindow(
+	u32 windowID,
+	bool isContextAlive)
+{
+	ReleaseRetainedTarget(windowID, isContextAlive);
+	BatchRenderer::RemoveWindow(windowID, isContextAlive);
+	TextRunRenderer::RemoveWindow(windowID, isContextAlive);
+	TextureAtlas::RemoveWindow(windowID, isContextAlive);
+
+	EventRouter::RemoveWindow(windowID);
+	HitIndex::RemoveWindow(windowID);
+	RetainedScene::RemoveWindow(windowID);
 }
 
 Window* CreateNewWindow(
@@ -275,7 +885,12 @@ Window* CreateNewWindow(
 		return nullptr;
 	}
 	
-	window->SetRedrawCallback([window]() { Redraw(window); });
+	window->SetRedrawCallback([window]()
+		{
+			//the OS asked for a repaint, so the front buffer can not be trusted anymore
+			RetainedScene::InvalidateWindow(window->GetID());
+			Redraw(window);
+		});
 	window->SetResizeCallback([window]() { Resize(window); });
 
 	window->BringToFocus();
@@ -330,5 +945,7 @@ Window* CreateNewWindow(
 		return nullptr;
 	}
 
+	trackedWindows.push_back(windowID);
+
 	return window;
 }
\ No newline at end of file
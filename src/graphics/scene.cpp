@@ -0,0 +1,386 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_map>
+#include <cmath>
+
+#include "core/pool_allocator.hpp"
+#include "graphics/scene.hpp"
+
+using KalaHeaders::vec2;
+using KalaHeaders::vec3;
+using KalaHeaders::radians;
+using KalaHeaders::kclamp;
+
+using KalaWindow::Utils::Transform2D;
+using KalaWindow::Utils::PosTarget;
+using KalaWindow::Utils::RotTarget;
+using KalaWindow::Utils::SizeTarget;
+using KalaWindow::Graphics::OpenGL::OpenGL_Texture;
+using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+using KalaWindow::UI::Widget;
+
+using Solin::Graphics::DamageRect;
+using Solin::Graphics::FrameDamage;
+using Solin::Graphics::DIRTY_NONE;
+using Solin::Graphics::DIRTY_TRANSFORM;
+using Solin::Graphics::DIRTY_COLOR;
+using Solin::Graphics::DIRTY_TEXTURE;
+using Solin::Graphics::DIRTY_TEXT;
+using Solin::Graphics::DIRTY_ALL;
+using Solin::Core::PoolAllocator;
+
+using std::unordered_map;
+using std::vector;
+using std::hash;
+using std::equal_to;
+using std::pair;
+
+//more rects than this are collapsed into their bounding rect,
+//each rect costs one scissored pass over the damaged widgets
+constexpr size_t MAX_DAMAGE_RECTS = 8;
+
+//extra pixels around each widget rect to cover antialiased edges
+constexpr f32 DAMAGE_PADDING = 2.0f;
+
+//a hidden window collects no damage, so flags marked for it pile up until it redraws.
+//Past this many flagged widgets the window is redrawn in full instead
+constexpr size_t MAX_PENDING_DIRTY = 1024;
+
+//Last submitted state of a single widget
+struct WidgetRecord
+{
+	vec2 pos{};
+	f32 rot{};
+	vec2 size{};
+
+	vec3 color{};
+	f32 opacity{};
+
+	const OpenGL_Texture* texture{};
+	const OpenGL_Shader* shader{};
+	u32 fontID{};
+
+	bool canUpdate{};
+	u16 zOrder{};
+
+	DamageRect rect{};
+
+	//frame this record was last seen in, unseen records belong to removed widgets
+	u64 lastSeenFrame{};
+};
+
+struct WindowScene
+{
+	vec2 viewportSize{};
+	size_t widgetCount{};
+	bool isInvalidated = true;
+
+	u64 frameIndex{};
+
+	//walked and looked up for every widget each frame, pooled nodes keep the records of a window close together
+	unordered_map<u32, WidgetRecord, hash<u32>, equal_to<u32>, PoolAllocator<pair<const u32, WidgetRecord>>> records{};
+
+	//widget IDs flagged before the window collected damage,
+	//IDs so a widget removed in between can never be matched by a new one at the same address
+	unordered_map<u32, u8> pendingDirty{};
+
+	FrameDamage damage{};
+};
+
+static unordered_map<u32, WindowScene> scenes{};
+
+static DamageRect GetWidgetRect(Widget* widget);
+static bool Overlaps(const DamageRect& a, const DamageRect& b);
+static DamageRect Merge(const DamageRect& a, const DamageRect& b);
+static void AddRect(vector<DamageRect>& rects, const DamageRect& rect);
+
+namespace Solin::Graphics
+{
+	void RetainedScene::MarkDirty(
+		const Widget* widget,
+		u8 flags)
+	{
+		if (!widget
+			|| flags == DIRTY_NONE)
+		{
+			return;
+		}
+
+		WindowScene& scene = scenes[widget->GetWindowID()];
+
+		//a full redraw repaints the widget anyway
+		if (scene.isInvalidated) return;
+
+		if (scene.pendingDirty.size() >= MAX_PENDING_DIRTY
+			&& !scene.pendingDirty.contains(widget->GetID()))
+		{
+			scene.pendingDirty.clear();
+			scene.isInvalidated = true;
+
+			return;
+		}
+
+		scene.pendingDirty[widget->GetID()] |= flags;
+	}
+
+	void RetainedScene::InvalidateWindow(u32 windowID)
+	{
+		WindowScene& scene = scenes[windowID];
+
+		scene.isInvalidated = true;
+		scene.pendingDirty.clear();
+	}
+
+	void RetainedScene::RemoveWindow(u32 windowID)
+	{
+		scenes.erase(windowID);
+	}
+
+	bool RetainedScene::UpdateLayout(
+		u32 windowID,
+		vec2 viewportSize,
+		size_t widgetCount)
+	{
+		WindowScene& scene = scenes[windowID];
+
+		if (scene.viewportSize != viewportSize)
+		{
+			scene.viewportSize = viewportSize;
+			scene.widgetCount = widgetCount;
+			scene.isInvalidated = true;
+
+			return true;
+		}
+
+		if (scene.widgetCount != widgetCount)
+		{
+			scene.widgetCount = widgetCount;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	const FrameDamage& RetainedScene::CollectDamage(
+		u32 windowID,
+		span<Image* const> images,
+		span<Text* const> texts)
+	{
+		PROFILE_ZONE("RetainedScene::CollectDamage");
+
+		WindowScene& scene = scenes[windowID];
+		FrameDamage& damage = scene.damage;
+
+		++scene.frameIndex;
+
+		damage.isEmpty = true;
+		damage.isFull = scene.isInvalidated;
+		damage.rects.clear();
+
+		auto Track = [&](Widget* widget, u32 fontID)
+			{
+				Transform2D* transform = widget->GetTransform();
+				if (!transform) return;
+
+				WidgetRecord& record = scene.records[widget->GetID()];
+				bool isNew = record.lastSeenFrame == 0;
+
+				u8 flags = isNew ? DIRTY_ALL : DIRTY_NONE;
+
+				auto pending = scene.pendingDirty.find(widget->GetID());
+				if (pending != scene.pendingDirty.end())
+				{
+					flags |= pending->second;
+					scene.pendingDirty.erase(pending);
+				}
+
+				vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
+				f32 rot = transform->GetRot(RotTarget::ROT_COMBINED);
+				vec2 size = transform->GetSize(SizeTarget::SIZE_COMBINED);
+
+				if (record.pos != pos
+					|| record.rot != rot
+					|| record.size != size
+					|| record.zOrder != widget->GetZOrder()
+					|| record.canUpdate != widget->CanUpdate())
+				{
+					flags |= DIRTY_TRANSFORM;
+				}
+				if (record.color != widget->GetNormalizedColor()
+					|| record.opacity != widget->GetOpacity())
+				{
+					flags |= DIRTY_COLOR;
+				}
+				if (record.texture != widget->GetTexture()
+					|| record.shader != widget->GetShader())
+				{
+					flags |= DIRTY_TEXTURE;
+				}
+				if (record.fontID != fontID) flags |= DIRTY_TEXT;
+
+				record.lastSeenFrame = scene.frameIndex;
+
+				if (flags == DIRTY_NONE) return;
+
+				DamageRect newRect = GetWidgetRect(widget);
+
+				//the old area must be repainted too when the widget moved away from it
+				if (!isNew) AddRect(damage.rects, record.rect);
+				AddRect(damage.rects, newRect);
+
+				record.pos = pos;
+				record.rot = rot;
+				record.size = size;
+				record.color = widget->GetNormalizedColor();
+				record.opacity = widget->GetOpacity();
+				record.texture = widget->GetTexture();
+				record.shader = widget->GetShader();
+				record.fontID = fontID;
+				record.canUpdate = widget->CanUpdate();
+				record.zOrder = widget->GetZOrder();
+				record.rect = newRect;
+			};
+
+		for (Image* image : images)
+		{
+			if (image) Track(image, 0);
+		}
+		for (Text* text : texts)
+		{
+			if (text) Track(text, text->GetFontID());
+		}
+
+		//widgets that were removed since the last frame leave a hole behind
+		for (auto it = scene.records.begin(); it != scene.records.end();)
+		{
+			if (it->second.lastSeenFrame != scene.frameIndex)
+			{
+				AddRect(damage.rects, it->second.rect);
+				it = scene.records.erase(it);
+			}
+			else ++it;
+		}
+
+		//whatever is left was flagged for widgets removed before this frame
+		scene.pendingDirty.clear();
+		scene.isInvalidated = false;
+
+		if (!damage.isFull
+			&& damage.rects.empty())
+		{
+			return damage;
+		}
+
+		damage.isEmpty = false;
+
+		if (damage.rects.size() > MAX_DAMAGE_RECTS)
+		{
+			DamageRect bounds = damage.rects.front();
+			for (const auto& r : damage.rects) bounds = Merge(bounds, r);
+
+			damage.rects.assign(1, bounds);
+		}
+
+		//clamp to the framebuffer so scissor rects never go negative
+		for (auto& r : damage.rects)
+		{
+			r.min = kclamp(r.min, vec2(0.0f), scene.viewportSize);
+			r.max = kclamp(r.max, vec2(0.0f), scene.viewportSize);
+		}
+
+		return damage;
+	}
+
+	bool RetainedScene::IsDamaged(
+		Widget* widget,
+		const DamageRect& rect)
+	{
+		return widget
+			&& Overlaps(GetWidgetRect(widget), rect);
+	}
+
+	void RetainedScene::RecordFrame(const FrameDamage& damage)
+	{
+		if (damage.isEmpty) ++counters.skippedFrames;
+		else if (damage.isFull) ++counters.renderedFrames;
+		else ++counters.partialFrames;
+	}
+
+	void RetainedScene::RecordWidget(bool wasRendered)
+	{
+		if (wasRendered) ++counters.renderedWidgets;
+		else ++counters.skippedWidgets;
+	}
+}
+
+DamageRect GetWidgetRect(Widget* widget)
+{
+	Transform2D* transform = widget->GetTransform();
+	if (!transform) return {};
+
+	vec2 pos = transform->GetPos(PosTarget::POS_COMBINED);
+	vec2 half = transform->GetSize(SizeTarget::SIZE_COMBINED) * 0.5f;
+
+	//bounds of the rotated quad
+	f32 rads = radians(transform->GetRot(RotTarget::ROT_COMBINED));
+	f32 c = fabsf(cos(rads));
+	f32 s = fabsf(sin(rads));
+
+	vec2 extent = vec2(
+		half.x * c + half.y * s + DAMAGE_PADDING,
+		half.x * s + half.y * c + DAMAGE_PADDING);
+
+	return { pos - extent, pos + extent };
+}
+
+bool Overlaps(const DamageRect& a, const DamageRect& b)
+{
+	return a.min.x <= b.max.x
+		&& a.max.x >= b.min.x
+		&& a.min.y <= b.max.y
+		&& a.max.y >= b.min.y;
+}
+
+DamageRect Merge(const DamageRect& a, const DamageRect& b)
+{
+	return
+	{
+		vec2(min(a.min.x, b.min.x), min(a.min.y, b.min.y)),
+		vec2(max(a.max.x, b.max.x), max(a.max.y, b.max.y))
+	};
+}
+
+void AddRect(vector<DamageRect>& rects, const DamageRect& rect)
+{
+	if (rect.max.x <= rect.min.x
+		|| rect.max.y <= rect.min.y)
+	{
+		return;
+	}
+
+	//overlapping rects are merged so no region is drawn twice in one frame
+	DamageRect merged = rect;
+	bool didMerge = true;
+	while (didMerge)
+	{
+		didMerge = false;
+		for (size_t i = 0; i < rects.size(); ++i)
+		{
+			if (Overlaps(rects[i], merged))
+			{
+				merged = Merge(rects[i], merged);
+				rects.erase(rects.begin() + i);
+				didMerge = true;
+				break;
+			}
+		}
+	}
+
+	rects.push_back(merged);
+}
\ No newline at end of file
@@ -0,0 +1,702 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define SDF_USE_SSE2
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+#include "KalaHeaders/file_utils.hpp"
+
+#include "graphics/sdf_atlas.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::vec2;
+using KalaHeaders::MappedFile;
+using KalaHeaders::MapFile;
+using KalaHeaders::CreateDirectory;
+using KalaHeaders::WriteBinaryLinesToFile;
+
+using KalaFont::FlatFontData;
+using KalaFont::FlatGlyph;
+
+using Solin::Graphics::SdfAtlas;
+using Solin::Graphics::SdfAtlasData;
+using Solin::Graphics::SdfGlyph;
+using Solin::Graphics::SkylinePacker;
+using Solin::Graphics::AtlasRect;
+
+using std::unordered_map;
+using std::thread;
+using std::atomic;
+using std::vector;
+using std::string;
+using std::ostringstream;
+using std::hex;
+using std::dec;
+using std::setw;
+using std::setfill;
+using std::sort;
+using std::min;
+using std::max;
+using std::clamp;
+using std::swap;
+using std::to_string;
+using std::ceil;
+using std::sqrt;
+using std::memcpy;
+using std::is_trivially_copyable_v;
+using std::filesystem::path;
+using std::filesystem::exists;
+
+//empty texels between glyphs so linear filtering never samples a neighbour
+constexpr u32 SDF_PADDING = 1;
+
+constexpr u32 MAX_PIXEL_SIZE = 256;
+constexpr u32 MIN_ATLAS_WIDTH = 256;
+constexpr u32 MAX_ATLAS_WIDTH = 4096;
+constexpr u32 MAX_ATLAS_HEIGHT = 16384;
+
+//bump when the generator output changes so older cache files are rebuilt
+constexpr u32 SDF_CACHE_VERSION = 1;
+
+struct SdfCacheHeader
+{
+	char magic[4]{ 'K', 'S', 'D', 'F' };
+	u32 version = SDF_CACHE_VERSION;
+	u64 fontHash{};
+	u32 pixelSize{};
+	u32 spread{};
+	u32 width{};
+	u32 height{};
+	u32 glyphCount{};
+	u32 reserved{};
+};
+
+static_assert(sizeof(SdfCacheHeader) == 40, "SdfCacheHeader must stay tightly packed");
+static_assert(is_trivially_copyable_v<SdfGlyph>, "SdfGlyph is written to the cache as is");
+
+//Outline segment in cell pixels, with the values the distance loop needs precomputed
+struct SdfEdge
+{
+	f32 ax{};
+	f32 ay{};
+	f32 dx{};
+	f32 dy{};
+	f32 invLengthSq{};
+};
+
+static void RasterizeGlyph(
+	const FlatFontData& font,
+	u32 glyphIndex,
+	const SdfGlyph& glyph,
+	f32 pixelSize,
+	f32 spread,
+	SdfAtlasData& atlas);
+static void CollectOutline(
+	const FlatFontData& font,
+	const FlatGlyph& glyph,
+	vec2 cellOrigin,
+	f32 pixelSize,
+	vector<SdfEdge>& outEdges);
+static path GetCachePath(
+	const path& cacheDir,
+	u64 fontHash,
+	u32 pixelSize,
+	u32 spread);
+static bool ReadCache(
+	const path& cachePath,
+	u64 fontHash,
+	u32 pixelSize,
+	u32 spread,
+	size_t glyphCount,
+	SdfAtlasData& outAtlas);
+static void WriteCache(
+	const path& cachePath,
+	const SdfAtlasData& atlas);
+
+namespace Solin::Graphics
+{
+	bool SdfAtlas::Build(
+		const FlatFontData& font,
+		u32 pixelSize,
+		u32 spread,
+		SdfAtlasData& outAtlas,
+		u32 threadCount)
+	{
+		PROFILE_ZONE("SdfAtlas::Build");
+
+		if (pixelSize == 0
+			|| pixelSize > MAX_PIXEL_SIZE
+			|| spread == 0)
+		{
+			Log::Print(
+				"Cannot build an SDF atlas with pixel size '" + to_string(pixelSize)
+				+ "' and spread '" + to_string(spread) + "'!",
+				"SDF_ATLAS",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		u32 glyphCount = static_cast<u32>(font.glyphs.size());
+		f32 scale = static_cast<f32>(pixelSize);
+
+		outAtlas.pixelSize = pixelSize;
+		outAtlas.spread = spread;
+		outAtlas.glyphs.assign(glyphCount, {});
+
+		//
+		// SIZES
+		//
+
+		vector<u32> order{};
+		order.reserve(glyphCount);
+
+		u64 area{};
+		for (u32 g = 0; g < glyphCount; ++g)
+		{
+			const FlatGlyph& glyph = font.glyphs[g];
+			if (glyph.indexCount < 3
+				|| glyph.vertexFloats < 2)
+			{
+				continue;
+			}
+
+			vec2 low = vec2(font.vertices[glyph.vertexOffset], font.vertices[glyph.vertexOffset + 1]);
+			vec2 high = low;
+			for (u32 v = 2; v + 1 < glyph.vertexFloats; v += 2)
+			{
+				f32 x = font.vertices[glyph.vertexOffset + v];
+				f32 y = font.vertices[glyph.vertexOffset + v + 1];
+
+				low = vec2(min(low.x, x), min(low.y, y));
+				high = vec2(max(high.x, x), max(high.y, y));
+			}
+
+			SdfGlyph& out = outAtlas.glyphs[g];
+			out.rect.width = static_cast<u32>(ceil((high.x - low.x) * scale)) + 2 * spread;
+			out.rect.height = static_cast<u32>(ceil((high.y - low.y) * scale)) + 2 * spread;
+			out.planeMin = low - vec2(static_cast<f32>(spread) / scale);
+			out.planeMax = out.planeMin + vec2(
+				static_cast<f32>(out.rect.width) / scale,
+				static_cast<f32>(out.rect.height) / scale);
+
+			area += static_cast<u64>(out.rect.width + SDF_PADDING) * (out.rect.height + SDF_PADDING);
+			order.push_back(g);
+		}
+
+		//
+		// PACKING
+		//
+
+		//tallest first keeps the skyline flat
+		sort(
+			order.begin(),
+			order.end(),
+			[&outAtlas](u32 a, u32 b) { return outAtlas.glyphs[a].rect.height > outAtlas.glyphs[b].rect.height; });
+
+		u32 width = MIN_ATLAS_WIDTH;
+		while (width < MAX_ATLAS_WIDTH
+			&& static_cast<u64>(width) * width < area + area / 4)
+		{
+			width *= 2;
+		}
+
+		SkylinePacker packer{};
+		packer.Initialize(width, MAX_ATLAS_HEIGHT);
+
+		u32 height{};
+		for (u32 g : order)
+		{
+			AtlasRect& rect = outAtlas.glyphs[g].rect;
+
+			AtlasRect packed{};
+			if (!packer.Insert(
+				rect.width + SDF_PADDING,
+				rect.height + SDF_PADDING,
+				packed))
+			{
+				Log::Print(
+					"Glyphs at pixel size '" + to_string(pixelSize) + "' do not fit one SDF atlas!",
+					"SDF_ATLAS",
+					LogType::LOG_ERROR,
+					2);
+
+				return false;
+			}
+
+			rect.x = packed.x;
+			rect.y = packed.y;
+			height = max(height, rect.y + rect.height + SDF_PADDING);
+		}
+
+		outAtlas.width = width;
+		outAtlas.height = max((height + 3) & ~3u, 4u);
+		outAtlas.pixels.assign(static_cast<size_t>(outAtlas.width) * outAtlas.height, 0);
+
+		for (u32 g : order)
+		{
+			SdfGlyph& glyph = outAtlas.glyphs[g];
+
+			glyph.uvMin = vec2(
+				static_cast<f32>(glyph.rect.x) / outAtlas.width,
+				static_cast<f32>(glyph.rect.y) / outAtlas.height);
+			glyph.uvMax = vec2(
+				static_cast<f32>(glyph.rect.x + glyph.rect.width) / outAtlas.width,
+				static_cast<f32>(glyph.rect.y + glyph.rect.height) / outAtlas.height);
+		}
+
+		//
+		// RASTERIZING
+		//
+
+		u32 workerCount = threadCount != 0
+			? threadCount
+			: max(thread::hardware_concurrency(), 1u);
+		workerCount = min(workerCount, max(static_cast<u32>(order.size()), 1u));
+
+		//glyphs own disjoint rects of the atlas, so workers never write the same texel
+		atomic<u32> next{};
+		auto Work = [&]()
+			{
+				PROFILE_ZONE("SdfAtlas::Rasterize");
+
+				for (u32 i = next.fetch_add(1); i < order.size(); i = next.fetch_add(1))
+				{
+					u32 g = order[i];
+					RasterizeGlyph(
+						font,
+						g,
+						outAtlas.glyphs[g],
+						scale,
+						static_cast<f32>(spread),
+						outAtlas);
+				}
+			};
+
+		vector<thread> workers{};
+		workers.reserve(workerCount - 1);
+		for (u32 w = 1; w < workerCount; ++w) workers.emplace_back(Work);
+
+		Work();
+
+		for (thread& worker : workers) worker.join();
+
+		return true;
+	}
+
+	bool SdfAtlas::LoadOrBuild(
+		const path& fontPath,
+		const FlatFontData& font,
+		u32 pixelSize,
+		const path& cacheDir,
+		SdfAtlasData& outAtlas,
+		u32 spread)
+	{
+		PROFILE_ZONE("SdfAtlas::LoadOrBuild");
+
+		u64 fontHash = HashFile(fontPath);
+
+		path cachePath{};
+		if (!cacheDir.empty()
+			&& fontHash != 0)
+		{
+			cachePath = GetCachePath(cacheDir, fontHash, pixelSize, spread);
+
+			if (ReadCache(
+				cachePath,
+				fontHash,
+				pixelSize,
+				spread,
+				font.glyphs.size(),
+				outAtlas))
+			{
+				return true;
+			}
+		}
+
+		if (!Build(
+			font,
+			pixelSize,
+			spread,
+			outAtlas))
+		{
+			return false;
+		}
+
+		outAtlas.fontHash = fontHash;
+
+		if (!cachePath.empty())
+		{
+			if (!exists(cacheDir))
+			{
+				string result = CreateDirectory(cacheDir);
+				if (!result.empty())
+				{
+					Log::Print(
+						result,
+						"SDF_ATLAS",
+						LogType::LOG_WARNING);
+
+					return true;
+				}
+			}
+
+			WriteCache(cachePath, outAtlas);
+		}
+
+		return true;
+	}
+
+	u64 SdfAtlas::HashFile(const path& filePath)
+	{
+		PROFILE_ZONE("SdfAtlas::HashFile");
+
+		MappedFile file{};
+		if (!MapFile(filePath, file).empty()) return 0;
+
+		constexpr u64 FNV_OFFSET = 14695981039346656037ull;
+		constexpr u64 FNV_PRIME = 1099511628211ull;
+
+		u64 hash = FNV_OFFSET;
+
+		const u8* data = file.GetData();
+		size_t size = file.GetSize();
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= data[i];
+			hash *= FNV_PRIME;
+		}
+
+		//0 means the file could not be read
+		return hash != 0 ? hash : 1;
+	}
+}
+
+void RasterizeGlyph(
+	const FlatFontData& font,
+	u32 glyphIndex,
+	const SdfGlyph& glyph,
+	f32 pixelSize,
+	f32 spread,
+	SdfAtlasData& atlas)
+{
+	vector<SdfEdge> edges{};
+	CollectOutline(
+		font,
+		font.glyphs[glyphIndex],
+		glyph.planeMin,
+		pixelSize,
+		edges);
+
+	if (edges.empty()) return;
+
+	const f32 valueScale = 127.0f / spread;
+	const u32 cellWidth = glyph.rect.width;
+	const u32 cellHeight = glyph.rect.height;
+
+	vector<f32> crossings{};
+	vector<f32> distances(cellWidth);
+
+	for (u32 row = 0; row < cellHeight; ++row)
+	{
+		const f32 py = static_cast<f32>(row) + 0.5f;
+
+		//outline crossings of this row, a texel is inside
+		//when an odd number of them lie to its right
+		crossings.clear();
+		for (const SdfEdge& e : edges)
+		{
+			f32 by = e.ay + e.dy;
+			if ((e.ay > py) != (by > py))
+			{
+				crossings.push_back(e.ax + (py - e.ay) * e.dx / e.dy);
+			}
+		}
+		sort(crossings.begin(), crossings.end());
+
+		//squared distance to the closest segment, four texels at a time
+		u32 column{};
+
+#ifdef SDF_USE_SSE2
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 py4 = _mm_set1_ps(py);
+
+		for (; column + 4 <= cellWidth; column += 4)
+		{
+			f32 x = static_cast<f32>(column) + 0.5f;
+			__m128 px4 = _mm_setr_ps(x, x + 1.0f, x + 2.0f, x + 3.0f);
+			__m128 best = _mm_set1_ps(3.4e38f);
+
+			for (const SdfEdge& e : edges)
+			{
+				__m128 ax = _mm_set1_ps(e.ax);
+				__m128 ay = _mm_set1_ps(e.ay);
+				__m128 dx = _mm_set1_ps(e.dx);
+				__m128 dy = _mm_set1_ps(e.dy);
+
+				__m128 relX = _mm_sub_ps(px4, ax);
+				__m128 relY = _mm_sub_ps(py4, ay);
+
+				__m128 t = _mm_mul_ps(
+					_mm_add_ps(_mm_mul_ps(relX, dx), _mm_mul_ps(relY, dy)),
+					_mm_set1_ps(e.invLengthSq));
+				t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+				__m128 cx = _mm_sub_ps(_mm_mul_ps(t, dx), relX);
+				__m128 cy = _mm_sub_ps(_mm_mul_ps(t, dy), relY);
+
+				best = _mm_min_ps(best, _mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)));
+			}
+
+			_mm_storeu_ps(distances.data() + column, best);
+		}
+#endif
+
+		for (; column < cellWidth; ++column)
+		{
+			f32 px = static_cast<f32>(column) + 0.5f;
+			f32 best = 3.4e38f;
+
+			for (const SdfEdge& e : edges)
+			{
+				f32 relX = px - e.ax;
+				f32 relY = py - e.ay;
+
+				f32 t = clamp((relX * e.dx + relY * e.dy) * e.invLengthSq, 0.0f, 1.0f);
+
+				f32 cx = t * e.dx - relX;
+				f32 cy = t * e.dy - relY;
+
+				best = min(best, cx * cx + cy * cy);
+			}
+
+			distances[column] = best;
+		}
+
+		u8* out = atlas.pixels.data()
+			+ static_cast<size_t>(glyph.rect.y + row) * atlas.width
+			+ glyph.rect.x;
+
+		size_t crossing{};
+		for (u32 c = 0; c < cellWidth; ++c)
+		{
+			f32 px = static_cast<f32>(c) + 0.5f;
+			while (crossing < crossings.size()
+				&& crossings[crossing] <= px)
+			{
+				++crossing;
+			}
+
+			bool isInside = ((crossings.size() - crossing) & 1) != 0;
+
+			f32 distance = sqrt(distances[c]);
+			f32 value = 128.0f + (isInside ? distance : -distance) * valueScale;
+
+			out[c] = static_cast<u8>(clamp(value, 0.0f, 255.0f));
+		}
+	}
+}
+
+void CollectOutline(
+	const FlatFontData& font,
+	const FlatGlyph& glyph,
+	vec2 cellOrigin,
+	f32 pixelSize,
+	vector<SdfEdge>& outEdges)
+{
+	//triangles may repeat vertices at the same position, so vertices are merged
+	//by position before edges are counted
+	unordered_map<u64, u32> positions{};
+	vector<u32> welded(glyph.vertexFloats / 2);
+
+	for (u32 v = 0; v < welded.size(); ++v)
+	{
+		u32 xBits{};
+		u32 yBits{};
+		memcpy(&xBits, &font.vertices[glyph.vertexOffset + v * 2], sizeof(u32));
+		memcpy(&yBits, &font.vertices[glyph.vertexOffset + v * 2 + 1], sizeof(u32));
+
+		u64 key = (static_cast<u64>(xBits) << 32) | yBits;
+		welded[v] = positions.try_emplace(key, v).first->second;
+	}
+
+	//edges used by exactly one triangle are the outline of the mesh
+	unordered_map<u64, u32> edgeUses{};
+	edgeUses.reserve(glyph.indexCount);
+
+	auto AddEdge = [&](u32 a, u32 b)
+		{
+			if (a == b) return;
+			if (a > b) swap(a, b);
+
+			++edgeUses[(static_cast<u64>(a) << 32) | b];
+		};
+
+	for (u32 i = 0; i + 2 < glyph.indexCount; i += 3)
+	{
+		u32 a = font.indices[glyph.indexOffset + i];
+		u32 b = font.indices[glyph.indexOffset + i + 1];
+		u32 c = font.indices[glyph.indexOffset + i + 2];
+
+		//corrupt indices are skipped instead of read out of bounds
+		if (a >= welded.size()
+			|| b >= welded.size()
+			|| c >= welded.size())
+		{
+			continue;
+		}
+
+		AddEdge(welded[a], welded[b]);
+		AddEdge(welded[b], welded[c]);
+		AddEdge(welded[c], welded[a]);
+	}
+
+	outEdges.clear();
+	outEdges.reserve(edgeUses.size());
+
+	for (const auto& [key, uses] : edgeUses)
+	{
+		if (uses != 1) continue;
+
+		u32 a = static_cast<u32>(key >> 32);
+		u32 b = static_cast<u32>(key);
+
+		f32 ax = (font.vertices[glyph.vertexOffset + a * 2] - cellOrigin.x) * pixelSize;
+		f32 ay = (font.vertices[glyph.vertexOffset + a * 2 + 1] - cellOrigin.y) * pixelSize;
+		f32 bx = (font.vertices[glyph.vertexOffset + b * 2] - cellOrigin.x) * pixelSize;
+		f32 by = (font.vertices[glyph.vertexOffset + b * 2 + 1] - cellOrigin.y) * pixelSize;
+
+		f32 dx = bx - ax;
+		f32 dy = by - ay;
+		f32 lengthSq = dx * dx + dy * dy;
+		if (lengthSq <= 0.0f) continue;
+
+		outEdges.push_back(
+		{
+			.ax = ax,
+			.ay = ay,
+			.dx = dx,
+			.dy = dy,
+			.invLengthSq = 1.0f / lengthSq
+		});
+	}
+}
+
+path GetCachePath(
+	const path& cacheDir,
+	u64 fontHash,
+	u32 pixelSize,
+	u32 spread)
+{
+	ostringstream oss{};
+	oss << hex << setw(16) << setfill('0') << fontHash
+		<< "_" << dec << pixelSize << "_" << spread << ".ksdf";
+
+	return cacheDir / oss.str();
+}
+
+bool ReadCache(
+	const path& cachePath,
+	u64 fontHash,
+	u32 pixelSize,
+	u32 spread,
+	size_t glyphCount,
+	SdfAtlasData& outAtlas)
+{
+	PROFILE_ZONE("SdfAtlas::ReadCache");
+
+	if (!exists(cachePath)) return false;
+
+	MappedFile file{};
+	if (!MapFile(cachePath, file).empty()) return false;
+
+	const u8* data = file.GetData();
+	size_t size = file.GetSize();
+
+	SdfCacheHeader header{};
+	if (size < sizeof(header)) return false;
+	memcpy(&header, data, sizeof(header));
+
+	size_t glyphBytes = glyphCount * sizeof(SdfGlyph);
+	size_t pixelBytes = static_cast<size_t>(header.width) * header.height;
+
+	//anything that does not match exactly is rebuilt and overwritten
+	if (memcmp(header.magic, "KSDF", 4) != 0
+		|| header.version != SDF_CACHE_VERSION
+		|| header.fontHash != fontHash
+		|| header.pixelSize != pixelSize
+		|| header.spread != spread
+		|| header.glyphCount != glyphCount
+		|| header.width > MAX_ATLAS_WIDTH
+		|| header.height > MAX_ATLAS_HEIGHT
+		|| size != sizeof(header) + glyphBytes + pixelBytes)
+	{
+		return false;
+	}
+
+	outAtlas.fontHash = fontHash;
+	outAtlas.pixelSize = pixelSize;
+	outAtlas.spread = spread;
+	outAtlas.width = header.width;
+	outAtlas.height = header.height;
+
+	outAtlas.glyphs.resize(glyphCount);
+	if (glyphBytes > 0) memcpy(outAtlas.glyphs.data(), data + sizeof(header), glyphBytes);
+
+	outAtlas.pixels.resize(pixelBytes);
+	memcpy(outAtlas.pixels.data(), data + sizeof(header) + glyphBytes, pixelBytes);
+
+	return true;
+}
+
+void WriteCache(
+	const path& cachePath,
+	const SdfAtlasData& atlas)
+{
+	PROFILE_ZONE("SdfAtlas::WriteCache");
+
+	SdfCacheHeader header{};
+	header.fontHash = atlas.fontHash;
+	header.pixelSize = atlas.pixelSize;
+	header.spread = atlas.spread;
+	header.width = atlas.width;
+	header.height = atlas.height;
+	header.glyphCount = static_cast<u32>(atlas.glyphs.size());
+
+	size_t glyphBytes = atlas.glyphs.size() * sizeof(SdfGlyph);
+
+	vector<u8> out(sizeof(header) + glyphBytes + atlas.pixels.size());
+	memcpy(out.data(), &header, sizeof(header));
+	if (glyphBytes > 0) memcpy(out.data() + sizeof(header), atlas.glyphs.data(), glyphBytes);
+	memcpy(out.data() + sizeof(header) + glyphBytes, atlas.pixels.data(), atlas.pixels.size());
+
+	//a missing cache only costs a rebuild next time
+	string result = WriteBinaryLinesToFile(cachePath, out);
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"SDF_ATLAS",
+			LogType::LOG_WARNING);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include "graphics/atlas.hpp"
+
+using Solin::Graphics::SkylinePacker;
+using Solin::Graphics::AtlasRect;
+
+using std::vector;
+using std::max;
+using std::min;
+
+//Merges the free rect at 'index' with every free rect that shares a whole edge with it
+static void MergeFreeRect(
+	vector<AtlasRect>& freeRects,
+	size_t index);
+
+namespace Solin::Graphics
+{
+	void SkylinePacker::Initialize(
+		u32 newWidth,
+		u32 newHeight)
+	{
+		width = newWidth;
+		height = newHeight;
+		usedArea = 0;
+
+		skyline.assign(1, { 0, 0, width });
+		freeRects.clear();
+	}
+
+	bool SkylinePacker::Insert(
+		u32 rectWidth,
+		u32 rectHeight,
+		AtlasRect& outRect)
+	{
+		if (rectWidth == 0
+			|| rectHeight == 0
+			|| rectWidth > width
+			|| rectHeight > height)
+		{
+			return false;
+		}
+
+		//best area fit among evicted rects
+		size_t bestFree = freeRects.size();
+		u64 bestFreeArea = UINT64_MAX;
+		for (size_t i = 0; i < freeRects.size(); ++i)
+		{
+			const AtlasRect& r = freeRects[i];
+			u64 area = static_cast<u64>(r.width) * r.height;
+
+			if (r.width >= rectWidth
+				&& r.height >= rectHeight
+				&& area < bestFreeArea)
+			{
+				bestFree = i;
+				bestFreeArea = area;
+			}
+		}
+
+		if (bestFree != freeRects.size())
+		{
+			AtlasRect hole = freeRects[bestFree];
+			freeRects.erase(freeRects.begin() + bestFree);
+
+			outRect = { hole.x, hole.y, rectWidth, rectHeight };
+
+			//guillotine split along the longer leftover side
+			u32 rightWidth = hole.width - rectWidth;
+			u32 bottomHeight = hole.height - rectHeight;
+
+			AtlasRect right{};
+			AtlasRect bottom{};
+			if (rightWidth > bottomHeight)
+			{
+				right = { hole.x + rectWidth, hole.y, rightWidth, hole.height };
+				bottom = { hole.x, hole.y + rectHeight, rectWidth, bottomHeight };
+			}
+			else
+			{
+				right = { hole.x + rectWidth, hole.y, rightWidth, rectHeight };
+				bottom = { hole.x, hole.y + rectHeight, hole.width, bottomHeight };
+			}
+
+			if (right.width > 0 && right.height > 0) freeRects.push_back(right);
+			if (bottom.width > 0 && bottom.height > 0) freeRects.push_back(bottom);
+
+			usedArea += static_cast<u64>(rectWidth) * rectHeight;
+			return true;
+		}
+
+		//lowest top edge wins, ties go to the narrowest skyline segment
+		size_t bestIndex = skyline.size();
+		u32 bestTop = UINT32_MAX;
+		u32 bestWidth = UINT32_MAX;
+		u32 bestY{};
+
+		for (size_t i = 0; i < skyline.size(); ++i)
+		{
+			u32 y{};
+			if (!FitsAt(i, rectWidth, rectHeight, y)) continue;
+
+			u32 top = y + rectHeight;
+			if (top < bestTop
+				|| (top == bestTop
+				&& skyline[i].width < bestWidth))
+			{
+				bestIndex = i;
+				bestTop = top;
+				bestWidth = skyline[i].width;
+				bestY = y;
+			}
+		}
+
+		if (bestIndex == skyline.size()) return false;
+
+		outRect = { skyline[bestIndex].x, bestY, rectWidth, rectHeight };
+		AddSkylineLevel(bestIndex, outRect);
+
+		usedArea += static_cast<u64>(rectWidth) * rectHeight;
+		return true;
+	}
+
+	void SkylinePacker::Free(const AtlasRect& rect)
+	{
+		if (rect.width == 0
+			|| rect.height == 0)
+		{
+			return;
+		}
+
+		u64 area = static_cast<u64>(rect.width) * rect.height;
+		usedArea = area > usedArea ? 0 : usedArea - area;
+
+		freeRects.push_back(rect);
+		MergeFreeRect(freeRects, freeRects.size() - 1);
+
+		//everything was evicted, start over with a flat skyline
+		if (usedArea == 0) Initialize(width, height);
+	}
+
+	f32 SkylinePacker::GetOccupancy() const
+	{
+		u64 total = static_cast<u64>(width) * height;
+		return total == 0
+			? 0.0f
+			: static_cast<f32>(static_cast<f64>(usedArea) / static_cast<f64>(total));
+	}
+
+	f32 SkylinePacker::GetFragmentation() const
+	{
+		u64 total = static_cast<u64>(width) * height;
+		u64 freeArea = total - usedArea;
+		if (freeArea == 0) return 0.0f;
+
+		u64 holeArea{};
+		for (const auto& r : freeRects) holeArea += static_cast<u64>(r.width) * r.height;
+
+		return static_cast<f32>(static_cast<f64>(holeArea) / static_cast<f64>(freeArea));
+	}
+
+	bool SkylinePacker::FitsAt(
+		size_t index,
+		u32 rectWidth,
+		u32 rectHeight,
+		u32& outY) const
+	{
+		u32 x = skyline[index].x;
+		if (x + rectWidth > width) return false;
+
+		u32 y{};
+		u32 remaining = rectWidth;
+
+		for (size_t i = index; remaining > 0; ++i)
+		{
+			if (i == skyline.size()) return false;
+
+			y = max(y, skyline[i].y);
+			if (y + rectHeight > height) return false;
+
+			remaining -= min(remaining, skyline[i].width);
+		}
+
+		outY = y;
+		return true;
+	}
+
+	void SkylinePacker::AddSkylineLevel(
+		size_t index,
+		const AtlasRect& rect)
+	{
+		skyline.insert(
+			skyline.begin() + index,
+			{ rect.x, rect.y + rect.height, rect.width });
+
+		//shrink or drop the segments now covered by the new one
+		u32 coveredEnd = rect.x + rect.width;
+		for (size_t i = index + 1; i < skyline.size();)
+		{
+			SkylineNode& node = skyline[i];
+			if (node.x >= coveredEnd) break;
+
+			u32 overlap = coveredEnd - node.x;
+			if (overlap >= node.width)
+			{
+				skyline.erase(skyline.begin() + i);
+				continue;
+			}
+
+			node.x += overlap;
+			node.width -= overlap;
+			break;
+		}
+
+		//neighbours at the same height become one segment
+		for (size_t i = 0; i + 1 < skyline.size();)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else ++i;
+		}
+	}
+}
+
+void MergeFreeRect(
+	vector<AtlasRect>& freeRects,
+	size_t index)
+{
+	bool didMerge = true;
+	while (didMerge)
+	{
+		didMerge = false;
+
+		AtlasRect& merged = freeRects[index];
+		for (size_t i = 0; i < freeRects.size(); ++i)
+		{
+			if (i == index) continue;
+
+			const AtlasRect& other = freeRects[i];
+
+			bool isSameColumn = other.x == merged.x
+				&& other.width == merged.width;
+			bool isSameRow = other.y == merged.y
+				&& other.height == merged.height;
+
+			if (isSameColumn
+				&& other.y + other.height == merged.y)
+			{
+				merged.y = other.y;
+				merged.height += other.height;
+			}
+			else if (isSameColumn
+				&& merged.y + merged.height == other.y)
+			{
+				merged.height += other.height;
+			}
+			else if (isSameRow
+				&& other.x + other.width == merged.x)
+			{
+				merged.x = other.x;
+				merged.width += other.width;
+			}
+			else if (isSameRow
+				&& merged.x + merged.width == other.x)
+			{
+				merged.width += other.width;
+			}
+			else continue;
+
+			//the last rect takes the freed spot, so the merged rect may move with it
+			freeRects[i] = freeRects.back();
+			freeRects.pop_back();
+			if (index == freeRects.size()) index = i;
+
+			didMerge = true;
+			break;
+		}
+	}
+}
\ No newline at end of file
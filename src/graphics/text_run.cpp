@@ -0,0 +1,2113 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+#include <unordered_map>
+#include <array>
+#include <list>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TEXT_RUN_USE_SSE2
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "KalaWindow/include/graphics/opengl/opengl.hpp"
+#include "KalaWindow/include/graphics/opengl/opengl_shader.hpp"
+#include "KalaWindow/include/graphics/opengl/opengl_functions_core.hpp"
+
+#include "core/scheduler.hpp"
+#include "core/pool_allocator.hpp"
+#include "graphics/text_run.hpp"
+#include "graphics/scene.hpp"
+#include "graphics/sdf_atlas.hpp"
+#include "graphics/text_style.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::vec2;
+using KalaHeaders::vec3;
+
+using KalaWindow::Graphics::OpenGL::OpenGL_Global;
+using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+using KalaWindow::Graphics::OpenGL::ShaderType;
+using namespace KalaWindow::Graphics::OpenGLFunctions;
+
+using KalaFont::FlatFontData;
+using KalaFont::FlatGlyph;
+using KalaFont::GlyphView;
+using KalaFont::MappedKalaFont;
+using KalaFont::KalaFontCodepointEntryV2;
+
+using Solin::Core::FrameScheduler;
+using Solin::Core::PoolAllocator;
+using Solin::Graphics::TextFont;
+using Solin::Graphics::TextRun;
+using Solin::Graphics::RunGlyph;
+using Solin::Graphics::LineLayout;
+using Solin::Graphics::LineLayoutCache;
+using Solin::Graphics::LayoutCacheStats;
+using Solin::Graphics::RetainedScene;
+using Solin::Graphics::SdfAtlas;
+using Solin::Graphics::SdfAtlasData;
+using Solin::Graphics::SdfGlyph;
+using Solin::Graphics::TextStyle;
+using Solin::Graphics::TextStyleTable;
+
+using std::unordered_map;
+using std::list;
+using std::shared_ptr;
+using std::allocate_shared;
+using std::equal_to;
+using std::pair;
+using std::array;
+using std::vector;
+using std::string;
+using std::string_view;
+using std::find;
+using std::max;
+using std::move;
+using std::prev;
+using std::to_string;
+using std::span;
+using std::fabs;
+using std::ceil;
+using std::countr_zero;
+using std::filesystem::path;
+
+//Per instance data of one glyph occurrence, uploaded as is.
+//The look of the glyph comes from the style table, so no uniforms are set per draw
+struct GlyphInstance
+{
+	vec2 origin{}; //pen position on the baseline in pixels
+	f32 scale{};   //pixels per em
+	f32 style{};   //index into the style table
+};
+
+static_assert(sizeof(GlyphInstance) == 4 * sizeof(f32), "GlyphInstance must stay tightly packed for upload");
+
+//Per instance data of one SDF glyph quad, uploaded as is
+struct SdfQuadInstance
+{
+	vec2 origin{}; //pen position on the baseline in pixels
+	f32 scale{};   //pixels per em
+	f32 style{};   //index into the style table
+	vec2 planeMin{};
+	vec2 planeMax{};
+	vec2 uvMin{};
+	vec2 uvMax{};
+};
+
+static_assert(sizeof(SdfQuadInstance) == 12 * sizeof(f32), "SdfQuadInstance must stay tightly packed for upload");
+
+static_assert(
+	TextStyleTable::MAX_STYLES * TextStyleTable::VEC4_PER_STYLE == 896,
+	"The TextStyles block of the run shaders must match the style table");
+
+//uniform buffer binding point of the style table
+constexpr u32 STYLE_BINDING = 0;
+
+static constexpr string_view shader_run_vertex =
+R"(
+	#version 330 core
+
+	layout (location = 0) in vec2 aPos;
+	layout (location = 1) in vec2 iOrigin;
+	layout (location = 2) in float iScale;
+	layout (location = 3) in float iStyle;
+
+	layout (std140) uniform TextStyles
+	{
+		vec4 uStyles[896];
+	};
+
+	out vec2 LocalPos;
+	flat out int Style;
+
+	uniform mat4 uProjection;
+
+	void main()
+	{
+		Style = int(iStyle);
+
+		//x is italic skew, y is kerning offset
+		vec4 shape = uStyles[Style * 7 + 1];
+
+		vec2 pos = aPos;
+		pos.x += shape.y + pos.y * shape.x;
+
+		gl_Position = uProjection * vec4(iOrigin + pos * iScale, 0.0, 1.0);
+		LocalPos = aPos;
+	}
+)";
+
+static constexpr string_view shader_run_fragment =
+R"(
+	#version 330 core
+
+	in vec2 LocalPos;
+	flat in int Style;
+	out vec4 FragColor;
+
+	layout (std140) uniform TextStyles
+	{
+		vec4 uStyles[896];
+	};
+
+	void main()
+	{
+		int base = Style * 7;
+		vec4 colorOpacity = uStyles[base];
+		vec4 shape = uStyles[base + 1];
+		int flags = int(shape.z);
+
+		float safeOpacity = clamp(colorOpacity.a, 0.0, 1.0);
+		if (safeOpacity < 0.1) discard;
+
+		vec3 color = clamp(colorOpacity.rgb, 0.0, 1.0);
+
+		//meshes have no distance field, so shadow and glow are not drawn here
+		if ((flags & 1) != 0)
+		{
+			vec4 underline = uStyles[base + 2];
+			float offset = clamp(uStyles[base + 3].x, -1.0, 1.0);
+			float thickness = clamp(underline.w, 0.0, 1.0);
+
+			if (LocalPos.y > offset
+				&& LocalPos.y < offset + thickness)
+			{
+				color = mix(color, clamp(underline.rgb, 0.0, 1.0), clamp(shape.w, 0.0, 1.0));
+			}
+		}
+		if ((flags & 2) != 0)
+		{
+			vec4 stripe = uStyles[base + 3];
+			vec2 size = clamp(uStyles[base + 4].xy, vec2(0.001), vec2(256.0));
+
+			float value = mod(floor(LocalPos.x * size.x + LocalPos.y * size.y), clamp(stripe.z, 1.0, 8.0));
+			color *= mix(1.0, clamp(stripe.y, 0.0, 1.0), value);
+		}
+
+		FragColor = vec4(color, safeOpacity);
+	}
+)";
+
+static constexpr string_view shader_sdf_vertex =
+R"(
+	#version 330 core
+
+	layout (location = 0) in vec2 aPos;
+	layout (location = 1) in vec4 iOrigin;
+	layout (location = 2) in vec4 iPlane;
+	layout (location = 3) in vec4 iUV;
+
+	layout (std140) uniform TextStyles
+	{
+		vec4 uStyles[896];
+	};
+
+	out vec2 TexCoord;
+	out vec2 LocalPos;
+	flat out vec2 UVPerEm;
+	flat out int Style;
+
+	uniform mat4 uProjection;
+
+	void main()
+	{
+		Style = int(iOrigin.w);
+
+		//x is italic skew, y is kerning offset
+		vec4 shape = uStyles[Style * 7 + 1];
+
+		vec2 local = mix(iPlane.xy, iPlane.zw, aPos);
+
+		vec2 pos = local;
+		pos.x += shape.y + pos.y * shape.x;
+
+		gl_Position = uProjection * vec4(iOrigin.xy + pos * iOrigin.z, 0.0, 1.0);
+
+		TexCoord = mix(iUV.xy, iUV.zw, aPos);
+		LocalPos = local;
+		UVPerEm = (iUV.zw - iUV.xy) / max(iPlane.zw - iPlane.xy, vec2(0.0001));
+	}
+)";
+
+static constexpr string_view shader_sdf_fragment =
+R"(
+	#version 330 core
+
+	in vec2 TexCoord;
+	in vec2 LocalPos;
+	flat in vec2 UVPerEm;
+	flat in int Style;
+	out vec4 FragColor;
+
+	uniform sampler2D uAtlas;
+
+	layout (std140) uniform TextStyles
+	{
+		vec4 uStyles[896];
+	};
+
+	void main()
+	{
+		int base = Style * 7;
+		vec4 colorOpacity = uStyles[base];
+		vec4 shape = uStyles[base + 1];
+		int flags = int(shape.z);
+
+		//0.5 is the outline, the edge is smoothed over about one screen pixel at any size
+		float distance = texture(uAtlas, TexCoord).r;
+		float width = max(fwidth(distance), 0.0001);
+		float coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+
+		float opacity = clamp(colorOpacity.a, 0.0, 1.0);
+		vec3 color = clamp(colorOpacity.rgb, 0.0, 1.0);
+		float alpha = coverage * opacity;
+
+		//glow replaces the shadow like in shader_text
+		bool useShadow = (flags & 4) != 0 && (flags & 8) == 0;
+		if (useShadow)
+		{
+			vec2 offset = clamp(uStyles[base + 4].zw, vec2(-1.0), vec2(1.0)) * UVPerEm;
+			float shadowDistance = texture(uAtlas, TexCoord - offset).r;
+			float shadowCoverage = smoothstep(0.5 - width, 0.5 + width, shadowDistance);
+
+			color = mix(clamp(uStyles[base + 5].rgb, 0.0, 1.0), color, coverage);
+			alpha = max(alpha, shadowCoverage * clamp(uStyles[base + 3].w, 0.0, 1.0) * opacity);
+		}
+		if ((flags & 8) != 0)
+		{
+			vec4 glow = uStyles[base + 6];
+			float radius = clamp(glow.w, 0.0, 0.5);
+			float amount = smoothstep(0.5 - radius, 0.5, distance)
+				* (1.0 - coverage)
+				* clamp(uStyles[base + 5].w, 0.0, 1.0);
+
+			color += clamp(glow.rgb, 0.0, 1.0) * amount;
+			alpha = max(alpha, amount * opacity);
+		}
+		if ((flags & 1) != 0)
+		{
+			vec4 underline = uStyles[base + 2];
+			float offset = clamp(uStyles[base + 3].x, -1.0, 1.0);
+			float thickness = clamp(underline.w, 0.0, 1.0);
+
+			if (LocalPos.y > offset
+				&& LocalPos.y < offset + thickness)
+			{
+				color = mix(color, clamp(underline.rgb, 0.0, 1.0), clamp(shape.w, 0.0, 1.0));
+			}
+		}
+		if ((flags & 2) != 0)
+		{
+			vec4 stripe = uStyles[base + 3];
+			vec2 size = clamp(uStyles[base + 4].xy, vec2(0.001), vec2(256.0));
+
+			float value = mod(floor(LocalPos.x * size.x + LocalPos.y * size.y), clamp(stripe.z, 1.0, 8.0));
+			color *= mix(1.0, clamp(stripe.y, 0.0, 1.0), value);
+		}
+
+		if (alpha < 0.01) discard;
+
+		FragColor = vec4(color, alpha);
+	}
+)";
+
+//two triangles covering the unit square, scaled to each glyph quad
+static constexpr f32 SDF_QUAD_VERTICES[] =
+{
+	0.0f, 0.0f,   1.0f, 0.0f,   1.0f, 1.0f,
+	1.0f, 1.0f,   0.0f, 1.0f,   0.0f, 0.0f
+};
+
+//the instance buffer never shrinks and grows in steps of at least this many glyphs
+constexpr size_t MIN_INSTANCE_CAPACITY = 1024;
+
+struct LoadedFont
+{
+	//glyph meshes stay in the mapped file until a window first draws them
+	MappedKalaFont file{};
+
+	//glyph metrics and the place of each mesh in the font buffers, the arenas stay empty
+	FlatFontData data{};
+	size_t vertexFloats{};
+	size_t indexCount{};
+
+	//codepoints below 128 skip the map lookup
+	array<u32, 128> asciiGlyphs{};
+	unordered_map<u32, u32> codepointGlyphs{};
+
+	f32 fallbackAdvance{};
+
+	//advance shared by every mapped printable ASCII glyph, 0 for proportional fonts
+	f32 cellAdvance{};
+
+	//glyph drawn for each ASCII byte on the monospace path, NONE for unmapped or empty glyphs
+	array<u32, 128> asciiCells{};
+
+	path fontPath{};
+
+	SdfAtlasData sdf{};
+	bool hasSdf{};
+	u32 sdfVersion{}; //bumped when the atlas is replaced so windows upload it again
+};
+
+enum class GlyphUpload : u8
+{
+	GLYPH_PENDING,  //not drawn in this window yet
+	GLYPH_UPLOADED,
+	GLYPH_FAILED    //mesh could not be read, the glyph is skipped
+};
+
+//Glyph meshes and SDF atlas of one font uploaded to one window
+struct FontBuffers
+{
+	u32 VAO{};
+	u32 VBO{};
+	u32 EBO{};
+
+	//buffers are sized for the whole font, each mesh is uploaded the first time it is drawn
+	vector<GlyphUpload> glyphs{};
+
+	u32 sdfTexture{};
+	u32 sdfVersion{};
+};
+
+//Instances of one glyph of one font, drawn with one call
+struct GlyphDraw
+{
+	u32 fontID{};
+	u32 glyph{};
+	u32 firstInstance{};
+	u32 instanceCount{};
+};
+
+//Quads of every glyph of one SDF font, drawn with one call
+struct SdfDraw
+{
+	u32 fontID{};
+	u32 firstInstance{};
+	u32 instanceCount{};
+};
+
+struct RunTarget
+{
+	u32 instanceVBO{};
+	size_t capacityBytes{};
+
+	OpenGL_Shader* shader{};
+
+	u32 sdfVAO{};
+	u32 sdfQuadVBO{};
+	u32 sdfInstanceVBO{};
+	size_t sdfCapacityBytes{};
+
+	OpenGL_Shader* sdfShader{};
+
+	u32 styleUBO{};
+	u32 styleVersion{}; //style table version last uploaded
+
+	unordered_map<u32, FontBuffers> fonts{};
+
+	vector<GlyphInstance> instances{};
+	vector<GlyphDraw> draws{};
+
+	vector<SdfQuadInstance> sdfInstances{};
+	vector<SdfDraw> sdfDraws{};
+};
+
+//Identifies a laid out line, positions are in em so the font size is not part of it
+struct LayoutKey
+{
+	u64 textHash{};
+	u32 fontID{};
+	u32 tabWidth{};
+
+	bool operator==(const LayoutKey& other) const = default;
+};
+
+struct LayoutKeyHash
+{
+	size_t operator()(const LayoutKey& key) const
+	{
+		u64 extra = (static_cast<u64>(key.fontID) << 32) | key.tabWidth;
+		return static_cast<size_t>(key.textHash ^ (extra * 0x9E3779B97F4A7C15ULL));
+	}
+};
+
+struct CachedLine
+{
+	LayoutKey key{};
+
+	//kept to tell hash collisions apart from hits
+	string text{};
+
+	shared_ptr<const LineLayout> layout{};
+	size_t bytes{};
+};
+
+struct WindowRuns
+{
+	vector<TextRun*> runs{};
+
+	//a run changed since the instances were last built
+	bool isDirty = true;
+};
+
+static unordered_map<u32, LoadedFont> fonts{};
+static unordered_map<u32, WindowRuns> windowRuns{};
+static unordered_map<u32, RunTarget> targets{};
+
+static u32 nextFontID = 1;
+
+//most recently used lines are at the front
+//lines are cached and evicted all the time while text scrolls, pooled nodes reuse the freed ones
+using CachedLineList = list<CachedLine, PoolAllocator<CachedLine>>;
+
+static CachedLineList cachedLines{};
+static unordered_map<
+	LayoutKey,
+	CachedLineList::iterator,
+	LayoutKeyHash,
+	equal_to<LayoutKey>,
+	PoolAllocator<pair<const LayoutKey, CachedLineList::iterator>>> cachedLineLookup{};
+static size_t layoutBudget = LineLayoutCache::DEFAULT_BUDGET;
+static LayoutCacheStats layoutStats{};
+
+//instancing and base vertex drawing are core in 3.3 but not part of the KalaWindow function table
+static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC glDrawElementsInstancedBaseVertexProc{};
+static PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc{};
+static PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstancedProc{};
+
+static bool LoadRunFunctions();
+static void SetInstanceAttributes(u32 firstInstance);
+static void SetSdfInstanceAttributes(u32 firstInstance);
+static void UploadInstances(
+	u32 VBO,
+	size_t& capacityBytes,
+	const void* data,
+	size_t bytes);
+static bool UploadSdfTexture(
+	const LoadedFont& font,
+	FontBuffers& buffers);
+static void DeleteFontBuffers(FontBuffers& buffers);
+static void BindStyleBlock(const OpenGL_Shader* shader);
+static void UpdateMonospace(LoadedFont& font);
+static u32 LayoutMonospace(
+	const LoadedFont& font,
+	u32 fontID,
+	string_view text,
+	RunGlyph* outGlyphs,
+	u32& outColumns);
+static u32 GetColumnWidth(u32 codepoint);
+static void LayoutLine(
+	const LoadedFont& font,
+	u32 fontID,
+	string_view text,
+	LineLayout& outLayout);
+static u64 HashText(string_view text);
+static shared_ptr<const LineLayout> FindCachedLayout(
+	const LayoutKey& key,
+	string_view text);
+static void CacheLayout(
+	const LayoutKey& key,
+	string_view text,
+	const shared_ptr<const LineLayout>& layout);
+static void EvictCachedLine(CachedLineList::iterator it);
+static void MarkWindowDirty(u32 windowID);
+static void BuildDraws(
+	WindowRuns& window,
+	RunTarget& target);
+static bool UploadFont(
+	u32 fontID,
+	const LoadedFont& font,
+	RunTarget& target,
+	FontBuffers& outBuffers);
+
+//Uploads the mesh of one glyph into the bound font buffers and returns the uploaded bytes
+static size_t UploadGlyph(
+	LoadedFont& font,
+	u32 glyph,
+	RunTarget& target,
+	FontBuffers& buffers);
+
+//Copies the mesh of one glyph out of the mapped font with the glyph transform applied,
+//so the shader only scales and moves. The spans must match the glyph counts
+static bool ReadGlyphMesh(
+	LoadedFont& font,
+	u32 glyph,
+	span<f32> outVertices,
+	span<u32> outIndices);
+static u32 DecodeUTF8(
+	string_view text,
+	size_t& index);
+
+namespace Solin::Graphics
+{
+	//
+	// TEXT FONT
+	//
+
+	u32 TextFont::LoadFont(const path& fontPath)
+	{
+		PROFILE_ZONE("TextFont::LoadFont");
+
+		LoadedFont font{};
+		if (!font.file.Open(fontPath)) return 0;
+
+		FlatFontData& data = font.data;
+		data.glyphs.reserve(font.file.GetGlyphCount());
+
+		//only metrics are read here, meshes are decoded when a window first draws the glyph
+		for (u32 g = 0; g < font.file.GetGlyphCount(); ++g)
+		{
+			GlyphView view{};
+			u32 vertexFloats{};
+			u32 indexCount{};
+			font.file.GetGlyphInfo(g, view, vertexFloats, indexCount);
+
+			FlatGlyph glyph{};
+
+			glyph.vertexOffset = static_cast<u32>(font.vertexFloats);
+			glyph.vertexFloats = vertexFloats;
+			glyph.indexOffset = static_cast<u32>(font.indexCount);
+			glyph.indexCount = indexCount;
+
+			glyph.anchor = view.anchor;
+			glyph.transform = view.transform;
+			glyph.glyphIndex = view.glyphIndex;
+			glyph.advanceWidth = view.advanceWidth;
+			glyph.leftSideBearing = view.leftSideBearing;
+
+			font.vertexFloats += vertexFloats;
+			font.indexCount += indexCount;
+
+			data.glyphs.push_back(glyph);
+		}
+
+		for (u32 c = 0; c < font.file.GetCodepointCount(); ++c)
+		{
+			KalaFontCodepointEntryV2 entry{};
+			if (font.file.GetCodepointEntry(c, entry)
+				&& entry.glyph < data.glyphs.size())
+			{
+				data.codepoints.push_back(entry);
+			}
+		}
+
+		font.asciiGlyphs.fill(NONE);
+		for (const auto& entry : data.codepoints)
+		{
+			if (entry.codepoint < font.asciiGlyphs.size()) font.asciiGlyphs[entry.codepoint] = entry.glyph;
+			else font.codepointGlyphs[entry.codepoint] = entry.glyph;
+		}
+
+		f32 advanceSum{};
+		for (const FlatGlyph& glyph : data.glyphs) advanceSum += glyph.advanceWidth;
+
+		font.fallbackAdvance = data.glyphs.empty()
+			? 0.5f
+			: advanceSum / static_cast<f32>(data.glyphs.size());
+
+		//fonts that map space use its real advance
+		u32 space = font.asciiGlyphs[' '];
+		if (space != NONE) font.fallbackAdvance = data.glyphs[space].advanceWidth;
+
+		UpdateMonospace(font);
+
+		font.fontPath = fontPath;
+
+		u32 fontID = nextFontID++;
+		fonts[fontID] = move(font);
+
+		return fontID;
+	}
+
+	void TextFont::UnloadFont(u32 fontID)
+	{
+		//uploaded copies are deleted by the renderer on its next draw of each window
+		fonts.erase(fontID);
+		LineLayoutCache::InvalidateFont(fontID);
+	}
+
+	void TextFont::MapCodepoint(
+		u32 fontID,
+		u32 codepoint,
+		u32 glyphIndex)
+	{
+		auto it = fonts.find(fontID);
+		if (it == fonts.end()) return;
+
+		LoadedFont& font = it->second;
+
+		u32 glyph = NONE;
+		for (u32 g = 0; g < font.data.glyphs.size(); ++g)
+		{
+			if (font.data.glyphs[g].glyphIndex == glyphIndex)
+			{
+				glyph = g;
+				break;
+			}
+		}
+		if (glyph == NONE) return;
+
+		if (codepoint < font.asciiGlyphs.size()) font.asciiGlyphs[codepoint] = glyph;
+		else font.codepointGlyphs[codepoint] = glyph;
+
+		if (codepoint == ' ') font.fallbackAdvance = font.data.glyphs[glyph].advanceWidth;
+		if (codepoint < font.asciiGlyphs.size()) UpdateMonospace(font);
+
+		LineLayoutCache::InvalidateFont(fontID);
+
+		for (auto& [windowID, window] : windowRuns)
+		{
+			for (TextRun* run : window.runs)
+			{
+				if (run->GetFontID() == fontID) run->Refresh();
+			}
+		}
+	}
+
+	u32 TextFont::FindGlyph(
+		u32 fontID,
+		u32 codepoint)
+	{
+		auto it = fonts.find(fontID);
+		if (it == fonts.end()) return NONE;
+
+		const LoadedFont& font = it->second;
+
+		if (codepoint < font.asciiGlyphs.size()) return font.asciiGlyphs[codepoint];
+
+		auto glyph = font.codepointGlyphs.find(codepoint);
+		return glyph != font.codepointGlyphs.end()
+			? glyph->second
+			: NONE;
+	}
+
+	const FlatFontData* TextFont::GetFontData(u32 fontID)
+	{
+		auto it = fonts.find(fontID);
+		return it != fonts.end()
+			? &it->second.data
+			: nullptr;
+	}
+
+	bool TextFont::EnableSdf(
+		u32 fontID,
+		u32 pixelSize,
+		const path& cacheDir)
+	{
+		auto it = fonts.find(fontID);
+		if (it == fonts.end()) return false;
+
+		LoadedFont& font = it->second;
+
+		//the atlas is built from every mesh of the font, they are only held until it exists
+		FlatFontData meshes = font.data;
+		meshes.vertices.resize(font.vertexFloats);
+		meshes.indices.resize(font.indexCount);
+
+		for (u32 g = 0; g < meshes.glyphs.size(); ++g)
+		{
+			const FlatGlyph& glyph = meshes.glyphs[g];
+			if (!ReadGlyphMesh(
+				font,
+				g,
+				span<f32>(meshes.vertices).subspan(glyph.vertexOffset, glyph.vertexFloats),
+				span<u32>(meshes.indices).subspan(glyph.indexOffset, glyph.indexCount)))
+			{
+				return false;
+			}
+		}
+
+		if (!SdfAtlas::LoadOrBuild(
+			font.fontPath,
+			meshes,
+			pixelSize,
+			cacheDir,
+			font.sdf))
+		{
+			return false;
+		}
+
+		font.hasSdf = true;
+		++font.sdfVersion;
+
+		for (auto& [windowID, window] : windowRuns)
+		{
+			for (const TextRun* run : window.runs)
+			{
+				if (run->GetFontID() != fontID) continue;
+
+				MarkWindowDirty(windowID);
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	const SdfAtlasData* TextFont::GetSdfAtlas(u32 fontID)
+	{
+		auto it = fonts.find(fontID);
+		return it != fonts.end()
+			&& it->second.hasSdf
+			? &it->second.sdf
+			: nullptr;
+	}
+
+	f32 TextFont::GetCellAdvance(u32 fontID)
+	{
+		auto it = fonts.find(fontID);
+		return it != fonts.end()
+			? it->second.cellAdvance
+			: 0.0f;
+	}
+
+	f32 TextFont::GetFallbackAdvance(u32 fontID)
+	{
+		auto it = fonts.find(fontID);
+		return it != fonts.end()
+			? it->second.fallbackAdvance
+			: 0.0f;
+	}
+
+	//
+	// TEXT RUN
+	//
+
+	bool TextRun::Initialize(
+		u32 newWindowID,
+		u32 newFontID,
+		vec2 newOrigin,
+		f32 newFontSize)
+	{
+		if (!TextFont::GetFontData(newFontID))
+		{
+			Log::Print(
+				"Cannot create a text run because font '" + to_string(newFontID) + "' is not loaded!",
+				"TEXT_RUN",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		Shutdown();
+
+		windowID = newWindowID;
+		fontID = newFontID;
+		origin = newOrigin;
+		fontSize = newFontSize;
+
+		windowRuns[windowID].runs.push_back(this);
+
+		Layout();
+
+		return true;
+	}
+
+	void TextRun::Shutdown()
+	{
+		if (fontID == 0) return;
+
+		auto it = windowRuns.find(windowID);
+		if (it != windowRuns.end())
+		{
+			vector<TextRun*>& runs = it->second.runs;
+
+			auto self = find(runs.begin(), runs.end(), this);
+			if (self != runs.end())
+			{
+				*self = runs.back();
+				runs.pop_back();
+			}
+		}
+		MarkWindowDirty(windowID);
+
+		text.clear();
+		layout.reset();
+
+		windowID = 0;
+		fontID = 0;
+	}
+
+	void TextRun::SetText(string_view utf8)
+	{
+		if (fontID == 0
+			|| text == utf8)
+		{
+			return;
+		}
+
+		text = utf8;
+		Layout();
+	}
+
+	void TextRun::SetOrigin(vec2 newOrigin)
+	{
+		if (origin == newOrigin) return;
+
+		origin = newOrigin;
+		MarkWindowDirty(windowID);
+	}
+
+	void TextRun::SetFontSize(f32 newFontSize)
+	{
+		if (fontSize == newFontSize) return;
+
+		fontSize = newFontSize;
+		MarkWindowDirty(windowID);
+	}
+
+	void TextRun::SetColor(vec3 newColor)
+	{
+		if (style.color == newColor) return;
+
+		TextStyle newStyle = style;
+		newStyle.color = newColor;
+		SetStyle(newStyle);
+	}
+
+	void TextRun::SetOpacity(f32 newOpacity)
+	{
+		if (style.opacity == newOpacity) return;
+
+		TextStyle newStyle = style;
+		newStyle.opacity = newOpacity;
+		SetStyle(newStyle);
+	}
+
+	void TextRun::SetStyle(const TextStyle& newStyle)
+	{
+		style = newStyle;
+
+		//equal styles share one table entry, so only a changed index needs new instances.
+		//The old style is released after the new one is taken so an unchanged style keeps its slot
+		u16 newIndex = TextStyleTable::Intern(style);
+		TextStyleTable::Release(styleIndex);
+
+		if (newIndex == styleIndex) return;
+
+		styleIndex = newIndex;
+		MarkWindowDirty(windowID);
+	}
+
+	void TextRun::SetVisible(bool newValue)
+	{
+		if (isVisible == newValue) return;
+
+		isVisible = newValue;
+		MarkWindowDirty(windowID);
+	}
+
+	void TextRun::Refresh()
+	{
+		if (fontID != 0) Layout();
+	}
+
+	void TextRun::Layout()
+	{
+		PROFILE_ZONE("TextRun::Layout");
+
+		layout.reset();
+
+		auto fontIt = fonts.find(fontID);
+		if (fontIt == fonts.end()) return;
+
+		//lines already laid out by any run are shared instead of laid out again,
+		//so scrolling through unchanged text only hashes it
+		LayoutKey key
+		{
+			.textHash = HashText(text),
+			.fontID = fontID,
+			.tabWidth = TAB_WIDTH
+		};
+
+		layout = FindCachedLayout(key, text);
+		if (!layout)
+		{
+			auto newLayout = allocate_shared<LineLayout>(PoolAllocator<LineLayout>());
+			LayoutLine(fontIt->second, fontID, text, *newLayout);
+
+			layout = newLayout;
+			CacheLayout(key, text, layout);
+		}
+
+		MarkWindowDirty(windowID);
+	}
+
+	//
+	// LINE LAYOUT CACHE
+	//
+
+	void LineLayoutCache::SetBudget(size_t bytes)
+	{
+		layoutBudget = bytes;
+		while (layoutStats.usedBytes > layoutBudget)
+		{
+			EvictCachedLine(prev(cachedLines.end()));
+			++layoutStats.evictions;
+		}
+	}
+
+	size_t LineLayoutCache::GetBudget()
+	{
+		return layoutBudget;
+	}
+
+	void LineLayoutCache::InvalidateFont(u32 fontID)
+	{
+		for (auto it = cachedLines.begin(); it != cachedLines.end();)
+		{
+			auto next = std::next(it);
+			if (it->key.fontID == fontID) EvictCachedLine(it);
+			it = next;
+		}
+	}
+
+	void LineLayoutCache::Clear()
+	{
+		cachedLines.clear();
+		cachedLineLookup.clear();
+
+		layoutStats.entryCount = 0;
+		layoutStats.usedBytes = 0;
+	}
+
+	void LineLayoutCache::ResetCounters()
+	{
+		layoutStats.hits = 0;
+		layoutStats.misses = 0;
+		layoutStats.evictions = 0;
+	}
+
+	const LayoutCacheStats& LineLayoutCache::GetStats()
+	{
+		return layoutStats;
+	}
+
+	//
+	// TEXT RUN RENDERER
+	//
+
+	bool TextRunRenderer::Initialize(u32 windowID)
+	{
+		if (targets.contains(windowID)) return true;
+
+		if (!LoadRunFunctions())
+		{
+			Log::Print(
+				"Instanced base vertex drawing is not available, text runs will not be drawn.",
+				"TEXT_RUN",
+				LogType::LOG_WARNING);
+
+			return false;
+		}
+
+		OpenGL_Shader* shader = OpenGL_Shader::CreateShader(
+			windowID,
+			"text_run",
+			{ {
+				{.shaderData = string(shader_run_vertex), .type = ShaderType::SHADER_VERTEX },
+				{.shaderData = string(shader_run_fragment), .type = ShaderType::SHADER_FRAGMENT }
+			} });
+
+		if (!shader)
+		{
+			Log::Print(
+				"Failed to create the text run shader, text runs will not be drawn.",
+				"TEXT_RUN",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		OpenGL_Shader* sdfShader = OpenGL_Shader::CreateShader(
+			windowID,
+			"text_run_sdf",
+			{ {
+				{.shaderData = string(shader_sdf_vertex), .type = ShaderType::SHADER_VERTEX },
+				{.shaderData = string(shader_sdf_fragment), .type = ShaderType::SHADER_FRAGMENT }
+			} });
+
+		if (!sdfShader)
+		{
+			Log::Print(
+				"Failed to create the SDF text run shader, text runs will not be drawn.",
+				"TEXT_RUN",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		//both shaders read the style table from the same binding point
+		BindStyleBlock(shader);
+		BindStyleBlock(sdfShader);
+
+		RunTarget target{};
+		target.shader = shader;
+		target.sdfShader = sdfShader;
+		target.capacityBytes = MIN_INSTANCE_CAPACITY * sizeof(GlyphInstance);
+		target.sdfCapacityBytes = MIN_INSTANCE_CAPACITY * sizeof(SdfQuadInstance);
+
+		glGenBuffers(1, &target.instanceVBO);
+		glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			static_cast<GLsizeiptr>(target.capacityBytes),
+			nullptr,
+			GL_DYNAMIC_DRAW);
+
+		//SDF glyphs are all the same unit quad, only their instances differ
+		glGenVertexArrays(1, &target.sdfVAO);
+		glGenBuffers(1, &target.sdfQuadVBO);
+		glGenBuffers(1, &target.sdfInstanceVBO);
+
+		glBindVertexArray(target.sdfVAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, target.sdfQuadVBO);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			sizeof(SDF_QUAD_VERTICES),
+			SDF_QUAD_VERTICES,
+			GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), nullptr);
+
+		glBindBuffer(GL_ARRAY_BUFFER, target.sdfInstanceVBO);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			static_cast<GLsizeiptr>(target.sdfCapacityBytes),
+			nullptr,
+			GL_DYNAMIC_DRAW);
+
+		for (u32 location = 1; location <= 3; ++location)
+		{
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisorProc(location, 1);
+		}
+		SetSdfInstanceAttributes(0);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//sized for the full table once, styles are only ever appended
+		glGenBuffers(1, &target.styleUBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, target.styleUBO);
+		glBufferData(
+			GL_UNIFORM_BUFFER,
+			static_cast<GLsizeiptr>(TextStyleTable::MAX_STYLES * TextStyleTable::VEC4_PER_STYLE * 4 * sizeof(f32)),
+			nullptr,
+			GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		targets[windowID] = move(target);
+		windowRuns[windowID].isDirty = true;
+
+		return true;
+	}
+
+	bool TextRunRenderer::IsAvailable(u32 windowID)
+	{
+		return targets.contains(windowID);
+	}
+
+	void TextRunRenderer::Draw(
+		u32 windowID,
+		const mat4& projection)
+	{
+		PROFILE_ZONE("TextRunRenderer::Draw");
+
+		auto targetIt = targets.find(windowID);
+		auto windowIt = windowRuns.find(windowID);
+		if (targetIt == targets.end()
+			|| windowIt == windowRuns.end())
+		{
+			return;
+		}
+
+		RunTarget& target = targetIt->second;
+		WindowRuns& window = windowIt->second;
+
+		for (auto it = target.fonts.begin(); it != target.fonts.end();)
+		{
+			if (fonts.contains(it->first))
+			{
+				++it;
+				continue;
+			}
+
+			DeleteFontBuffers(it->second);
+			it = target.fonts.erase(it);
+		}
+
+		//instances are only rebuilt and uploaded after a run changed,
+		//redraws for other reasons reuse the buffer as is
+		if (window.isDirty)
+		{
+			BuildDraws(window, target);
+
+			size_t bytes = target.instances.size() * sizeof(GlyphInstance);
+			size_t sdfBytes = target.sdfInstances.size() * sizeof(SdfQuadInstance);
+
+			UploadInstances(
+				target.instanceVBO,
+				target.capacityBytes,
+				target.instances.data(),
+				bytes);
+			UploadInstances(
+				target.sdfInstanceVBO,
+				target.sdfCapacityBytes,
+				target.sdfInstances.data(),
+				sdfBytes);
+
+			stats.uploadedBytes += bytes + sdfBytes;
+			window.isDirty = false;
+		}
+
+		stats.runCount += static_cast<u32>(window.runs.size());
+		u32 glyphsBefore = stats.glyphCount;
+
+		if (target.draws.empty()
+			&& target.sdfDraws.empty())
+		{
+			return;
+		}
+
+		//new styles are uploaded once for every window instead of set per draw
+		if (target.styleVersion != TextStyleTable::GetVersion())
+		{
+			span<const f32> packed = TextStyleTable::GetPackedData();
+			size_t styleBytes = packed.size() * sizeof(f32);
+
+			glBindBuffer(GL_UNIFORM_BUFFER, target.styleUBO);
+			glBufferSubData(
+				GL_UNIFORM_BUFFER,
+				0,
+				static_cast<GLsizeiptr>(styleBytes),
+				packed.data());
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			stats.uploadedBytes += styleBytes;
+			target.styleVersion = TextStyleTable::GetVersion();
+		}
+		glBindBufferBase(GL_UNIFORM_BUFFER, STYLE_BINDING, target.styleUBO);
+
+		//runs are drawn over all widgets
+		glDisable(GL_DEPTH_TEST);
+
+		//every instance would otherwise need the style uniforms of shader_text set before its draw
+		u32 uniformCalls{};
+
+		if (!target.draws.empty()
+			&& target.shader->Bind())
+		{
+			u32 programID = target.shader->GetProgramID();
+			target.shader->SetMat4(programID, "uProjection", projection);
+			++uniformCalls;
+
+			u32 boundFont{};
+			FontBuffers* boundBuffers{};
+			for (const GlyphDraw& draw : target.draws)
+			{
+				auto fontIt = fonts.find(draw.fontID);
+				if (fontIt == fonts.end()) continue;
+
+				if (draw.fontID != boundFont)
+				{
+					FontBuffers& buffers = target.fonts[draw.fontID];
+					if (buffers.VAO == 0
+						&& !UploadFont(draw.fontID, fontIt->second, target, buffers))
+					{
+						continue;
+					}
+
+					glBindVertexArray(buffers.VAO);
+					glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+					boundFont = draw.fontID;
+					boundBuffers = &buffers;
+				}
+
+				if (boundBuffers->glyphs[draw.glyph] == GlyphUpload::GLYPH_PENDING)
+				{
+					stats.uploadedBytes += UploadGlyph(fontIt->second, draw.glyph, target, *boundBuffers);
+				}
+				if (boundBuffers->glyphs[draw.glyph] != GlyphUpload::GLYPH_UPLOADED) continue;
+
+				const FlatGlyph& glyph = fontIt->second.data.glyphs[draw.glyph];
+
+				//3.3 has no base instance, so the instance attributes are offset instead
+				SetInstanceAttributes(draw.firstInstance);
+
+				glDrawElementsInstancedBaseVertexProc(
+					GL_TRIANGLES,
+					static_cast<GLsizei>(glyph.indexCount),
+					GL_UNSIGNED_INT,
+					reinterpret_cast<const void*>(static_cast<size_t>(glyph.indexOffset) * sizeof(u32)),
+					static_cast<GLsizei>(draw.instanceCount),
+					static_cast<GLint>(glyph.vertexOffset / 2));
+
+				stats.glyphCount += draw.instanceCount;
+				++stats.drawCalls;
+			}
+		}
+
+		if (!target.sdfDraws.empty()
+			&& target.sdfShader->Bind())
+		{
+			u32 programID = target.sdfShader->GetProgramID();
+			target.sdfShader->SetMat4(programID, "uProjection", projection);
+			target.sdfShader->SetInt(programID, "uAtlas", 0);
+			uniformCalls += 2;
+
+			//SDF edges are antialiased through alpha, the blend state is restored afterwards
+			GLboolean wasBlending{};
+			glGetBooleanv(GL_BLEND, &wasBlending);
+
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			glActiveTexture(GL_TEXTURE0);
+			glBindVertexArray(target.sdfVAO);
+			glBindBuffer(GL_ARRAY_BUFFER, target.sdfInstanceVBO);
+
+			for (const SdfDraw& draw : target.sdfDraws)
+			{
+				auto fontIt = fonts.find(draw.fontID);
+				if (fontIt == fonts.end()) continue;
+
+				FontBuffers& buffers = target.fonts[draw.fontID];
+				if (buffers.sdfVersion != fontIt->second.sdfVersion
+					&& !UploadSdfTexture(fontIt->second, buffers))
+				{
+					continue;
+				}
+
+				//one texture bind and one draw for every glyph of the font
+				glBindTexture(GL_TEXTURE_2D, buffers.sdfTexture);
+				SetSdfInstanceAttributes(draw.firstInstance);
+
+				glDrawArraysInstancedProc(
+					GL_TRIANGLES,
+					0,
+					6,
+					static_cast<GLsizei>(draw.instanceCount));
+
+				stats.glyphCount += draw.instanceCount;
+				++stats.drawCalls;
+			}
+
+			glBindTexture(GL_TEXTURE_2D, 0);
+			if (!wasBlending) glDisable(GL_BLEND);
+		}
+
+		glBindVertexArray(0);
+		glEnable(GL_DEPTH_TEST);
+
+		u64 legacyCalls = static_cast<u64>(stats.glyphCount - glyphsBefore) * TextStyleTable::UNIFORMS_PER_DRAW;
+		if (legacyCalls > uniformCalls) stats.uniformCallsAvoided += legacyCalls - uniformCalls;
+	}
+
+	void TextRunRenderer::RemoveWindow(
+		u32 windowID,
+		bool isContextAlive)
+	{
+		auto it = targets.find(windowID);
+		if (it != targets.end())
+		{
+			RunTarget& target = it->second;
+
+			if (isContextAlive)
+			{
+				for (auto& [fontID, buffers] : target.fonts) DeleteFontBuffers(buffers);
+
+				glDeleteBuffers(1, &target.instanceVBO);
+				glDeleteBuffers(1, &target.sdfQuadVBO);
+				glDeleteBuffers(1, &target.sdfInstanceVBO);
+				glDeleteVertexArrays(1, &target.sdfVAO);
+				glDeleteBuffers(1, &target.styleUBO);
+			}
+
+			targets.erase(it);
+		}
+
+		//runs that still point at the window are no longer drawn
+		windowRuns.erase(windowID);
+	}
+}
+
+bool LoadRunFunctions()
+{
+	if (glDrawElementsInstancedBaseVertexProc
+		&& glVertexAttribDivisorProc
+		&& glDrawArraysInstancedProc)
+	{
+		return true;
+	}
+
+#ifdef _WIN32
+	//wglGetProcAddress is looked up the same way as glScissor so opengl32.lib does not need to be linked
+	using WGLGetProcAddress = PROC(WINAPI*)(LPCSTR);
+
+	HMODULE openGLLib = ToVar<HMODULE>(OpenGL_Global::GetOpenGLLibrary());
+	if (!openGLLib) return false;
+
+	WGLGetProcAddress wglGetProc = reinterpret_cast<WGLGetProcAddress>(GetProcAddress(openGLLib, "wglGetProcAddress"));
+	if (!wglGetProc) return false;
+
+	glDrawElementsInstancedBaseVertexProc = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC>(wglGetProc("glDrawElementsInstancedBaseVertex"));
+	glVertexAttribDivisorProc = reinterpret_cast<PFNGLVERTEXATTRIBDIVISORPROC>(wglGetProc("glVertexAttribDivisor"));
+	glDrawArraysInstancedProc = reinterpret_cast<PFNGLDRAWARRAYSINSTANCEDPROC>(wglGetProc("glDrawArraysInstanced"));
+#endif
+
+	return glDrawElementsInstancedBaseVertexProc
+		&& glVertexAttribDivisorProc
+		&& glDrawArraysInstancedProc;
+}
+
+void SetInstanceAttributes(u32 firstInstance)
+{
+	constexpr GLsizei stride = sizeof(GlyphInstance);
+	const size_t base = static_cast<size_t>(firstInstance) * sizeof(GlyphInstance);
+
+	auto Offset = [base](size_t member)
+		{
+			return reinterpret_cast<const void*>(base + member);
+		};
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(GlyphInstance, origin)));
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(GlyphInstance, scale)));
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(GlyphInstance, style)));
+}
+
+void SetSdfInstanceAttributes(u32 firstInstance)
+{
+	constexpr GLsizei stride = sizeof(SdfQuadInstance);
+	const size_t base = static_cast<size_t>(firstInstance) * sizeof(SdfQuadInstance);
+
+	auto Offset = [base](size_t member)
+		{
+			return reinterpret_cast<const void*>(base + member);
+		};
+
+	//origin, scale and style, both plane corners and both uv corners are adjacent and read as vec4s
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(SdfQuadInstance, origin)));
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(SdfQuadInstance, planeMin)));
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, Offset(offsetof(SdfQuadInstance, uvMin)));
+}
+
+void UploadInstances(
+	u32 VBO,
+	size_t& capacityBytes,
+	const void* data,
+	size_t bytes)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (bytes > capacityBytes)
+	{
+		capacityBytes = max(bytes, capacityBytes * 2);
+	}
+
+	glBufferData(
+		GL_ARRAY_BUFFER,
+		static_cast<GLsizeiptr>(capacityBytes),
+		nullptr,
+		GL_DYNAMIC_DRAW);
+	if (bytes > 0)
+	{
+		glBufferSubData(
+			GL_ARRAY_BUFFER,
+			0,
+			static_cast<GLsizeiptr>(bytes),
+			data);
+	}
+}
+
+bool UploadSdfTexture(
+	const LoadedFont& font,
+	FontBuffers& buffers)
+{
+	PROFILE_ZONE("TextRunRenderer::UploadSdfTexture");
+
+	const SdfAtlasData& atlas = font.sdf;
+	if (atlas.pixels.empty()) return false;
+
+	if (buffers.sdfTexture == 0) glGenTextures(1, &buffers.sdfTexture);
+	if (buffers.sdfTexture == 0)
+	{
+		Log::Print(
+			"Failed to create an SDF atlas texture!",
+			"TEXT_RUN",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, buffers.sdfTexture);
+
+	//single channel rows are not 4 byte aligned in general
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(
+		GL_TEXTURE_2D,
+		0,
+		GL_R8,
+		static_cast<GLsizei>(atlas.width),
+		static_cast<GLsizei>(atlas.height),
+		0,
+		GL_RED,
+		GL_UNSIGNED_BYTE,
+		atlas.pixels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	buffers.sdfVersion = font.sdfVersion;
+
+	return true;
+}
+
+void DeleteFontBuffers(FontBuffers& buffers)
+{
+	if (buffers.VAO != 0)
+	{
+		glDeleteBuffers(1, &buffers.VBO);
+		glDeleteBuffers(1, &buffers.EBO);
+		glDeleteVertexArrays(1, &buffers.VAO);
+	}
+	if (buffers.sdfTexture != 0) glDeleteTextures(1, &buffers.sdfTexture);
+
+	buffers = {};
+}
+
+void UpdateMonospace(LoadedFont& font)
+{
+	font.cellAdvance = 0.0f;
+	font.asciiCells.fill(TextFont::NONE);
+
+	//the font counts as monospace when all of its printable ASCII glyphs share one advance
+	f32 cell{};
+	for (u32 c = '!'; c <= '~'; ++c)
+	{
+		u32 glyph = font.asciiGlyphs[c];
+		if (glyph == TextFont::NONE) continue;
+
+		f32 glyphAdvance = font.data.glyphs[glyph].advanceWidth;
+		if (cell == 0.0f) cell = glyphAdvance;
+		else if (fabs(glyphAdvance - cell) > cell * 0.001f) return;
+	}
+	if (cell <= 0.0f) return;
+
+	for (u32 c = 0; c < font.asciiGlyphs.size(); ++c)
+	{
+		u32 glyph = font.asciiGlyphs[c];
+		if (glyph != TextFont::NONE
+			&& font.data.glyphs[glyph].indexCount > 0)
+		{
+			font.asciiCells[c] = glyph;
+		}
+	}
+
+	font.cellAdvance = cell;
+}
+
+u32 LayoutMonospace(
+	const LoadedFont& font,
+	u32 fontID,
+	string_view text,
+	RunGlyph* outGlyphs,
+	u32& outColumns)
+{
+	const f32 cell = font.cellAdvance;
+	const u8* bytes = reinterpret_cast<const u8*>(text.data());
+	const size_t size = text.size();
+
+	u32 count{};
+	u32 column{};
+	size_t index{};
+
+	auto PlaceAscii = [&](size_t end)
+		{
+			for (; index < end; ++index, ++column)
+			{
+				u32 glyph = font.asciiCells[bytes[index]];
+				if (glyph != TextFont::NONE) outGlyphs[count++] = { glyph, static_cast<f32>(column) * cell };
+			}
+		};
+
+	while (index < size)
+	{
+		//plain ASCII is placed in bulk up to the next tab or multibyte sequence
+#ifdef TEXT_RUN_USE_SSE2
+		const __m128i tab = _mm_set1_epi8('\t');
+		while (index + 16 <= size)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index));
+
+			//the sign bit marks bytes of multibyte sequences
+			u32 special = static_cast<u32>(
+				_mm_movemask_epi8(chunk)
+				| _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, tab)));
+
+			if (special == 0)
+			{
+				PlaceAscii(index + 16);
+				continue;
+			}
+
+			PlaceAscii(index + countr_zero(special));
+			break;
+		}
+#endif
+		size_t end = index;
+		while (end < size
+			&& bytes[end] < 0x80
+			&& bytes[end] != '\t')
+		{
+			++end;
+		}
+		PlaceAscii(end);
+
+		if (index >= size) break;
+
+		if (bytes[index] == '\t')
+		{
+			column = (column / TextRun::TAB_WIDTH + 1) * TextRun::TAB_WIDTH;
+			++index;
+			continue;
+		}
+
+		u32 codepoint = DecodeUTF8(text, index);
+		u32 glyph = TextFont::FindGlyph(fontID, codepoint);
+		u32 width = GetColumnWidth(codepoint);
+
+		if (width == 1)
+		{
+			if (glyph != TextFont::NONE
+				&& font.data.glyphs[glyph].indexCount > 0)
+			{
+				outGlyphs[count++] = { glyph, static_cast<f32>(column) * cell };
+			}
+
+			++column;
+			continue;
+		}
+
+		//wide and combining characters use their real advance, rounded to whole columns
+		//so the characters after them stay on the grid
+		if (glyph != TextFont::NONE)
+		{
+			const FlatGlyph& flat = font.data.glyphs[glyph];
+			if (flat.indexCount > 0) outGlyphs[count++] = { glyph, static_cast<f32>(column) * cell };
+
+			u32 advanceColumns = static_cast<u32>(ceil(flat.advanceWidth / cell - 0.001f));
+			column += max(width, advanceColumns);
+		}
+		else column += width;
+	}
+
+	outColumns = column;
+	return count;
+}
+
+u32 GetColumnWidth(u32 codepoint)
+{
+	//combining marks and zero width characters
+	if ((codepoint >= 0x0300 && codepoint <= 0x036F)
+		|| (codepoint >= 0x1AB0 && codepoint <= 0x1AFF)
+		|| (codepoint >= 0x1DC0 && codepoint <= 0x1DFF)
+		|| (codepoint >= 0x200B && codepoint <= 0x200F)
+		|| (codepoint >= 0x20D0 && codepoint <= 0x20FF)
+		|| (codepoint >= 0xFE00 && codepoint <= 0xFE0F)
+		|| (codepoint >= 0xFE20 && codepoint <= 0xFE2F))
+	{
+		return 0;
+	}
+
+	//east asian wide and fullwidth blocks and emoji
+	if ((codepoint >= 0x1100 && codepoint <= 0x115F)
+		|| (codepoint >= 0x2E80 && codepoint <= 0x303E)
+		|| (codepoint >= 0x3041 && codepoint <= 0x33FF)
+		|| (codepoint >= 0x3400 && codepoint <= 0x4DBF)
+		|| (codepoint >= 0x4E00 && codepoint <= 0x9FFF)
+		|| (codepoint >= 0xA000 && codepoint <= 0xA4CF)
+		|| (codepoint >= 0xAC00 && codepoint <= 0xD7A3)
+		|| (codepoint >= 0xF900 && codepoint <= 0xFAFF)
+		|| (codepoint >= 0xFE30 && codepoint <= 0xFE4F)
+		|| (codepoint >= 0xFF00 && codepoint <= 0xFF60)
+		|| (codepoint >= 0xFFE0 && codepoint <= 0xFFE6)
+		|| (codepoint >= 0x1F300 && codepoint <= 0x1F64F)
+		|| (codepoint >= 0x1F900 && codepoint <= 0x1F9FF)
+		|| (codepoint >= 0x20000 && codepoint <= 0x3FFFD))
+	{
+		return 2;
+	}
+
+	return 1;
+}
+
+void BindStyleBlock(const OpenGL_Shader* shader)
+{
+	u32 programID = shader->GetProgramID();
+
+	u32 blockIndex = glGetUniformBlockIndex(programID, "TextStyles");
+	if (blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(programID, blockIndex, STYLE_BINDING);
+}
+
+void LayoutLine(
+	const LoadedFont& font,
+	u32 fontID,
+	string_view text,
+	LineLayout& outLayout)
+{
+	vector<RunGlyph>& glyphs = outLayout.glyphs;
+	f32& advance = outLayout.advance;
+
+	//monospace fonts place glyphs by column without reading glyph metrics,
+	//every byte makes at most one glyph so the glyphs are written in place
+	if (font.cellAdvance > 0.0f)
+	{
+		glyphs.resize(text.size());
+
+		u32 columns{};
+		u32 count = LayoutMonospace(
+			font,
+			fontID,
+			text,
+			glyphs.data(),
+			columns);
+
+		glyphs.resize(count);
+		advance = static_cast<f32>(columns) * font.cellAdvance;
+
+		return;
+	}
+
+	const FlatFontData& data = font.data;
+	f32 fallbackAdvance = font.fallbackAdvance;
+
+	size_t index{};
+	while (index < text.size())
+	{
+		u32 codepoint = DecodeUTF8(text, index);
+
+		if (codepoint == '\t')
+		{
+			advance += fallbackAdvance * TextRun::TAB_WIDTH;
+			continue;
+		}
+
+		u32 glyph = TextFont::FindGlyph(fontID, codepoint);
+		if (glyph == TextFont::NONE)
+		{
+			advance += fallbackAdvance;
+			continue;
+		}
+
+		//outlines already include the left side bearing, so the pen only moves by advance
+		const FlatGlyph& flat = data.glyphs[glyph];
+		if (flat.indexCount > 0) glyphs.push_back({ glyph, advance });
+
+		advance += flat.advanceWidth;
+	}
+}
+
+u64 HashText(string_view text)
+{
+	//FNV-1a
+	u64 hash = 14695981039346656037ULL;
+	for (char c : text)
+	{
+		hash ^= static_cast<u8>(c);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+shared_ptr<const LineLayout> FindCachedLayout(
+	const LayoutKey& key,
+	string_view text)
+{
+	auto it = cachedLineLookup.find(key);
+	if (it == cachedLineLookup.end()
+		|| it->second->text != text)
+	{
+		++layoutStats.misses;
+		return nullptr;
+	}
+
+	cachedLines.splice(cachedLines.begin(), cachedLines, it->second);
+	++layoutStats.hits;
+
+	return it->second->layout;
+}
+
+void CacheLayout(
+	const LayoutKey& key,
+	string_view text,
+	const shared_ptr<const LineLayout>& layout)
+{
+	//a colliding line is replaced, both texts can not be cached under one key
+	auto existing = cachedLineLookup.find(key);
+	if (existing != cachedLineLookup.end()) EvictCachedLine(existing->second);
+
+	//roughly what the line keeps alive, including the list and map nodes
+	size_t bytes =
+		sizeof(CachedLine)
+		+ sizeof(LineLayout)
+		+ text.size()
+		+ layout->glyphs.capacity() * sizeof(RunGlyph)
+		+ 64;
+
+	if (bytes > layoutBudget) return;
+
+	cachedLines.push_front(
+	{
+		.key = key,
+		.text = string(text),
+		.layout = layout,
+		.bytes = bytes
+	});
+	cachedLineLookup[key] = cachedLines.begin();
+
+	++layoutStats.entryCount;
+	layoutStats.usedBytes += bytes;
+
+	//runs still showing an evicted line keep its layout alive
+	while (layoutStats.usedBytes > layoutBudget)
+	{
+		EvictCachedLine(prev(cachedLines.end()));
+		++layoutStats.evictions;
+	}
+}
+
+void EvictCachedLine(CachedLineList::iterator it)
+{
+	layoutStats.usedBytes -= it->bytes;
+	--layoutStats.entryCount;
+
+	cachedLineLookup.erase(it->key);
+	cachedLines.erase(it);
+}
+
+void MarkWindowDirty(u32 windowID)
+{
+	auto it = windowRuns.find(windowID);
+	if (it == windowRuns.end()) return;
+
+	it->second.isDirty = true;
+
+	//runs are not widgets, so the scene can not see their changes by itself
+	RetainedScene::InvalidateWindow(windowID);
+	FrameScheduler::RequestRedraw();
+}
+
+void BuildDraws(
+	WindowRuns& window,
+	RunTarget& target)
+{
+	PROFILE_ZONE("TextRunRenderer::BuildDraws");
+
+	target.instances.clear();
+	target.draws.clear();
+	target.sdfInstances.clear();
+	target.sdfDraws.clear();
+
+	//runs of SDF fonts become quads grouped by font, one draw per font
+	unordered_map<u32, vector<const TextRun*>> sdfRuns{};
+
+	//glyph occurrences are counted per font first so every glyph gets
+	//one contiguous instance range without sorting the instances
+	unordered_map<u32, vector<u32>> firstInstances{};
+
+	for (const TextRun* run : window.runs)
+	{
+		if (!run->IsVisible()) continue;
+
+		if (TextFont::GetSdfAtlas(run->GetFontID()))
+		{
+			sdfRuns[run->GetFontID()].push_back(run);
+			continue;
+		}
+
+		const FlatFontData* data = TextFont::GetFontData(run->GetFontID());
+		if (!data) continue;
+
+		vector<u32>& counts = firstInstances[run->GetFontID()];
+		if (counts.empty()) counts.assign(data->glyphs.size(), 0);
+
+		for (const RunGlyph& glyph : run->GetGlyphs()) ++counts[glyph.glyph];
+	}
+
+	u32 instanceCount{};
+	for (auto& [fontID, counts] : firstInstances)
+	{
+		for (u32 g = 0; g < counts.size(); ++g)
+		{
+			u32 count = counts[g];
+			if (count == 0) continue;
+
+			target.draws.push_back(
+			{
+				.fontID = fontID,
+				.glyph = g,
+				.firstInstance = instanceCount,
+				.instanceCount = count
+			});
+
+			//the count becomes the write position of the glyph
+			counts[g] = instanceCount;
+			instanceCount += count;
+		}
+	}
+
+	target.instances.resize(instanceCount);
+
+	for (auto& [fontID, runs] : sdfRuns)
+	{
+		const SdfAtlasData* atlas = TextFont::GetSdfAtlas(fontID);
+
+		SdfDraw draw
+		{
+			.fontID = fontID,
+			.firstInstance = static_cast<u32>(target.sdfInstances.size())
+		};
+
+		for (const TextRun* run : runs)
+		{
+			vec2 origin = run->GetOrigin();
+			f32 scale = run->GetFontSize();
+			f32 style = static_cast<f32>(run->GetStyleIndex());
+
+			for (const RunGlyph& glyph : run->GetGlyphs())
+			{
+				const SdfGlyph& sdf = atlas->glyphs[glyph.glyph];
+				if (sdf.rect.width == 0) continue;
+
+				target.sdfInstances.push_back(
+				{
+					.origin = vec2(origin.x + glyph.penX * scale, origin.y),
+					.scale = scale,
+					.style = style,
+					.planeMin = sdf.planeMin,
+					.planeMax = sdf.planeMax,
+					.uvMin = sdf.uvMin,
+					.uvMax = sdf.uvMax
+				});
+			}
+		}
+
+		draw.instanceCount = static_cast<u32>(target.sdfInstances.size()) - draw.firstInstance;
+		if (draw.instanceCount > 0) target.sdfDraws.push_back(draw);
+	}
+
+	for (const TextRun* run : window.runs)
+	{
+		if (!run->IsVisible()) continue;
+
+		auto it = firstInstances.find(run->GetFontID());
+		if (it == firstInstances.end()) continue;
+
+		vec2 origin = run->GetOrigin();
+		f32 scale = run->GetFontSize();
+		f32 style = static_cast<f32>(run->GetStyleIndex());
+
+		for (const RunGlyph& glyph : run->GetGlyphs())
+		{
+			target.instances[it->second[glyph.glyph]++] =
+			{
+				.origin = vec2(origin.x + glyph.penX * scale, origin.y),
+				.scale = scale,
+				.style = style
+			};
+		}
+	}
+}
+
+bool UploadFont(
+	u32 fontID,
+	const LoadedFont& font,
+	RunTarget& target,
+	FontBuffers& outBuffers)
+{
+	PROFILE_ZONE("TextRunRenderer::UploadFont");
+
+	if (font.vertexFloats == 0
+		|| font.indexCount == 0)
+	{
+		return false;
+	}
+
+	glGenVertexArrays(1, &outBuffers.VAO);
+	glGenBuffers(1, &outBuffers.VBO);
+	glGenBuffers(1, &outBuffers.EBO);
+
+	glBindVertexArray(outBuffers.VAO);
+
+	//every glyph of the font lives in these two buffers,
+	//glyph indices stay local and are offset by the base vertex of the draw
+	glBindBuffer(GL_ARRAY_BUFFER, outBuffers.VBO);
+	glBufferData(
+		GL_ARRAY_BUFFER,
+		static_cast<GLsizeiptr>(font.vertexFloats * sizeof(f32)),
+		nullptr,
+		GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), nullptr);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outBuffers.EBO);
+	glBufferData(
+		GL_ELEMENT_ARRAY_BUFFER,
+		static_cast<GLsizeiptr>(font.indexCount * sizeof(u32)),
+		nullptr,
+		GL_STATIC_DRAW);
+
+	outBuffers.glyphs.assign(font.data.glyphs.size(), GlyphUpload::GLYPH_PENDING);
+
+	glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+	for (u32 location = 1; location <= 3; ++location)
+	{
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisorProc(location, 1);
+	}
+	SetInstanceAttributes(0);
+
+	glBindVertexArray(0);
+
+	return true;
+}
+
+size_t UploadGlyph(
+	LoadedFont& font,
+	u32 glyph,
+	RunTarget& target,
+	FontBuffers& buffers)
+{
+	PROFILE_ZONE("TextRunRenderer::UploadGlyph");
+
+	const FlatGlyph& flat = font.data.glyphs[glyph];
+
+	//reused for every glyph of every window
+	static vector<f32> vertices{};
+	static vector<u32> indices{};
+
+	vertices.resize(flat.vertexFloats);
+	indices.resize(flat.indexCount);
+
+	if (!ReadGlyphMesh(font, glyph, vertices, indices))
+	{
+		buffers.glyphs[glyph] = GlyphUpload::GLYPH_FAILED;
+		return 0;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+	glBufferSubData(
+		GL_ARRAY_BUFFER,
+		static_cast<GLintptr>(static_cast<size_t>(flat.vertexOffset) * sizeof(f32)),
+		static_cast<GLsizeiptr>(vertices.size() * sizeof(f32)),
+		vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, target.instanceVBO);
+
+	//the element buffer is part of the bound vertex array
+	glBufferSubData(
+		GL_ELEMENT_ARRAY_BUFFER,
+		static_cast<GLintptr>(static_cast<size_t>(flat.indexOffset) * sizeof(u32)),
+		static_cast<GLsizeiptr>(indices.size() * sizeof(u32)),
+		indices.data());
+
+	buffers.glyphs[glyph] = GlyphUpload::GLYPH_UPLOADED;
+
+	return (vertices.size() + indices.size()) * sizeof(u32);
+}
+
+bool ReadGlyphMesh(
+	LoadedFont& font,
+	u32 glyph,
+	span<f32> outVertices,
+	span<u32> outIndices)
+{
+	if (!font.file.CopyGlyph(glyph, outVertices, outIndices)) return false;
+
+	const auto& m = font.data.glyphs[glyph].transform;
+	if (m.m00 == 1.0f
+		&& m.m01 == 0.0f
+		&& m.m10 == 0.0f
+		&& m.m11 == 1.0f)
+	{
+		return true;
+	}
+
+	for (size_t v = 0; v + 1 < outVertices.size(); v += 2)
+	{
+		f32 x = outVertices[v];
+		f32 y = outVertices[v + 1];
+
+		outVertices[v] = m.m00 * x + m.m01 * y;
+		outVertices[v + 1] = m.m10 * x + m.m11 * y;
+	}
+
+	return true;
+}
+
+u32 DecodeUTF8(
+	string_view text,
+	size_t& index)
+{
+	constexpr u32 REPLACEMENT = 0xFFFD;
+
+	u8 lead = static_cast<u8>(text[index++]);
+	if (lead < 0x80) return lead;
+
+	u32 length{};
+	u32 codepoint{};
+
+	if ((lead & 0xE0) == 0xC0)      { length = 1; codepoint = lead & 0x1F; }
+	else if ((lead & 0xF0) == 0xE0) { length = 2; codepoint = lead & 0x0F; }
+	else if ((lead & 0xF8) == 0xF0) { length = 3; codepoint = lead & 0x07; }
+	else return REPLACEMENT;
+
+	//malformed sequences become one replacement character and resume at the bad byte
+	for (u32 i = 0; i < length; ++i)
+	{
+		if (index >= text.size()) return REPLACEMENT;
+
+		u8 next = static_cast<u8>(text[index]);
+		if ((next & 0xC0) != 0x80) return REPLACEMENT;
+
+		codepoint = (codepoint << 6) | (next & 0x3F);
+		++index;
+	}
+
+	return codepoint;
+}
\ No newline at end of file
@@ -0,0 +1,209 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <map>
+#include <array>
+#include <algorithm>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "graphics/text_style.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::vec2;
+using KalaHeaders::vec3;
+
+using Solin::Graphics::TextStyle;
+using Solin::Graphics::TextStyleTable;
+
+using std::map;
+using std::array;
+using std::vector;
+using std::span;
+using std::copy;
+
+constexpr size_t STYLE_FLOATS = TextStyleTable::VEC4_PER_STYLE * 4;
+
+using PackedStyle = array<f32, STYLE_FLOATS>;
+
+enum StyleFlags : u32
+{
+	STYLE_UNDERLINE = 1,
+	STYLE_STRIPED = 2,
+	STYLE_SHADOW = 4,
+	STYLE_GLOW = 8
+};
+
+static vector<TextStyle> styles{ TextStyle{} };
+static vector<f32> packed{};
+static map<PackedStyle, u16> lookup{};
+
+//runs holding each style, the default style is never counted or freed
+static vector<u32> refCounts{ 0 };
+
+//released indices that new styles take before the table grows
+static vector<u16> freeSlots{};
+
+static u32 version = 1;
+static bool hasWarnedFull{};
+
+static PackedStyle PackStyle(const TextStyle& style);
+
+namespace Solin::Graphics
+{
+	u16 TextStyleTable::Intern(const TextStyle& style)
+	{
+		//the default style is registered on first use so the table never starts empty
+		if (lookup.empty())
+		{
+			PackedStyle defaultStyle = PackStyle(styles[DEFAULT_STYLE]);
+
+			lookup[defaultStyle] = DEFAULT_STYLE;
+			packed.assign(defaultStyle.begin(), defaultStyle.end());
+		}
+
+		PackedStyle key = PackStyle(style);
+
+		auto it = lookup.find(key);
+		if (it != lookup.end())
+		{
+			if (it->second != DEFAULT_STYLE) ++refCounts[it->second];
+			return it->second;
+		}
+
+		if (!freeSlots.empty())
+		{
+			u16 index = freeSlots.back();
+			freeSlots.pop_back();
+
+			styles[index] = style;
+			copy(key.begin(), key.end(), packed.begin() + static_cast<size_t>(index) * STYLE_FLOATS);
+			lookup[key] = index;
+			refCounts[index] = 1;
+
+			++version;
+
+			return index;
+		}
+
+		if (styles.size() >= MAX_STYLES)
+		{
+			if (!hasWarnedFull)
+			{
+				Log::Print(
+					"Text style table is full, new styles fall back to the default style.",
+					"TEXT_STYLE",
+					LogType::LOG_WARNING);
+
+				hasWarnedFull = true;
+			}
+
+			return DEFAULT_STYLE;
+		}
+
+		u16 index = static_cast<u16>(styles.size());
+
+		styles.push_back(style);
+		packed.insert(packed.end(), key.begin(), key.end());
+		lookup[key] = index;
+		refCounts.push_back(1);
+
+		++version;
+
+		return index;
+	}
+
+	void TextStyleTable::Release(u16 index)
+	{
+		if (index == DEFAULT_STYLE
+			|| index >= refCounts.size()
+			|| refCounts[index] == 0)
+		{
+			return;
+		}
+
+		if (--refCounts[index] != 0) return;
+
+		//the packed data stays until the slot is reused, no run points at it anymore
+		lookup.erase(PackStyle(styles[index]));
+		freeSlots.push_back(index);
+	}
+
+	const TextStyle& TextStyleTable::GetStyle(u16 index)
+	{
+		return index < styles.size()
+			? styles[index]
+			: styles[DEFAULT_STYLE];
+	}
+
+	u32 TextStyleTable::GetStyleCount()
+	{
+		return static_cast<u32>(styles.size());
+	}
+
+	span<const f32> TextStyleTable::GetPackedData()
+	{
+		if (packed.empty()) Intern(styles[DEFAULT_STYLE]);
+
+		return packed;
+	}
+
+	u32 TextStyleTable::GetVersion()
+	{
+		return version;
+	}
+}
+
+PackedStyle PackStyle(const TextStyle& style)
+{
+	u32 flags =
+		(style.underline ? static_cast<u32>(STYLE_UNDERLINE) : 0u)
+		| (style.striped ? static_cast<u32>(STYLE_STRIPED) : 0u)
+		| (style.shadow ? static_cast<u32>(STYLE_SHADOW) : 0u)
+		| (style.glow ? static_cast<u32>(STYLE_GLOW) : 0u);
+
+	//disabled effects are zeroed so styles that only differ in unused values intern as one
+	TextStyle s = style;
+	if (!s.underline)
+	{
+		s.underlineStrength = 0.0f;
+		s.underlineThickness = 0.0f;
+		s.underlineOffset = 0.0f;
+		s.underlineColor = vec3(0.0f);
+	}
+	if (!s.striped)
+	{
+		s.stripeDarkness = 0.0f;
+		s.stripeRepeat = 0.0f;
+		s.stripeSize = vec2(0.0f);
+	}
+	if (!s.shadow)
+	{
+		s.shadowOffset = vec2(0.0f);
+		s.shadowColor = vec3(0.0f);
+		s.shadowOpacity = 0.0f;
+	}
+	if (!s.glow)
+	{
+		s.glowColor = vec3(0.0f);
+		s.glowStrength = 0.0f;
+		s.glowRadius = 0.0f;
+	}
+
+	//must match the TextStyles block of the run shaders
+	return
+	{
+		s.color.x, s.color.y, s.color.z, s.opacity,
+		s.italicSkew, s.kerningOffset, static_cast<f32>(flags), s.underlineStrength,
+		s.underlineColor.x, s.underlineColor.y, s.underlineColor.z, s.underlineThickness,
+		s.underlineOffset, s.stripeDarkness, s.stripeRepeat, s.shadowOpacity,
+		s.stripeSize.x, s.stripeSize.y, s.shadowOffset.x, s.shadowOffset.y,
+		s.shadowColor.x, s.shadowColor.y, s.shadowColor.z, s.glowStrength,
+		s.glowColor.x, s.glowColor.y, s.glowColor.z, s.glowRadius
+	};
+}
\ No newline at end of file
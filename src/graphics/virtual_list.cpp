@@ -0,0 +1,688 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core/profiler.hpp"
+
+#include <unordered_set>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "KalaWindow/include/utils/transform2d.hpp"
+
+#include "core/scheduler.hpp"
+#include "graphics/virtual_list.hpp"
+#include "graphics/content_slots.hpp"
+#include "graphics/scene.hpp"
+
+using KalaHeaders::Log;
+using KalaHeaders::LogType;
+using KalaHeaders::vec2;
+
+using KalaWindow::Utils::Transform2D;
+using KalaWindow::Utils::PosTarget;
+using KalaWindow::Utils::SizeTarget;
+using KalaWindow::UI::Widget;
+using KalaWindow::UI::Image;
+
+using Solin::Core::FrameScheduler;
+using Solin::Graphics::HeightIndex;
+using Solin::Graphics::VirtualList;
+using Solin::Graphics::VirtualTree;
+using Solin::Graphics::ContentSlots;
+using Solin::Graphics::ContentHandle;
+using Solin::Graphics::RetainedScene;
+
+using std::unordered_set;
+using std::vector;
+using std::span;
+using std::string;
+using std::to_string;
+using std::max;
+using std::min;
+using std::clamp;
+using std::ceil;
+
+//widgets owned by the pool of any list
+static unordered_set<const Widget*> pooledWidgets{};
+
+namespace Solin::Graphics
+{
+	//
+	// HEIGHT INDEX
+	//
+
+	void HeightIndex::Assign(
+		u32 count,
+		f32 height)
+	{
+		heights.assign(count, height);
+		Rebuild();
+	}
+
+	void HeightIndex::Assign(span<const f32> newHeights)
+	{
+		heights.assign(newHeights.begin(), newHeights.end());
+		Rebuild();
+	}
+
+	void HeightIndex::Insert(
+		u32 row,
+		u32 count,
+		f32 height)
+	{
+		row = min(row, GetCount());
+
+		heights.insert(heights.begin() + row, count, height);
+		Rebuild();
+	}
+
+	void HeightIndex::Erase(
+		u32 row,
+		u32 count)
+	{
+		if (row >= GetCount()) return;
+		count = min(count, GetCount() - row);
+
+		heights.erase(heights.begin() + row, heights.begin() + row + count);
+		Rebuild();
+	}
+
+	void HeightIndex::SetHeight(
+		u32 row,
+		f32 height)
+	{
+		if (row >= heights.size()) return;
+
+		f64 delta = static_cast<f64>(height) - heights[row];
+		if (delta == 0.0) return;
+
+		heights[row] = height;
+		totalHeight += delta;
+
+		for (size_t i = row + 1; i < tree.size(); i += i & (~i + 1)) tree[i] += delta;
+	}
+
+	f64 HeightIndex::GetOffset(u32 row) const
+	{
+		if (row >= heights.size()) return totalHeight;
+
+		f64 sum{};
+		for (size_t i = row; i > 0; i -= i & (~i + 1)) sum += tree[i];
+
+		return sum;
+	}
+
+	u32 HeightIndex::FindRow(f64 offset) const
+	{
+		if (heights.empty()
+			|| offset <= 0.0)
+		{
+			return 0;
+		}
+
+		size_t count = heights.size();
+
+		size_t step = 1;
+		while (step * 2 <= count) step *= 2;
+
+		//descend the tree, skipping every block that ends at or above the offset
+		size_t pos{};
+		f64 remaining = offset;
+		for (; step > 0; step /= 2)
+		{
+			size_t next = pos + step;
+			if (next <= count
+				&& tree[next] <= remaining)
+			{
+				pos = next;
+				remaining -= tree[next];
+			}
+		}
+
+		return static_cast<u32>(min(pos, count - 1));
+	}
+
+	void HeightIndex::Rebuild()
+	{
+		PROFILE_ZONE("HeightIndex::Rebuild");
+
+		size_t count = heights.size();
+
+		tree.assign(count + 1, 0.0);
+		totalHeight = 0.0;
+
+		//each node pushes its finished sum to the parent that covers it
+		for (size_t i = 1; i <= count; ++i)
+		{
+			tree[i] += heights[i - 1];
+			totalHeight += heights[i - 1];
+
+			size_t parent = i + (i & (~i + 1));
+			if (parent <= count) tree[parent] += tree[i];
+		}
+	}
+
+	//
+	// VIRTUAL LIST
+	//
+
+	bool VirtualList::Initialize(
+		u32 newWindowID,
+		vec2 pos,
+		vec2 size,
+		f32 newMinRowHeight,
+		OpenGL_Shader* newShader)
+	{
+		if (!pool.empty())
+		{
+			Log::Print(
+				"Cannot initialize virtual list because it is already initialized!",
+				"VIRTUAL_LIST",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		windowID = newWindowID;
+		shader = newShader;
+		viewportPos = pos;
+		viewportSize = size;
+		minRowHeight = max(newMinRowHeight, 1.0f);
+
+		GrowPool();
+
+		return !pool.empty();
+	}
+
+	void VirtualList::Shutdown()
+	{
+		vector<ContentHandle> handles{};
+		handles.reserve(pool.size());
+
+		for (const PooledRow& slot : pool)
+		{
+			pooledWidgets.erase(slot.widget);
+			handles.push_back(slot.handle);
+		}
+
+		//one pass over the image registry instead of one search per row
+		ContentSlots<Image>::Remove(handles);
+
+		pool.clear();
+		firstVisible = 0;
+		visibleCount = 0;
+		stats = {};
+	}
+
+	void VirtualList::SetViewport(
+		vec2 pos,
+		vec2 size)
+	{
+		if (pos == viewportPos
+			&& size == viewportSize)
+		{
+			return;
+		}
+
+		viewportPos = pos;
+		viewportSize = size;
+
+		GrowPool();
+		ClampScroll();
+
+		MarkLayoutDirty();
+	}
+
+	void VirtualList::SetRowCount(
+		u32 count,
+		f32 height)
+	{
+		heightIndex.Assign(count, max(height, minRowHeight));
+		indents.clear();
+
+		ClampScroll();
+		InvalidateAll();
+	}
+
+	void VirtualList::SetRows(
+		span<const f32> heights,
+		span<const f32> newIndents)
+	{
+		vector<f32> clamped(heights.begin(), heights.end());
+		for (f32& h : clamped) h = max(h, minRowHeight);
+
+		heightIndex.Assign(clamped);
+
+		if (newIndents.size() == heights.size()) indents.assign(newIndents.begin(), newIndents.end());
+		else indents.clear();
+
+		ClampScroll();
+		InvalidateAll();
+	}
+
+	void VirtualList::InsertRows(
+		u32 row,
+		u32 count,
+		f32 height)
+	{
+		if (count == 0) return;
+
+		row = min(row, GetRowCount());
+
+		heightIndex.Insert(row, count, max(height, minRowHeight));
+		if (!indents.empty()) indents.insert(indents.begin() + row, count, 0.0f);
+
+		//every row below the insert now shows other content
+		InvalidateAll();
+	}
+
+	void VirtualList::EraseRows(
+		u32 row,
+		u32 count)
+	{
+		if (row >= GetRowCount()
+			|| count == 0)
+		{
+			return;
+		}
+
+		count = min(count, GetRowCount() - row);
+
+		heightIndex.Erase(row, count);
+		if (!indents.empty()) indents.erase(indents.begin() + row, indents.begin() + row + count);
+
+		ClampScroll();
+		InvalidateAll();
+	}
+
+	void VirtualList::SetRowHeight(
+		u32 row,
+		f32 height)
+	{
+		if (row >= GetRowCount()) return;
+
+		heightIndex.SetHeight(row, max(height, minRowHeight));
+
+		ClampScroll();
+		MarkLayoutDirty();
+	}
+
+	void VirtualList::Invalidate(u32 row)
+	{
+		if (pool.empty()
+			|| row < firstVisible
+			|| row >= firstVisible + visibleCount)
+		{
+			return;
+		}
+
+		pool[row % pool.size()].row = NONE;
+		MarkLayoutDirty();
+	}
+
+	void VirtualList::InvalidateAll()
+	{
+		for (PooledRow& slot : pool) slot.row = NONE;
+		MarkLayoutDirty();
+	}
+
+	void VirtualList::SetScroll(f64 offset)
+	{
+		f64 oldScroll = scroll;
+
+		scroll = offset;
+		ClampScroll();
+
+		if (scroll != oldScroll) MarkLayoutDirty();
+	}
+
+	void VirtualList::ScrollToRow(u32 row)
+	{
+		if (row >= GetRowCount()) return;
+
+		f64 top = heightIndex.GetOffset(row);
+		f64 bottom = top + heightIndex.GetHeight(row);
+
+		if (top < scroll) SetScroll(top);
+		else if (bottom > scroll + viewportSize.y) SetScroll(bottom - viewportSize.y);
+	}
+
+	u32 VirtualList::GetRowAt(vec2 point) const
+	{
+		if (point.x < viewportPos.x
+			|| point.x > viewportPos.x + viewportSize.x
+			|| point.y > viewportPos.y
+			|| point.y < viewportPos.y - viewportSize.y)
+		{
+			return NONE;
+		}
+
+		f64 offset = scroll + (viewportPos.y - point.y);
+		if (offset >= heightIndex.GetTotalHeight()) return NONE;
+
+		return heightIndex.FindRow(offset);
+	}
+
+	void VirtualList::Update()
+	{
+		PROFILE_ZONE("VirtualList::Update");
+
+		stats.boundRows = 0;
+		stats.recycledRows = 0;
+
+		if (!isLayoutDirty
+			|| pool.empty())
+		{
+			return;
+		}
+
+		isLayoutDirty = false;
+
+		u32 poolSize = static_cast<u32>(pool.size());
+		u32 rowCount = GetRowCount();
+
+		firstVisible = heightIndex.FindRow(scroll);
+		visibleCount = 0;
+
+		f64 viewportEnd = scroll + viewportSize.y;
+		f64 offset = heightIndex.GetOffset(firstVisible);
+
+		for (u32 row = firstVisible;
+			row < rowCount
+			&& offset < viewportEnd
+			&& visibleCount < poolSize;
+			++row)
+		{
+			f32 height = heightIndex.GetHeight(row);
+			f32 indent = indents.empty() ? 0.0f : indents[row];
+
+			PooledRow& slot = pool[row % poolSize];
+			Image* widget = slot.widget;
+
+			if (slot.row != row)
+			{
+				if (slot.row != NONE) ++stats.recycledRows;
+				slot.row = row;
+
+				widget->SetUpdateState(true);
+				widget->SetInteractableState(true);
+
+				if (binder) binder(row, widget);
+				++stats.boundRows;
+
+				//the binder can change texture contents the scene can not see
+				RetainedScene::MarkDirty(widget);
+			}
+
+			Transform2D* transform = widget->GetTransform();
+			if (transform)
+			{
+				f32 width = max(viewportSize.x - indent, 1.0f);
+				f32 top = viewportPos.y - static_cast<f32>(offset - scroll);
+
+				transform->SetPos(
+					vec2(viewportPos.x + indent + width * 0.5f, top - height * 0.5f),
+					PosTarget::POS_WORLD);
+				transform->SetSize(
+					vec2(width, height),
+					SizeTarget::SIZE_WORLD);
+			}
+
+			offset += height;
+			++visibleCount;
+		}
+
+		stats.visibleRows = visibleCount;
+
+		//slots outside of the visible range are hidden until a row scrolls into them
+		u32 firstSlot = firstVisible % poolSize;
+		for (u32 i = 0; i < poolSize; ++i)
+		{
+			if ((i + poolSize - firstSlot) % poolSize < visibleCount) continue;
+
+			PooledRow& slot = pool[i];
+			if (slot.row == NONE
+				&& !slot.widget->CanUpdate())
+			{
+				continue;
+			}
+
+			slot.row = NONE;
+			slot.widget->SetUpdateState(false);
+			slot.widget->SetInteractableState(false);
+		}
+	}
+
+	bool VirtualList::IsPooledWidget(const Widget* widget)
+	{
+		return pooledWidgets.contains(widget);
+	}
+
+	void VirtualList::GrowPool()
+	{
+		//a partially scrolled row can show at both edges of the viewport
+		u32 needed = static_cast<u32>(ceil(max(viewportSize.y, 0.0f) / minRowHeight)) + 1;
+		if (needed <= pool.size()) return;
+
+		//grown once instead of once per new row
+		Image::registry.runtimeContent.reserve(Image::registry.runtimeContent.size() + (needed - pool.size()));
+
+		while (pool.size() < needed)
+		{
+			Image* widget = Image::Initialize(
+				"virtual_row_" + to_string(pool.size()),
+				windowID,
+				viewportPos,
+				0.0f,
+				vec2(1.0f),
+				nullptr,
+				nullptr,
+				shader);
+
+			if (!widget)
+			{
+				Log::Print(
+					"Failed to create virtual list row widget, the list will show fewer rows!",
+					"VIRTUAL_LIST",
+					LogType::LOG_ERROR,
+					2);
+
+				break;
+			}
+
+			widget->SetUpdateState(false);
+			widget->SetInteractableState(false);
+
+			pooledWidgets.insert(widget);
+			pool.push_back({ .widget = widget, .handle = ContentSlots<Image>::Track(widget) });
+		}
+
+		//the slot of every row depends on the pool size
+		InvalidateAll();
+	}
+
+	void VirtualList::MarkLayoutDirty()
+	{
+		isLayoutDirty = true;
+
+		//an idle event driven loop would otherwise never get to Update
+		FrameScheduler::RequestRedraw();
+	}
+
+	void VirtualList::ClampScroll()
+	{
+		f64 maxScroll = max(heightIndex.GetTotalHeight() - static_cast<f64>(viewportSize.y), 0.0);
+		scroll = clamp(scroll, 0.0, maxScroll);
+	}
+
+	//
+	// VIRTUAL TREE
+	//
+
+	bool VirtualTree::Initialize(
+		u32 windowID,
+		vec2 pos,
+		vec2 size,
+		f32 minRowHeight,
+		f32 newIndentWidth,
+		OpenGL_Shader* shader)
+	{
+		if (!list.Initialize(
+			windowID,
+			pos,
+			size,
+			minRowHeight,
+			shader))
+		{
+			return false;
+		}
+
+		defaultHeight = max(minRowHeight, 1.0f);
+		indentWidth = max(newIndentWidth, 0.0f);
+
+		//the tree must stay at this address while the list holds the binder
+		list.SetRowBinder([this](u32 row, Image* widget)
+			{
+				u32 node = GetNodeAtRow(row);
+				if (binder
+					&& node != NONE)
+				{
+					binder(node, nodes.GetDepth(node), IsExpanded(node), widget);
+				}
+			});
+
+		return true;
+	}
+
+	void VirtualTree::Shutdown()
+	{
+		list.Shutdown();
+		Clear();
+	}
+
+	u32 VirtualTree::AddNode(
+		u32 parent,
+		f32 height)
+	{
+		u32 node = nodes.Add(nullptr, parent);
+		if (node == NONE) return NONE;
+
+		if (node >= heights.size())
+		{
+			heights.resize(node + 1);
+			expanded.resize(node + 1);
+		}
+
+		heights[node] = height > 0.0f ? height : defaultHeight;
+		expanded[node] = 0;
+
+		MarkRowsDirty();
+
+		return node;
+	}
+
+	bool VirtualTree::RemoveNode(u32 node)
+	{
+		if (!nodes.Remove(node)) return false;
+
+		MarkRowsDirty();
+		return true;
+	}
+
+	void VirtualTree::Clear()
+	{
+		nodes.Clear();
+		heights.clear();
+		expanded.clear();
+		rowNodes.clear();
+		nodeRows.clear();
+
+		MarkRowsDirty();
+	}
+
+	void VirtualTree::SetExpanded(
+		u32 node,
+		bool newValue)
+	{
+		if (!nodes.IsValid(node)
+			|| IsExpanded(node) == newValue)
+		{
+			return;
+		}
+
+		expanded[node] = newValue ? 1 : 0;
+		MarkRowsDirty();
+	}
+
+	void VirtualTree::Invalidate(u32 node)
+	{
+		if (node < nodeRows.size()
+			&& nodeRows[node] != NONE)
+		{
+			list.Invalidate(nodeRows[node]);
+		}
+	}
+
+	void VirtualTree::ScrollToNode(u32 node)
+	{
+		if (!nodes.IsValid(node)) return;
+
+		for (u32 p = nodes.GetParent(node); p != NONE; p = nodes.GetParent(p))
+		{
+			SetExpanded(p, true);
+		}
+
+		if (areRowsDirty) RebuildRows();
+
+		list.ScrollToRow(nodeRows[node]);
+	}
+
+	void VirtualTree::Update()
+	{
+		if (areRowsDirty) RebuildRows();
+
+		list.Update();
+	}
+
+	void VirtualTree::MarkRowsDirty()
+	{
+		areRowsDirty = true;
+		FrameScheduler::RequestRedraw();
+	}
+
+	void VirtualTree::RebuildRows()
+	{
+		PROFILE_ZONE("VirtualTree::RebuildRows");
+
+		areRowsDirty = false;
+
+		vector<f32> rowHeights{};
+		vector<f32> rowIndents{};
+
+		rowNodes.clear();
+		nodeRows.assign(heights.size(), NONE);
+
+		span<const u32> order = nodes.GetDepthFirstOrder();
+
+		//subtrees are contiguous in depth-first order, so a collapsed node skips its whole range
+		for (size_t i = 0; i < order.size();)
+		{
+			u32 node = order[i];
+
+			nodeRows[node] = static_cast<u32>(rowNodes.size());
+			rowNodes.push_back(node);
+			rowHeights.push_back(heights[node]);
+			rowIndents.push_back(static_cast<f32>(nodes.GetDepth(node)) * indentWidth);
+
+			i += expanded[node] ? 1 : nodes.GetSubtree(node).size();
+		}
+
+		list.SetRows(rowHeights, rowIndents);
+	}
+}
\ No newline at end of file
@@ -4,11 +4,16 @@
 //Read LICENSE.md for more information.
 
 #include "core/core_program.hpp"
+#include "core/font_converter.hpp"
 
 using Solin::Core::SolinCore;
+using Solin::Core::FontConverter;
 
-int main()
+int main(int argc, char* argv[])
 {
+	int exitCode{};
+	if (FontConverter::RunFromArguments(argc, argv, exitCode)) return exitCode;
+
 	SolinCore::Initialize();
 	SolinCore::Update();
 	
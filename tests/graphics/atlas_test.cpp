@@ -0,0 +1,199 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Headless test of SkylinePacker, needs no window or OpenGL context.
+// Build together with src/graphics/skyline_packer.cpp, which holds the packer apart
+// from the OpenGL side of the atlas. Exits with 0 if every check passed.
+// ===================================================================================
+
+#include "core/profiler.hpp"
+
+#include <cstdio>
+#include <vector>
+
+#include "graphics/atlas.hpp"
+
+using Solin::Graphics::SkylinePacker;
+using Solin::Graphics::AtlasRect;
+
+using std::vector;
+
+static int failedChecks{};
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		++failedChecks; \
+	}
+
+static bool Overlaps(const AtlasRect& a, const AtlasRect& b)
+{
+	return a.x < b.x + b.width
+		&& b.x < a.x + a.width
+		&& a.y < b.y + b.height
+		&& b.y < a.y + a.height;
+}
+
+//every rect lies inside the page and no two live rects overlap
+static bool IsValidPacking(
+	const SkylinePacker& packer,
+	const vector<AtlasRect>& rects)
+{
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		const AtlasRect& r = rects[i];
+		if (r.x + r.width > packer.GetWidth()
+			|| r.y + r.height > packer.GetHeight())
+		{
+			return false;
+		}
+
+		for (size_t j = i + 1; j < rects.size(); ++j)
+		{
+			if (Overlaps(r, rects[j])) return false;
+		}
+	}
+
+	return true;
+}
+
+static void TestRejectsInvalidSizes()
+{
+	SkylinePacker packer{};
+	packer.Initialize(64, 64);
+
+	AtlasRect rect{};
+	CHECK(!packer.Insert(0, 8, rect));
+	CHECK(!packer.Insert(8, 0, rect));
+	CHECK(!packer.Insert(65, 8, rect));
+	CHECK(!packer.Insert(8, 65, rect));
+	CHECK(packer.GetUsedArea() == 0);
+}
+
+static void TestFillsWithoutOverlap()
+{
+	SkylinePacker packer{};
+	packer.Initialize(256, 256);
+
+	//mixed sizes until the page is full
+	vector<AtlasRect> rects{};
+	u32 sizes[] = { 18, 34, 10, 50, 26 };
+	for (u32 i = 0;; ++i)
+	{
+		u32 w = sizes[i % 5];
+		u32 h = sizes[(i + 2) % 5];
+
+		AtlasRect rect{};
+		if (!packer.Insert(w, h, rect)) break;
+
+		CHECK(rect.width == w);
+		CHECK(rect.height == h);
+		rects.push_back(rect);
+	}
+
+	CHECK(!rects.empty());
+	CHECK(IsValidPacking(packer, rects));
+
+	u64 area{};
+	for (const auto& r : rects) area += static_cast<u64>(r.width) * r.height;
+	CHECK(packer.GetUsedArea() == area);
+	CHECK(packer.GetOccupancy() > 0.5f);
+}
+
+static void TestReusesFreedRect()
+{
+	SkylinePacker packer{};
+	packer.Initialize(64, 64);
+
+	AtlasRect a{};
+	AtlasRect b{};
+	CHECK(packer.Insert(32, 32, a));
+	CHECK(packer.Insert(32, 32, b));
+
+	packer.Free(a);
+	CHECK(packer.GetFragmentation() > 0.0f);
+
+	//fits the hole exactly, so it must land where a was
+	AtlasRect c{};
+	CHECK(packer.Insert(32, 32, c));
+	CHECK(c.x == a.x);
+	CHECK(c.y == a.y);
+	CHECK(packer.GetFragmentation() == 0.0f);
+}
+
+static void TestMergesAdjacentHoles()
+{
+	SkylinePacker packer{};
+	packer.Initialize(64, 16);
+
+	//four 16x16 rects side by side fill the page
+	AtlasRect rects[4]{};
+	for (auto& r : rects) CHECK(packer.Insert(16, 16, r));
+
+	AtlasRect full{};
+	CHECK(!packer.Insert(16, 16, full));
+
+	//two neighbours freed in either order form one 32 wide hole
+	packer.Free(rects[2]);
+	packer.Free(rects[1]);
+
+	AtlasRect wide{};
+	CHECK(packer.Insert(32, 16, wide));
+	CHECK(wide.x == 16);
+	CHECK(wide.y == 0);
+	CHECK(IsValidPacking(packer, { rects[0], rects[3], wide }));
+}
+
+static void TestMergesChainOfHoles()
+{
+	SkylinePacker packer{};
+	packer.Initialize(16, 64);
+
+	AtlasRect rects[4]{};
+	for (auto& r : rects) CHECK(packer.Insert(16, 16, r));
+
+	//the middle one is freed last and joins both of its neighbours
+	packer.Free(rects[0]);
+	packer.Free(rects[2]);
+	packer.Free(rects[1]);
+
+	AtlasRect tall{};
+	CHECK(packer.Insert(16, 48, tall));
+	CHECK(IsValidPacking(packer, { rects[3], tall }));
+}
+
+static void TestResetsWhenEmpty()
+{
+	SkylinePacker packer{};
+	packer.Initialize(64, 64);
+
+	vector<AtlasRect> rects{};
+	AtlasRect rect{};
+	while (packer.Insert(20, 12, rect)) rects.push_back(rect);
+
+	for (const auto& r : rects) packer.Free(r);
+
+	CHECK(packer.GetUsedArea() == 0);
+	CHECK(packer.GetFragmentation() == 0.0f);
+
+	//the whole page is one open skyline again
+	CHECK(packer.Insert(64, 64, rect));
+}
+
+int main()
+{
+	TestRejectsInvalidSizes();
+	TestFillsWithoutOverlap();
+	TestReusesFreedRect();
+	TestMergesAdjacentHoles();
+	TestMergesChainOfHoles();
+	TestResetsWhenEmpty();
+
+	if (failedChecks == 0) std::printf("atlas_test: all checks passed\n");
+
+	return failedChecks == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+// ===================================================================================
+// Headless test of QuadBatchBuilder, needs no window or OpenGL context.
+// Build together with src/graphics/quad_batch.cpp, which holds the builder apart
+// from the OpenGL side of batching, and src/core/profiler.cpp. Exits with 0 if every check passed.
+// ===================================================================================
+
+#include "core/profiler.hpp"
+
+#include <cstdio>
+
+#include "graphics/batch.hpp"
+
+using KalaHeaders::vec2;
+
+using KalaWindow::Graphics::OpenGL::OpenGL_Shader;
+
+using Solin::Graphics::QuadBatchBuilder;
+using Solin::Graphics::QuadInstance;
+using Solin::Graphics::QuadBatch;
+
+using std::span;
+
+static int failedChecks{};
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		++failedChecks; \
+	}
+
+//shaders are only compared by address, they are never dereferenced
+static const OpenGL_Shader* const SHADER_A = reinterpret_cast<const OpenGL_Shader*>(0x10);
+static const OpenGL_Shader* const SHADER_B = reinterpret_cast<const OpenGL_Shader*>(0x20);
+
+static QuadInstance MakeQuad(f32 x)
+{
+	return QuadInstance{ .pos = vec2(x, 0.0f), .size = vec2(1.0f) };
+}
+
+static void TestEmpty()
+{
+	QuadBatchBuilder builder{};
+	builder.Build();
+
+	CHECK(builder.GetInstances().empty());
+	CHECK(builder.GetBatches().empty());
+	CHECK(builder.GetInstanceBytes() == 0);
+}
+
+static void TestMergesSameState()
+{
+	QuadBatchBuilder builder{};
+	for (u32 i = 0; i < 100; ++i) builder.Add(0, SHADER_A, 1, MakeQuad(static_cast<f32>(i)));
+	builder.Build();
+
+	CHECK(builder.GetBatches().size() == 1);
+	CHECK(builder.GetBatches()[0].instanceCount == 100);
+	CHECK(builder.GetInstanceBytes() == 100 * sizeof(QuadInstance));
+
+	//equal keys keep the order they were added in
+	for (u32 i = 0; i < 100; ++i) CHECK(builder.GetInstances()[i].pos.x == static_cast<f32>(i));
+}
+
+static void TestSortsByZOrder()
+{
+	QuadBatchBuilder builder{};
+	builder.Add(2, SHADER_A, 1, MakeQuad(2.0f));
+	builder.Add(0, SHADER_A, 2, MakeQuad(0.0f));
+	builder.Add(1, SHADER_A, 1, MakeQuad(1.0f));
+	builder.Build();
+
+	span<const QuadInstance> instances = builder.GetInstances();
+	CHECK(instances.size() == 3);
+	CHECK(instances[0].pos.x == 0.0f);
+	CHECK(instances[1].pos.x == 1.0f);
+	CHECK(instances[2].pos.x == 2.0f);
+
+	//z 1 and z 2 share shader and texture, so they are drawn together
+	span<const QuadBatch> batches = builder.GetBatches();
+	CHECK(batches.size() == 2);
+	CHECK(batches[0].textureID == 2);
+	CHECK(batches[1].textureID == 1);
+	CHECK(batches[1].firstInstance == 1);
+	CHECK(batches[1].instanceCount == 2);
+}
+
+static void TestSplitsByShaderAndTexture()
+{
+	QuadBatchBuilder builder{};
+	builder.Add(0, SHADER_A, 1, MakeQuad(0.0f));
+	builder.Add(0, SHADER_B, 1, MakeQuad(1.0f));
+	builder.Add(0, SHADER_A, 2, MakeQuad(2.0f));
+	builder.Add(0, SHADER_A, 1, MakeQuad(3.0f));
+	builder.Build();
+
+	//within one z-order the quads are grouped by shader, then texture
+	span<const QuadBatch> batches = builder.GetBatches();
+	CHECK(batches.size() == 3);
+
+	u32 total{};
+	for (size_t i = 0; i < batches.size(); ++i)
+	{
+		CHECK(batches[i].firstInstance == total);
+		total += batches[i].instanceCount;
+
+		if (i > 0)
+		{
+			CHECK(batches[i].shader != batches[i - 1].shader
+				|| batches[i].textureID != batches[i - 1].textureID);
+		}
+	}
+	CHECK(total == 4);
+}
+
+static void TestClear()
+{
+	QuadBatchBuilder builder{};
+	builder.Add(0, SHADER_A, 1, MakeQuad(0.0f));
+	builder.Build();
+	builder.Clear();
+
+	CHECK(builder.GetInstances().empty());
+	CHECK(builder.GetBatches().empty());
+
+	//reused after a clear like it is once per flush in DrawWidgets
+	builder.Add(3, SHADER_B, 4, MakeQuad(5.0f));
+	builder.Build();
+
+	CHECK(builder.GetBatches().size() == 1);
+	CHECK(builder.GetBatches()[0].shader == SHADER_B);
+	CHECK(builder.GetInstances()[0].pos.x == 5.0f);
+}
+
+int main()
+{
+	TestEmpty();
+	TestMergesSameState();
+	TestSortsByZOrder();
+	TestSplitsByShaderAndTexture();
+	TestClear();
+
+	if (failedChecks == 0) std::printf("batch_test: all checks passed\n");
+
+	return failedChecks == 0 ? 0 : 1;
+}
\ No newline at end of file